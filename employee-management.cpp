@@ -16,6 +16,10 @@
  *   - username: testing 
  *   - password: password 
  *
+ *   @devnote Background work runs on std::thread, so build with threads enabled. -O3 lets
+ *   the compiler vectorize the numeric column loops:
+ *   - g++ -std=c++17 -O3 -pthread employee-management.cpp
+ *
  *   @author Titus Moore <titusmoore.dev>
  *   @contact <titusdmoore@gmail.com>
  *   @repo https://github.com/titusdmoore/cs112-final
@@ -23,23 +27,208 @@
  */
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <condition_variable>
 #include <cstdlib>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <exception>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <list>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <random>
 #include <sstream>
 #include <stdlib.h>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#if defined _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SHARED_STORE_POSIX 1
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define CRC32C_HARDWARE 1
+#endif
+
 namespace fs = std::filesystem;
 
 const fs::path EMPLOYEE_DIR = "employees";
+
+// Committed transactions are written here before any employee file is touched, and replayed
+// on start up if the application stopped before applying them. Lives next to EMPLOYEE_DIR so
+// it is never loaded as an employee. Every session writes the same journal, so the lock file is
+// held from checking for an earlier journal until this one is removed.
+const fs::path EMPLOYEE_JOURNAL = "employees.journal";
+const fs::path EMPLOYEE_JOURNAL_LOCK = "employees.journal.lock";
+
+// Every add, edit, and remove is appended here in order, one line per change, for other systems
+// to tail. The lock file keeps sequence numbers in order across sessions.
+// It holds whole records, passwords included, so it is readable only by its owner, and the
+// password is replaced by REDACTED_PASSWORD wherever a record is printed.
+const fs::path EMPLOYEE_CHANGES = "employees.changes";
+const fs::path EMPLOYEE_CHANGES_LOCK = "employees.changes.lock";
+const int CHANGE_LOG_ATTEMPTS = 3;
+
+// The modification index built from the change log is saved here with the log position it was
+// built to, so a start only replays the log after it. Saved again once a start has replayed
+// more than CHECKPOINT_AFTER_EVENTS changes.
+const fs::path EMPLOYEE_CHANGES_CHECKPOINT = "employees.changes.checkpoint";
+const size_t CHECKPOINT_AFTER_EVENTS = 4096;
+const std::string REDACTED_PASSWORD = "*";
+
+// Past versions of each employee, one file per id. Most versions are stored as the fields that
+// changed, with the whole record every HISTORY_FULL_INTERVAL versions so rebuilding any version
+// never applies more than that many deltas.
+const fs::path EMPLOYEE_HISTORY_DIR = "employees.history";
+const int HISTORY_FULL_INTERVAL = 16;
+
+// Who did what to whom, as fixed size binary records in numbered segment files. A segment is
+// closed once it passes the size limit and only the newest few are kept. Records are written in
+// batches of at most AUDIT_RING_CAPACITY behind a header starting with AUDIT_BATCH_MARK, so a
+// reader can find the next batch after a torn one. Records that couldn't be written are kept
+// for the next flush, up to AUDIT_PENDING_LIMIT.
+const fs::path AUDIT_DIR = "employees.audit";
+const size_t AUDIT_RING_CAPACITY = 4096; // must be a power of two
+const int AUDIT_FLUSH_MS = 200;
+const long AUDIT_SEGMENT_BYTES = 4 << 20;
+const size_t AUDIT_SEGMENTS_KEPT = 16;
+const char AUDIT_MAGIC[8] = {'E', 'M', 'A', 'U', 'D', 'I', 'T', '2'};
+const char AUDIT_MAGIC_V1[8] = {'E', 'M', 'A', 'U', 'D', 'I', 'T', '1'};
+const uint32_t AUDIT_BATCH_MARK = 0x42445541;
+const size_t AUDIT_PENDING_LIMIT = AUDIT_RING_CAPACITY * 16;
+
+// Audit actions, stored as a number in each record.
+const uint32_t AUDIT_LOGIN = 1;
+const uint32_t AUDIT_LOGIN_FAILED = 2;
+const uint32_t AUDIT_VIEW = 3;
+const uint32_t AUDIT_EDIT = 4;
+const uint32_t AUDIT_REMOVE = 5;
+const uint32_t AUDIT_RESTORE = 6;
+
+// Removed employees are moved here, compressed, instead of being deleted. Records are packed into
+// blocks of up to ARCHIVE_BLOCK_RECORDS when the archive is rewritten, and removes older than the
+// retention are dropped by a purge. Records hold passwords, so it is readable only by its owner.
+const fs::path EMPLOYEE_ARCHIVE = "employees.archive";
+const fs::path EMPLOYEE_ARCHIVE_LOCK = "employees.archive.lock";
+const size_t ARCHIVE_BLOCK_RECORDS = 256;
+const int ARCHIVE_RETENTION_DAYS = 7 * 365;
+const char ARCHIVE_BLOCK_MAGIC[4] = {'E', 'A', 'B', '2'};
+const char ARCHIVE_BLOCK_MAGIC_V1[4] = {'E', 'A', 'B', '1'};
+
+// Kinds of change the undo journal can reverse, and how much memory its steps may use.
+const int UNDO_ADD = 1;
+const int UNDO_EDIT = 2;
+const int UNDO_REMOVE = 3;
+const size_t UNDO_BUDGET_BYTES = 256 * 1024;
+
+// Backups start with BACKUP_FILE_MAGIC, the change sequence they reflect, and the record count,
+// then hold the records in compressed blocks of up to BACKUP_BLOCK_RECORDS, each with a CRC32C.
+const char BACKUP_FILE_MAGIC[4] = {'E', 'B', 'K', '2'};
+const char BACKUP_FILE_MAGIC_V1[4] = {'E', 'B', 'K', '1'};
+const size_t BACKUP_BLOCK_RECORDS = 1024;
+
+// Packed store: records sorted by id and compressed in blocks of PACK_BLOCK_RECORDS, with a
+// dictionary trained on the names in the store, see PackStore. Records saved since packing are
+// files in EMPLOYEE_DIR, which win over the pack, and packed records removed since have an
+// <id>.removed marker there. It holds passwords, so it is readable only by its owner.
+const fs::path EMPLOYEE_PACK = "employees.pack";
+const fs::path EMPLOYEE_PACK_LOCK = "employees.pack.lock";
+const char PACK_MAGIC[4] = {'E', 'P', 'K', '1'};
+const size_t PACK_BLOCK_RECORDS = 64;
+const size_t PACK_DICTIONARY_BYTES = 8 * 1024;
+
+// Shared store: one process started with --share keeps the employees in a POSIX shared memory
+// segment that other processes read in place, see SharedStore. Each record line gets
+// SHARED_RECORD_SLACK spare bytes so small edits are written over it.
+const char SHARED_STORE_MAGIC[4] = {'E', 'S', 'M', '2'};
+const uint32_t SHARED_MIN_SLOTS = 1024;
+const uint32_t SHARED_RECORD_SLACK = 16;
+const int SHARED_READ_ATTEMPTS = 1 << 16;
+
+// A replica tails EMPLOYEE_CHANGES for the changes other sessions make, looking for new lines
+// this often, and applies them between screens. Replicas never change the store themselves.
+const int REPLICA_POLL_MS = 100;
+const std::string REPLICA_READ_ONLY = "This is a read only replica, make changes in another session.";
+
+// Written in place of an empty department or date, since fields in an employee file can't be blank.
+const std::string NO_DEPARTMENT = "-";
+
+// Version written on the first line of employee files. Files without one are version 1, which
+// stops after the department. Version 2 stops before the revision. Version 3 has no checksum
+// after the version, later ones carry the CRC32C of the record line in hex.
+const int RECORD_FORMAT_VERSION = 4;
+
+// CRC32C (Castagnoli) polynomial, reflected. SSE4.2 computes the same checksum in hardware.
+const uint32_t CRC32C_POLYNOMIAL = 0x82F63B78;
+
+// Records the integrity check can't trust are moved here instead of being loaded.
+const fs::path EMPLOYEE_QUARANTINE = "employees.quarantine";
+const int FSCK_CHECK = 0;
+const int FSCK_REPAIR = 1;
+const int FSCK_QUARANTINE = 2;
+
+// A record lock is only held while a save compares revisions and writes, so waiting longer than
+// this means another session is stuck. Where there is no flock, lock files older than the stale
+// age were left by a crash.
+const int RECORD_LOCK_WAIT_MS = 500;
+const int RECORD_LOCK_STALE_SECONDS = 10;
+
+// Typed columns kept for every row so numeric queries never touch the employee strings.
+// A value of 0 means the field was never set and is left out of range matches and aggregates.
+const int COLUMN_HIRE_DATE = 0;   // days since 1970-01-01
+const int COLUMN_SALARY_BAND = 1; // band number
+const int COLUMN_FTE = 2;         // percent of full time, 100 is full time
+const int NUMERIC_COLUMNS = 3;
 const short HEADER_WIDTH = 44;
 
+// Rows handed to a single search task. Small enough that a chunk of names stays
+// in a core's cache, big enough that task overhead is noise.
+const size_t SEARCH_CHUNK_ROWS = 4096;
+
+// Rows shown per page of a streamed list, and how many found rows may be queued
+// ahead of the list before the search waits for the reader.
+const size_t LIST_PAGE_SIZE = 20;
+const size_t STREAM_CHANNEL_CAPACITY = 1024;
+
+// Queries starting with this are matched by how names sound instead of spelling.
+const char PHONETIC_QUERY_PREFIX = '~';
+
+// Limits for the search result cache, in queries and in total cached rows.
+const size_t QUERY_CACHE_ENTRIES = 64;
+const size_t QUERY_CACHE_ROWS = 1 << 20;
+
+// Snapshots share unchanged pages of this many rows between versions, so a write copies one
+// page of pointers instead of the whole table. Reader slots bound how many snapshots can be
+// pinned at once.
+const size_t SNAPSHOT_PAGE_ROWS = 1024;
+const int SNAPSHOT_READER_SLOTS = 64;
+
 struct MenuOption
 {
     short menuPosition;
@@ -72,1451 +261,11208 @@ struct MenuOption
 const short HR_PERMS = 28;        // 0b11100
 const short MANAGEMENT_PERMS = 2; // 0b00010
 const short GENERAL_PERMS = 1;    // 0b00001
+const short PERMISSION_BITS = 5;
 
-class Application;
+/**
+ * @struct PoolStats
+ *
+ * @description - Snapshot of the counters kept by TaskPool, used to see how
+ * well work is being spread across the workers.
+ *
+ * @prop workers size_t - number of worker threads.
+ * @prop queued size_t - tasks currently waiting in any deque.
+ * @prop maxQueued size_t - highest number of waiting tasks seen so far.
+ * @prop executed size_t - tasks that have finished running.
+ * @prop steals size_t - tasks a worker took from another worker's deque.
+ */
+struct PoolStats
+{
+    size_t workers;
+    size_t queued;
+    size_t maxQueued;
+    size_t executed;
+    size_t steals;
+};
 
 /**
- * @class Employee
+ * @class TaskPool
  *
- * @description - This class is what handles all of the logic and data storage
- * for employees
+ * @description - A work-stealing task scheduler shared by the whole application.
+ * Every worker owns a deque, it pushes and pops its own work from the back and
+ * when it runs dry it steals from the front of another worker's deque. Threads
+ * that are not workers (the main thread) push round robin onto the deques and
+ * help run tasks while they wait on a TaskGroup.
  *
- * @prop private permissions short - permissions of employee
- * @prop private password string - password of employee
- * @prop public id int - id of employee
- * @prop public firstName string - first name of employee
- * @prop public lastName string - last name of employee
- * @prop public username string - username of employee
- * @prop public file fs::path - file path of employee
+ * @prop private workers - One deque (and lock) per worker thread.
+ * @prop private threads - The worker threads.
+ * @prop private queued - Number of tasks waiting to be picked up.
  *
- * @method public write - Writes the current state of Employee to associated
- * file. Will create file if not exists.
- * @method public isValidLogin - This function will check if the username and
- * password provided are valid for the employee.
- * @method public static from - This function will read the contents of the file
- * provided and create an instance of Employee from it.
- * @method public hasPermission - This function will check if the employee has
- * the permission provided.
- * @method public updatePassword - This function will update the password of the
- * employee.
- * @method public updatePermissions - This function will update the permissions
- * of the employee.
+ * @method public submit - Queue a task to be run by the pool.
+ * @method public runOne - Run a single queued task on the calling thread if one exists.
+ * @method public parallelFor - Split a range into chunks and run them across the pool.
+ * @method public size - Number of worker threads.
+ * @method public stats - Current queue depth and steal counters.
  *
  */
-class Employee
+class TaskPool
 {
-    short permissions;
-    std::string password;
+    struct Worker
+    {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
 
-public:
-    int id;
-    std::string firstName;
-    std::string lastName;
-    std::string username;
-    fs::path file;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    bool stopping;
 
-    Employee() {}
-    Employee(int id, std::string firstName, std::string lastName, std::string username,
-             std::string password, short permissions)
-    {
-        this->id = id;
-        this->firstName = firstName;
-        this->lastName = lastName;
-        this->username = username;
-        this->password = password;
-        this->permissions = permissions;
-    }
+    std::atomic<size_t> queued;
+    std::atomic<size_t> maxQueued;
+    std::atomic<size_t> executed;
+    std::atomic<size_t> steals;
+    std::atomic<size_t> nextWorker;
+
+    // Index of the worker the current thread is, -1 on threads outside the pool.
+    static inline thread_local int workerIndex = -1;
 
     /**
-     * @function write
+     * @function take
      *
-     * @description - writes the current state of Employee to associated file.
-     * Will create file if not exists.
-     *  - Employee file will be named after the employee's id.
-     *  - File contents will be in the format of:
-     *  - id username firstName lastName password permissions
+     * @description - Pops a task for the worker at index self. It looks at its own
+     * deque first (newest task) and then walks the other deques stealing the oldest task.
      *
-     * @return bool - indicates the success or failure of writing to employeeFile
+     * @param int self - Index of the calling worker, -1 when called from outside the pool.
+     * @param function task - Set to the task that was taken.
      *
+     * @return bool - Returns true if a task was taken.
      */
-    bool write()
+    bool take(int self, std::function<void()> &task)
     {
-        std::ostringstream oss;
-        oss << this->id << ".txt";
+        if (self >= 0)
+        {
+            Worker &own = *this->workers[self];
+            std::lock_guard<std::mutex> guard(own.lock);
+            if (!own.tasks.empty())
+            {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                this->queued--;
+                return true;
+            }
+        }
 
-        this->file = EMPLOYEE_DIR / oss.str();
+        size_t count = this->workers.size();
+        size_t start = self >= 0 ? self + 1 : this->nextWorker.load();
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t victim = (start + i) % count;
+            if ((int)victim == self)
+            {
+                continue;
+            }
 
-        std::ofstream employeeFile;
-        employeeFile.open(this->file, std::ios::out | std::ios::trunc);
+            Worker &other = *this->workers[victim];
+            std::lock_guard<std::mutex> guard(other.lock);
+            if (!other.tasks.empty())
+            {
+                task = std::move(other.tasks.front());
+                other.tasks.pop_front();
+                this->queued--;
+                if (self >= 0)
+                {
+                    this->steals++;
+                }
+                return true;
+            }
+        }
 
-        // Something went wrong while creating or opening the file, we need to
-        // return false;
-        if (!employeeFile)
+        return false;
+    }
+
+    void workerLoop(int self)
+    {
+        workerIndex = self;
+
+        while (true)
         {
-            return false;
-        }
+            std::function<void()> task;
+            if (this->take(self, task))
+            {
+                task();
+                this->executed++;
+                continue;
+            }
 
-        oss.str(std::string());
-        oss << this->id << " " << this->username << " " << this->firstName << " "
-            << this->lastName << " " << this->password << " " << this->permissions;
+            std::unique_lock<std::mutex> guard(this->sleepLock);
+            this->wake.wait(guard, [this]
+                            { return this->stopping || this->queued.load() > 0; });
+
+            if (this->stopping && this->queued.load() == 0)
+            {
+                return;
+            }
+        }
+    }
 
-        employeeFile << oss.str() << std::endl;
+public:
+    TaskPool(unsigned threadCount = std::thread::hardware_concurrency())
+        : stopping(false), queued(0), maxQueued(0), executed(0), steals(0), nextWorker(0)
+    {
+        if (threadCount == 0)
+        {
+            threadCount = 1;
+        }
 
-        employeeFile.close();
+        for (unsigned i = 0; i < threadCount; ++i)
+        {
+            this->workers.push_back(std::make_unique<Worker>());
+        }
 
-        return true;
+        for (unsigned i = 0; i < threadCount; ++i)
+        {
+            this->threads.emplace_back([this, i]
+                                       { this->workerLoop(i); });
+        }
     }
 
-    /**
-     * @function isValidLogin
-     *
-     * @description - This function will check if the username and password
-     * provided are valid for the employee.
-     *
-     * @param string username - The username that the user has entered.
-     * @param string password - The password that the user has entered.
-     *
-     * @return bool - Returns true if the login is valid, false otherwise.
-     *
-     */
-    bool isValidLogin(std::string username, std::string password)
+    ~TaskPool()
     {
-        return this->username == username && this->password == password;
+        {
+            std::lock_guard<std::mutex> guard(this->sleepLock);
+            this->stopping = true;
+        }
+        this->wake.notify_all();
+
+        for (auto &t : this->threads)
+        {
+            t.join();
+        }
     }
 
+    TaskPool(const TaskPool &) = delete;
+    TaskPool &operator=(const TaskPool &) = delete;
+
     /**
-     * @function from - static
-     *
-     * @description - This function will read the contents of the file provided
-     * and create an instance of Employee from it.
+     * @function submit
      *
-     * @param file - file address of file that the employee will be built from.
-     * @param employee - Pointer to the instance of employee that will be written
-     * to if file reading succeeds
+     * @description - Queues a task. Workers push onto their own deque so nested work
+     * stays local, everyone else spreads tasks round robin across the deques.
      *
-     * @return bool - returns true if file reading and employee creation was
-     * successful, false otherwise.
+     * @param function task - The work to run.
      *
+     * @return void
      */
-    static bool from(fs::path employeeFile, Employee *employee)
+    void submit(std::function<void()> task)
     {
-        std::ifstream file;
-        file.open(employeeFile);
+        size_t target = workerIndex >= 0 ? workerIndex
+                                         : this->nextWorker++ % this->workers.size();
 
-        // Something has gone wrong with getting the file, so we return false
-        if (!file)
+        size_t depth;
         {
-            return false;
+            Worker &w = *this->workers[target];
+            std::lock_guard<std::mutex> guard(w.lock);
+            w.tasks.push_back(std::move(task));
+            depth = ++this->queued;
         }
 
-        std::string contents;
-        while (getline(file, contents))
+        size_t seen = this->maxQueued.load();
+        while (depth > seen && !this->maxQueued.compare_exchange_weak(seen, depth))
         {
-            std::istringstream iss(contents);
-
-            iss >> employee->id >> employee->username >> employee->firstName >>
-                employee->lastName >> employee->password >> employee->permissions;
         }
 
-        employee->file = employeeFile;
+        // Taking the sleep lock here keeps a worker from missing the wake up
+        // between checking the queue and going to sleep.
+        {
+            std::lock_guard<std::mutex> guard(this->sleepLock);
+        }
+        this->wake.notify_one();
+    }
 
-        file.close();
+    /**
+     * @function runOne
+     *
+     * @description - Runs one queued task on the calling thread. Used by TaskGroup::wait
+     * so the waiting thread helps instead of blocking.
+     *
+     * @return bool - Returns true if a task was run.
+     */
+    bool runOne()
+    {
+        std::function<void()> task;
+        if (!this->take(workerIndex, task))
+        {
+            return false;
+        }
 
+        task();
+        this->executed++;
         return true;
     }
 
     /**
-     * @function hasPermission
-     *
-     * @description - This function will check if the employee has the permission
-     * provided.
+     * @function parallelFor
      *
-     * @param short permission - The permission that we are checking if the
-     * employee has.
+     * @description - Splits [begin, end) into chunks of at most grain items and runs
+     * body(chunkBegin, chunkEnd) for each chunk on the pool. Returns once every chunk
+     * has finished. Defined after TaskGroup.
      *
-     * @return bool - Returns true if the employee has the permission, false
-     * otherwise.
+     * @param size_t begin - First index of the range.
+     * @param size_t end - One past the last index of the range.
+     * @param size_t grain - Largest number of items handed to a single task.
+     * @param function body - Work to run for each chunk.
      *
+     * @return void
      */
-    bool hasPermission(short permission)
-    {
-        return (this->permissions & permission) != 0;
-    }
+    void parallelFor(size_t begin, size_t end, size_t grain,
+                     const std::function<void(size_t, size_t)> &body);
+
+    size_t size() { return this->workers.size(); }
 
     /**
-     * @function toString
-     *
-     * @description - Takes a strategy parameter and returns a string with the
-     * employee information.
+     * @function stats
      *
-     * @param short mode - number value of what type of display
-     *  - 0 - Default, short list based display "id: First Last, Username"
-     *  - 1 - Page version of the display, that contains all the public
-     * information for a employee
+     * @description - Reads the scheduler counters.
      *
-     *  @returns string - built string of display for the employee
+     * @return PoolStats - Current queue depth, high water mark, executed and steal counts.
      */
-    std::string toString(short mode)
+    PoolStats stats()
     {
-        std::ostringstream oss;
+        PoolStats s;
+        s.workers = this->workers.size();
+        s.queued = this->queued.load();
+        s.maxQueued = this->maxQueued.load();
+        s.executed = this->executed.load();
+        s.steals = this->steals.load();
+        return s;
+    }
+};
 
-        switch (mode)
+/**
+ * @class TaskGroup
+ *
+ * @description - A set of tasks submitted to a TaskPool that can be joined. The
+ * thread calling wait runs queued tasks until every task in the group is done, so
+ * groups can be nested inside pool tasks without deadlocking. The first exception
+ * thrown by a task is rethrown from wait.
+ *
+ * @method public run - Submit a task as part of this group.
+ * @method public wait - Block (while helping) until all tasks in the group finished.
+ *
+ */
+class TaskGroup
+{
+    TaskPool *pool;
+    std::atomic<size_t> outstanding;
+    std::mutex errorLock;
+    std::exception_ptr error;
+
+public:
+    TaskGroup(TaskPool *pool) : pool(pool), outstanding(0) {}
+
+    ~TaskGroup()
+    {
+        // Tasks hold a pointer to the group, never let it go out of scope early.
+        while (this->outstanding.load() > 0)
         {
-        case 1:
-            oss << "ID: " << this->id << std::endl
-                << "Name: " << this->firstName << " " << this->lastName << std::endl
-                << "Username: " << this->username << std::endl;
-            break;
-        default:
-            oss << this->id << ": " << this->firstName << " " << this->lastName
-                << ", " << this->username << std::endl;
-            break;
+            if (!this->pool->runOne())
+            {
+                std::this_thread::yield();
+            }
         }
-
-        return oss.str();
     }
 
-    /**
-    * @function updatePassword
-    *
-    * @description - This function will update the password of the employee.
-    * 
-    * @param string password - The new password that the employee will have.
-    * 
-    * @return void
-    * 
-    */
-    void updatePassword(std::string password)
+    void run(std::function<void()> task)
     {
-        this->password = password;
+        this->outstanding++;
+        this->pool->submit([this, task = std::move(task)]
+                           {
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> guard(this->errorLock);
+                if (!this->error)
+                {
+                    this->error = std::current_exception();
+                }
+            }
+            this->outstanding--; });
     }
 
-    /**
-    * @function updatePermissions
-    *
-    * @description - This function will update the permissions of the employee.
-    * 
-    * @param int permissions - The new permissions that the employee will have.
-    * 
-    * @return void   
-    */
-    void updatePermissions(int permissions)
+    void wait()
     {
-        this->permissions = permissions;
+        while (this->outstanding.load() > 0)
+        {
+            if (!this->pool->runOne())
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        if (this->error)
+        {
+            std::exception_ptr e = this->error;
+            this->error = nullptr;
+            std::rethrow_exception(e);
+        }
     }
 };
 
+void TaskPool::parallelFor(size_t begin, size_t end, size_t grain,
+                           const std::function<void(size_t, size_t)> &body)
+{
+    if (begin >= end)
+    {
+        return;
+    }
 
-/**
- * @class Screen
- * 
- * @description - This class is a abstract class that will be used to create
- * screens for the application. It will provide a base for the screens to be
- * built from.
- * 
- * @prop name - The name of the screen.
- * @prop headerText - The text that will be displayed in the header of the screen.
- * @prop headerWidth - The width of the header of the screen.
- * 
- * @method display - This function will be used to display the screen to the user.
- * @method renderScreenBody - Pure virtual function that will be used to render
- * the body of the screen.
- * @method renderInteractiveContent - Pure virtual function that will be used to render
- * the interactive content of the screen.
- * @method printScreenHeader - This function will be used to print the header of the screen.
- * @method clearScreen - This function will be used to clear the screen.
- * 
-*/
-class Screen
-{
-public:
-    std::string name;
-    std::string headerText;
-    short headerWidth;
-
-    virtual ~Screen() = 0;
+    if (grain == 0)
+    {
+        grain = 1;
+    }
 
-    /**
-     * @function display
-     * 
-     * @description - This function will be used to display the screen to the user.
-     * 
-     * @return void
-     * 
-    */
-    void display()
+    // Small ranges are not worth the hop to another thread.
+    if (end - begin <= grain)
     {
-        Screen::clearScreen();
+        body(begin, end);
+        return;
+    }
 
-        this->printScreenHeader();
-        this->renderScreenBody();
-        this->renderInteractiveContent();
+    TaskGroup group(this);
+    for (size_t lo = begin; lo < end; lo += grain)
+    {
+        size_t hi = std::min(end, lo + grain);
+        group.run([&body, lo, hi]
+                  { body(lo, hi); });
     }
+    group.wait();
+}
 
-    /**
-     * @function renderScreenBody - pure virtual
-     *
-     * @description - This function will be used to render the body of the screen. Which is 
-     * displayed just prior to interactive content.
-     * 
-     * @return void
-     */
-    virtual void renderScreenBody() = 0;
+/**
+ * @class BoundedChannel
+ *
+ * @description - A fixed capacity queue used to hand values from a producer running
+ * on the pool to a reader on the main thread. The producer blocks when the channel is
+ * full, so it never runs far ahead of what is being read. The reader can cancel, which
+ * makes the next push fail so the producer stops early.
+ *
+ * @method public push - Add a value, waiting for room. Returns false once cancelled.
+ * @method public pop - Take the next value, waiting for one. Returns false once closed and drained.
+ * @method public close - Called by the producer when it has nothing more to send.
+ * @method public cancel - Called by the reader to stop the producer and drop queued values.
+ * @method public waitClosed - Block until the producer has closed the channel.
+ *
+ */
+template <typename T>
+class BoundedChannel
+{
+    std::mutex lock;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::deque<T> items;
+    size_t capacity;
+    bool closed;
+    bool cancelled;
 
-    /**
-     * @function renderInteractiveContent - pure virtual
-     *
-     * @description - This function will be used to render the interactive content of the screen.
-     * 
-     * @return void
-     */
-    virtual void renderInteractiveContent() = 0;
+public:
+    BoundedChannel(size_t capacity) : capacity(capacity), closed(false), cancelled(false) {}
 
-    /**
-     * @function printScreenHeader
-     *
-     * @description This function will calculate the height needed to provide
-     * spacing around the title, and will print via cout.
-     *
-     * @return void
-     */
-    virtual void printScreenHeader()
+    bool push(T item)
     {
-        // To calc height we need to divide to find the number of lines needed, we
-        // want a minimum of 5 lines. We include 2 blank spaces on both sides
-        // horizontally, then we also want a blank line above and below screen.
-        int lineCount =
-            (int)ceil((float)this->headerText.length() / (this->headerWidth - 4));
-        int height = std::max(lineCount + 2, 5);
-
-        // This is the index in which we need to start printing the screenName
-        int startIndex = round(((float)height / 2) - floor(lineCount / 2)) - 1;
+        std::unique_lock<std::mutex> guard(this->lock);
+        this->notFull.wait(guard, [this]
+                           { return this->cancelled || this->items.size() < this->capacity; });
 
-        for (int i = 0; i < height; ++i)
+        if (this->cancelled)
         {
-            if (i == 0 || i == height - 1)
-            {
-                std::string s(headerWidth, '*');
-
-                std::cout << s << std::endl;
-                continue;
-            }
-
-            // For now we are going to support one line, here we are going to build
-            // the line where we provide space around the word.
-            if (i == startIndex)
-            {
-                std::string left(ceil((headerWidth - this->headerText.length()) / 2.0), ' ');
-                std::string right(headerWidth - (left.length() + this->headerText.length()),
-                             ' ');
-                left[0] = '*';
-                right[right.length() - 1] = '*';
+            return false;
+        }
 
-                std::cout << left << this->headerText << right << std::endl;
-                continue;
-            }
+        this->items.push_back(std::move(item));
+        this->notEmpty.notify_one();
+        return true;
+    }
 
-            std::string s(headerWidth, ' ');
-            s[0] = '*';
-            s[s.length() - 1] = '*';
+    bool pop(T &item)
+    {
+        std::unique_lock<std::mutex> guard(this->lock);
+        this->notEmpty.wait(guard, [this]
+                            { return this->closed || !this->items.empty(); });
 
-            std::cout << s << std::endl;
+        if (this->items.empty())
+        {
+            return false;
         }
 
-        // I want a newline after the title
-        std::cout << std::endl;
+        item = std::move(this->items.front());
+        this->items.pop_front();
+        this->notFull.notify_one();
+        return true;
     }
 
-    /**
-     * @function clearScreen
-     * 
-     * @description - This function will be used to clear the screen.
-     * 
-     * @return void
-    */
-    static void clearScreen()
+    void close()
     {
-#if defined _WIN32
-        system("cls");
-#elif defined(__LINUX__) || defined(__gnu_linux__) || defined(__linux__)
-        system("clear");
-#elif defined(__APPLE__)
-        system("clear");
-#endif
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->closed = true;
+        this->notEmpty.notify_all();
     }
-};
-// Destructor
-Screen::~Screen(){};
 
-/**
- * @class LoginScreen
- * 
- * @description - This class will be used to create the login screen for the application.
- * 
- * @prop private Application *app - The application object.
- * 
- * @method public LoginScreen(Application *a) - The constructor for the login screen.
- * @method public renderInteractiveContent - This function will be used to render the interactive content of the screen.
- * @method public renderScreenBody - This function will be used to render the body of the screen.
- * 
-*/
-class LoginScreen : public Screen
-{
-    Application *app;
+    void cancel()
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->cancelled = true;
+        this->items.clear();
+        this->notFull.notify_all();
+    }
 
-public:
-    void renderInteractiveContent() override;
-    LoginScreen(Application *a) : app(a)
+    bool isCancelled()
     {
-        name = "login";
-        headerText = "Welcome to FooBar Employee Management";
-        headerWidth = HEADER_WIDTH;
+        std::lock_guard<std::mutex> guard(this->lock);
+        return this->cancelled;
     }
 
-    void renderScreenBody() override
+    void waitClosed()
     {
-        std::cout << "***  Login to Continue  ***" << std::endl
-             << std::endl;
+        std::unique_lock<std::mutex> guard(this->lock);
+        this->notEmpty.wait(guard, [this]
+                            { return this->closed; });
     }
 };
 
 /**
- * @class MenuOption
- * 
- * @description - This class will be used to create menu options for the menu screen.
- * 
- * @prop private Application *app - The application object.
- * @prop private vector<string> options - The options that will be displayed to the user.
- * @prop private bool optionsInitialized - A flag to determine if the options have been initialized. 
- * This is due to them needing the application object.
- * 
- * @method public MenuOption(Application *a) - Constructor that takes the application object.
- * @method public void buildMenuOptions() - This function will be used to build the menu options.
- * 
-*/
-class MenuScreen : public Screen
+ * @function foldCodePoint
+ *
+ * @description - Unicode simple case folding for the scripts our names come in: Latin
+ * (Latin-1, Extended-A and Extended Additional), Greek, Cyrillic, Armenian and fullwidth Latin.
+ * Code points outside those blocks are returned unchanged.
+ *
+ * @param uint32_t cp - The code point to fold.
+ *
+ * @return uint32_t - The folded code point.
+ */
+uint32_t foldCodePoint(uint32_t cp)
 {
-    Application *app;
-    std::vector<MenuOption> options;
-    bool optionsInitialized;
+    if (cp < 0x80)
+    {
+        return (cp >= 'A' && cp <= 'Z') ? cp + 32 : cp;
+    }
 
-public:
-    MenuScreen(Application *a) : app(a)
+    // Latin-1 Supplement, the multiplication sign sits in the middle of the capitals.
+    if (cp >= 0xC0 && cp <= 0xDE && cp != 0xD7)
     {
-        this->name = "menu";
-        this->headerWidth = HEADER_WIDTH;
-        this->headerText = "testing";
-        this->optionsInitialized = false;
+        return cp + 32;
+    }
+    if (cp == 0xB5)
+    {
+        return 0x3BC;
     }
 
-    void prePrintHeader();
-    void renderInteractiveContent() override;
-    void buildMenuOptions();
+    // Latin Extended-A, capitals and smalls alternate but the parity flips twice.
+    if ((cp >= 0x100 && cp <= 0x12F) || (cp >= 0x132 && cp <= 0x137) || (cp >= 0x14A && cp <= 0x177))
+    {
+        return cp | 1;
+    }
+    if ((cp >= 0x139 && cp <= 0x148) || (cp >= 0x179 && cp <= 0x17E))
+    {
+        return (cp & 1) ? cp + 1 : cp;
+    }
+    if (cp == 0x178)
+    {
+        return 0xFF;
+    }
+    if (cp == 0x17F)
+    {
+        return 's';
+    }
 
-    /**
-     * @function renderScreenHeader
-     * 
-     * @description - This function will be used to render the header of the screen. 
-     * This is an override, that calls the base implementation.
-     * 
-     * @return void
-    */
-    void printScreenHeader() override
+    // Greek
+    if ((cp >= 0x391 && cp <= 0x3A1) || (cp >= 0x3A3 && cp <= 0x3AB))
     {
-        this->prePrintHeader();
+        return cp + 32;
+    }
+    if (cp == 0x386)
+    {
+        return 0x3AC;
+    }
+    if (cp >= 0x388 && cp <= 0x38A)
+    {
+        return cp + 37;
+    }
+    if (cp == 0x38C)
+    {
+        return 0x3CC;
+    }
+    if (cp == 0x38E || cp == 0x38F)
+    {
+        return cp + 63;
+    }
+    if (cp == 0x3C2)
+    {
+        return 0x3C3;
+    }
 
-        Screen::printScreenHeader();
+    // Cyrillic
+    if (cp >= 0x400 && cp <= 0x40F)
+    {
+        return cp + 80;
+    }
+    if (cp >= 0x410 && cp <= 0x42F)
+    {
+        return cp + 32;
+    }
+    if ((cp >= 0x460 && cp <= 0x481) || (cp >= 0x48A && cp <= 0x4BF) || (cp >= 0x4D0 && cp <= 0x52F))
+    {
+        return cp | 1;
+    }
+    if (cp == 0x4C0)
+    {
+        return 0x4CF;
+    }
+    if (cp >= 0x4C1 && cp <= 0x4CE)
+    {
+        return (cp & 1) ? cp + 1 : cp;
     }
 
-    /**
-     * @function renderScreenBody
-     * 
-     * @description - This function will be used to render the body of the screen.
-     * 
-     * @return void
-    */
-    void renderScreenBody() override
+    // Armenian
+    if (cp >= 0x531 && cp <= 0x556)
     {
-        std::cout << "***  What do you need to do today?  ***" << std::endl
-             << std::endl;
+        return cp + 48;
     }
-};
 
-/**
- * 
- * @class ListScreen
- * 
- * @description - This class will be used to create the list screen for the application. 
- * Is also used for search results and listing on the remove page.
- * 
- * @prop private Application *app - The application object.
- * @prop public vector<Employee> employees - The employees that will be displayed on the screen.
- * @prop public bool employeesOverriden - A flag to determine if the employees have been overriden. 
- * If true use this class's employees. Otherwise use the application's employees.
- * @prop private bool isRemove - A flag to determine if this is the remove screen.
- * 
- * @method public ListScreen(Application *a) - The constructor for the list screen.
- * @method public ListScreen(Application *a, string searchQuery, vector<Employee> employees) - 
- * The constructor for the list screen with search results.
- * @method public ListScreen(Application *a, bool isRemove) - The constructor for the list screen for the remove screen.
- * @method public void renderInteractiveContent - This function will be used to render the interactive content of the screen.
- * @method public vector<Employee> getEmployees - This function will be used to get the employees. 
- * This is where the employeesOverriden flag is used.
- * 
- * 
-*/
-class ListScreen : public Screen
-{
-    bool isRemove;
-    Application *app;
-
-public:
-    std::vector<Employee> employees;
-    bool employeesOverriden;
-
-    void renderInteractiveContent() override;
-    std::vector<Employee> getEmployees();
-
-    ListScreen(Application *a) : app(a)
+    // Latin Extended Additional (Vietnamese and friends), capital sharp s folds to sharp s.
+    if ((cp >= 0x1E00 && cp <= 0x1E95) || (cp >= 0x1EA0 && cp <= 0x1EFF))
     {
-        name = "list";
-        headerText = "Viewing All Employees";
-        headerWidth = HEADER_WIDTH;
-        employeesOverriden = false;
-        isRemove = false;
+        return cp | 1;
     }
-
-    ListScreen(Application *a, std::string searchQuery, std::vector<Employee> employees) : app(a)
+    if (cp == 0x1E9E)
     {
-        name = "search-list";
-
-        std::ostringstream oss;
-        oss << "Showing employees like \"" << searchQuery << "\"";
-        headerText = oss.str();
-        headerWidth = HEADER_WIDTH;
-
-        this->employees = employees;
-        employeesOverriden = true;
-        isRemove = false;
+        return 0xDF;
     }
 
-    ListScreen(Application *a, std::string remove) : app(a)
+    // Fullwidth Latin capitals
+    if (cp >= 0xFF21 && cp <= 0xFF3A)
     {
-        name = "list";
-        headerText = "Remove Employee";
-        headerWidth = HEADER_WIDTH;
-        isRemove = true;
-        employeesOverriden = false;
+        return cp + 32;
     }
 
-    void renderScreenBody() override
+    return cp;
+}
+
+/**
+ * @function composeCodePoint
+ *
+ * @description - Canonical composition of a lower case Latin letter with a following combining
+ * mark, so a name typed as "e" + U+0301 compares equal to one typed with a precomposed "é".
+ *
+ * @param uint32_t base - The folded letter before the mark.
+ * @param uint32_t mark - The combining mark.
+ *
+ * @return uint32_t - The precomposed code point, or 0 if the pair has none.
+ */
+uint32_t composeCodePoint(uint32_t base, uint32_t mark)
+{
+    static const uint32_t pairs[][3] = {
+        {'a', 0x300, 0xE0}, {'a', 0x301, 0xE1}, {'a', 0x302, 0xE2}, {'a', 0x303, 0xE3},
+        {'a', 0x308, 0xE4}, {'a', 0x30A, 0xE5}, {'a', 0x306, 0x103}, {'a', 0x328, 0x105},
+        {'c', 0x301, 0x107}, {'c', 0x30C, 0x10D}, {'c', 0x327, 0xE7}, {'d', 0x30C, 0x10F},
+        {'e', 0x300, 0xE8}, {'e', 0x301, 0xE9}, {'e', 0x302, 0xEA}, {'e', 0x308, 0xEB},
+        {'e', 0x30C, 0x11B}, {'e', 0x328, 0x119}, {'g', 0x306, 0x11F}, {'i', 0x300, 0xEC},
+        {'i', 0x301, 0xED}, {'i', 0x302, 0xEE}, {'i', 0x308, 0xEF}, {'l', 0x301, 0x13A},
+        {'n', 0x301, 0x144}, {'n', 0x303, 0xF1}, {'n', 0x30C, 0x148}, {'o', 0x300, 0xF2},
+        {'o', 0x301, 0xF3}, {'o', 0x302, 0xF4}, {'o', 0x303, 0xF5}, {'o', 0x308, 0xF6},
+        {'o', 0x30B, 0x151}, {'r', 0x30C, 0x159}, {'s', 0x301, 0x15B}, {'s', 0x30C, 0x161},
+        {'s', 0x327, 0x15F}, {'t', 0x30C, 0x165}, {'u', 0x300, 0xF9}, {'u', 0x301, 0xFA},
+        {'u', 0x302, 0xFB}, {'u', 0x308, 0xFC}, {'u', 0x30A, 0x16F}, {'u', 0x30B, 0x171},
+        {'y', 0x301, 0xFD}, {'y', 0x308, 0xFF}, {'z', 0x301, 0x17A}, {'z', 0x307, 0x17C},
+        {'z', 0x30C, 0x17E}};
+
+    for (const auto &pair : pairs)
     {
-        if (this->isRemove)
-        {
-            std::cout << "***  Insert Id of Employee to Remove ***" << std::endl
-                 << std::endl;
-        }
-        else
+        if (pair[0] == base && pair[1] == mark)
         {
-            std::cout << "***  Insert Id of Employee to Edit/View  ***" << std::endl
-                 << std::endl;
+            return pair[2];
         }
     }
-};
+
+    return 0;
+}
 
 /**
- * @class SearchScreen
- * 
- * @description - This class will be used to create the search screen for the application.
- * 
- * @prop private Application *app - The application object.
- * 
- * @method public SearchScreen(Application *a) - The constructor for the search screen.
- * @method public void renderInteractiveContent - This function will be used to render the interactive content of the screen.
- * 
-*/
-class SearchScreen : public Screen
+ * @function appendUtf8
+ *
+ * @description - Encodes a code point as UTF-8 onto the end of a string.
+ *
+ * @param string out - The string to append to.
+ * @param uint32_t cp - The code point to encode.
+ *
+ * @return void
+ */
+void appendUtf8(std::string &out, uint32_t cp)
 {
-    Application *app;
-
-public:
-    void renderInteractiveContent() override;
-    SearchScreen(Application *a) : app(a)
+    if (cp < 0x80)
     {
-        name = "search";
-        headerText = "Search Employees";
-        headerWidth = HEADER_WIDTH;
+        out.push_back((char)cp);
     }
-
-    void renderScreenBody() override
+    else if (cp < 0x800)
     {
-        std::cout << "***  Insert Search Query by names, or username to Search ***" << std::endl
-             << std::endl;
+        out.push_back((char)(0xC0 | (cp >> 6)));
+        out.push_back((char)(0x80 | (cp & 0x3F)));
     }
-};
-
-/**
- * @class AddEmployeeScreen
- * 
- * @description - This class will be used to create the add employee screen for the application.
- * 
- * @prop private Application *app - The application object.
- * 
- * @method public AddEmployeeScreen(Application *a) - The constructor for the add employee screen.
- * @method public void renderInteractiveContent - This function will be used to render the interactive content of the screen.
- * 
-*/
-class AddEmployeeScreen : public Screen
-{
-    Application *app;
-
-public:
-    void renderInteractiveContent() override;
-    AddEmployeeScreen(Application *a) : app(a)
+    else if (cp < 0x10000)
     {
-        name = "add";
-        headerText = "Add a new Employee";
-        headerWidth = HEADER_WIDTH;
+        out.push_back((char)(0xE0 | (cp >> 12)));
+        out.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back((char)(0x80 | (cp & 0x3F)));
     }
-
-    void renderScreenBody() override
+    else
     {
-        std::cout << "***  Answer prompts to add new employee.  ***" << std::endl
-             << std::endl;
-    };
-};
+        out.push_back((char)(0xF0 | (cp >> 18)));
+        out.push_back((char)(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back((char)(0x80 | (cp & 0x3F)));
+    }
+}
 
 /**
- * @class EditScreen
- * 
- * @description - This class will be used to create the edit screen for the application.
- * 
- * @prop private Application *app - The application object.
- * @prop private Employee *employee - The employee object.
- * 
- * @method public EditScreen(Application *a, Employee *employee) - The constructor for the edit screen.
- * @method public void renderInteractiveContent - This function will be used to render the interactive content of the screen.
- * 
-*/
-class EditScreen : public Screen
+ * @function foldAsciiInPlace
+ *
+ * @description - Lower cases a string that is known to be plain ASCII. Works on 8 bytes at a
+ * time: a byte is a capital when adding the right bias carries into its high bit for 'A' but
+ * not for 'Z', and those bytes get 0x20 set.
+ *
+ * @param string text - The ASCII string to lower case.
+ *
+ * @return void
+ */
+void foldAsciiInPlace(std::string &text)
 {
-    Application *app;
-    Employee *employee;
-
-public:
-    void renderInteractiveContent() override;
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t high = 0x8080808080808080ULL;
 
-    EditScreen(Application *a, Employee *employee) : app(a)
+    size_t i = 0;
+    for (; i + 8 <= text.size(); i += 8)
     {
-        name = "edit";
-        headerText = "Edit Employee";
-        headerWidth = HEADER_WIDTH;
-        this->employee = employee;
+        uint64_t word;
+        std::memcpy(&word, text.data() + i, 8);
+
+        uint64_t atLeastA = word + ones * (0x80 - 'A');
+        uint64_t aboveZ = word + ones * (0x7F - 'Z');
+        uint64_t capitals = atLeastA & ~aboveZ & high;
+        word |= capitals >> 2;
+
+        std::memcpy(&text[i], &word, 8);
     }
 
-    void renderScreenBody() override
+    for (; i < text.size(); ++i)
     {
-        std::cout << "***  Answer prompts to employee information (Leave blank for no change).  ***" << std::endl
-             << std::endl;
-    };
-};
+        if (text[i] >= 'A' && text[i] <= 'Z')
+        {
+            text[i] += 32;
+        }
+    }
+}
 
 /**
- * @class FileScreen
- * 
- * @description - This class will be used to create the file screen for the application.
- * 
- * @prop private Application *app - The application object.
- * @prop private Employee *employee - The employee object.
- * @prop private bool employeeOverriden - The flag to check if the employee object is overriden.
- * 
- * @method public FileScreen(Application *a) - The constructor for the file screen.
- * @method public FileScreen(Application *a, Employee *employee) - The constructor for the file screen with a specific employee.
-*/
-class FileScreen : public Screen
+ * @function isAscii
+ *
+ * @description - Checks 8 bytes at a time for any byte with the high bit set.
+ *
+ * @param string text - The string to check.
+ *
+ * @return bool - Returns true if every byte is ASCII.
+ */
+bool isAscii(const std::string &text)
 {
-    Application *app;
-    Employee *employee;
-    bool employeeOverriden;
+    const uint64_t high = 0x8080808080808080ULL;
 
-public:
-    void renderInteractiveContent() override;
-    Employee *getEmployee();
-    FileScreen(Application *a) : app(a)
+    size_t i = 0;
+    uint64_t seen = 0;
+    for (; i + 8 <= text.size(); i += 8)
     {
-        name = "file";
-        headerText = "Viewing Your Profile";
-        headerWidth = HEADER_WIDTH;
+        uint64_t word;
+        std::memcpy(&word, text.data() + i, 8);
+        seen |= word;
     }
 
-    FileScreen(Application *a, Employee *employee) : app(a)
+    for (; i < text.size(); ++i)
     {
-        name = "specific file";
-        headerText = "Viewing Profile";
-        headerWidth = HEADER_WIDTH;
-        this->employee = employee;
-        employeeOverriden = true;
+        seen |= (unsigned char)text[i];
     }
 
-    void renderScreenBody() override{};
-};
+    return (seen & high) == 0;
+}
 
 /**
- * @class Application
- * 
- * @description - This class will be used to create the application object for the application.
- * 
- * @prop private Employee employee - The employee that is signed in object.
- * @prop private std::unordered_map<std::string, std::unique_ptr<Screen>> screens - The screens object.
- * @prop public employees - List of all employees being tracked by the application. 
- * @prop public int currentId - The current highest id of the employees.
- * 
- * @method public void loadScreens - This function will be used to load all the screens for the application.
- * @method public void run - This function will be used to run the application.
- * @method public void navigateToScreen - This function will be used to navigate to a specific screen.
- * @method public Employee *getLoggedInEmployee - This function will be used to get the employee object.
- * @method public void login - This function will be used to login the employee.
- * @method public Employee *findEmployeeById - This function will be used to find an employee by id.
- * @method public void removeEmployeeById - This function will be used to remove an employee by id.
- * @method public bool searchMatch - Takes in input string and query and does a case insensitive search.
- * @method public bool uniqueUsername - This function will be used to check if the username is unique. 
- * Two signatures, one with a string that will compare all users, and one that takes in an int to skip 
- * comparison of by employee id.
- * 
-*/
-class Application
+ * @function foldKey
+ *
+ * @description - Builds the key used for case insensitive comparisons: simple case folding of
+ * every code point plus composition of Latin letters with combining marks. Plain ASCII text,
+ * the common case, skips decoding entirely. Malformed UTF-8 bytes are kept as they are.
+ *
+ * @param string text - UTF-8 text to fold.
+ *
+ * @return string - The folded UTF-8 text.
+ */
+std::string foldKey(const std::string &text)
 {
-    Employee employee;
-    std::unordered_map<std::string, std::unique_ptr<Screen>> screens;
-
-    void loadScreens()
+    if (isAscii(text))
     {
-        std::unique_ptr<Screen> loginScreen = std::make_unique<LoginScreen>(this);
-        this->screens[loginScreen->name] = std::move(loginScreen);
+        std::string out = text;
+        foldAsciiInPlace(out);
+        return out;
+    }
 
-        std::unique_ptr<Screen> menuScreen = std::make_unique<MenuScreen>(this);
-        this->screens[menuScreen->name] = std::move(menuScreen);
+    std::vector<uint32_t> codePoints;
+    codePoints.reserve(text.size());
 
-        std::unique_ptr<Screen> listScreen = std::make_unique<ListScreen>(this);
-        this->screens[listScreen->name] = std::move(listScreen);
+    size_t i = 0;
+    while (i < text.size())
+    {
+        unsigned char lead = text[i];
+        size_t length = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 0;
 
-        std::unique_ptr<Screen> searchScreen = std::make_unique<SearchScreen>(this);
-        this->screens[searchScreen->name] = std::move(searchScreen);
+        bool valid = length != 0 && i + length <= text.size();
+        for (size_t k = 1; valid && k < length; ++k)
+        {
+            valid = ((unsigned char)text[i + k] >> 6) == 0x2;
+        }
 
-        std::unique_ptr<Screen> addEmployeeScreen =
-            std::make_unique<AddEmployeeScreen>(this);
-        this->screens[addEmployeeScreen->name] = std::move(addEmployeeScreen);
+        if (!valid)
+        {
+            // Keep stray bytes in a range no real code point folds to, so they round trip.
+            codePoints.push_back(0x110000 + lead);
+            i++;
+            continue;
+        }
 
-        std::unique_ptr<Screen> fileScreen = std::make_unique<FileScreen>(this);
-        this->screens[fileScreen->name] = std::move(fileScreen);
-    }
+        uint32_t cp = length == 1 ? lead : lead & (0xFF >> (length + 1));
+        for (size_t k = 1; k < length; ++k)
+        {
+            cp = (cp << 6) | ((unsigned char)text[i + k] & 0x3F);
+        }
+        i += length;
+
+        cp = foldCodePoint(cp);
+        if (!codePoints.empty())
+        {
+            uint32_t composed = composeCodePoint(codePoints.back(), cp);
+            if (composed != 0)
+            {
+                codePoints.back() = composed;
+                continue;
+            }
+        }
+        codePoints.push_back(cp);
+    }
+
+    std::string out;
+    out.reserve(text.size());
+    for (uint32_t cp : codePoints)
+    {
+        if (cp >= 0x110000)
+        {
+            out.push_back((char)(cp - 0x110000));
+        }
+        else
+        {
+            appendUtf8(out, cp);
+        }
+    }
+
+    return out;
+}
+
+/**
+ * @struct SearchKeys
+ *
+ * @description - Folded copies of the searchable fields of an employee, kept next to each
+ * record so searches compare against them directly instead of folding every row per query.
+ */
+struct SearchKeys
+{
+    std::string firstName;
+    std::string lastName;
+    std::string username;
+
+    bool contains(const std::string &foldedQuery) const
+    {
+        return this->firstName.find(foldedQuery) != std::string::npos ||
+               this->lastName.find(foldedQuery) != std::string::npos ||
+               this->username.find(foldedQuery) != std::string::npos;
+    }
+};
+
+/**
+ * @class QueryCache
+ *
+ * @description - Bounded least recently used cache of search results. Results are kept as
+ * compact lists of store rows, tagged with the store generation they were computed at. Every
+ * change to the store bumps the generation, so an entry from an older generation is treated
+ * as a miss and dropped. Safe to use from pool threads.
+ *
+ * @prop private entries - Cached rows by normalized query.
+ * @prop private order - Queries from most to least recently used.
+ * @prop private rowCount - Total rows held across all entries.
+ *
+ * @method public static normalize - Builds the cache key for a query.
+ * @method public lookup - Gets the rows for a query if cached at the given generation.
+ * @method public store - Caches the rows for a query, evicting old entries to stay in bounds.
+ *
+ */
+class QueryCache
+{
+    struct Entry
+    {
+        unsigned long generation;
+        std::vector<uint32_t> rows;
+        std::list<std::string>::iterator position;
+    };
+
+    std::mutex lock;
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> order;
+    size_t rowCount;
+
+    void erase(std::unordered_map<std::string, Entry>::iterator it)
+    {
+        this->rowCount -= it->second.rows.size();
+        this->order.erase(it->second.position);
+        this->entries.erase(it);
+    }
 
 public:
-    std::vector<Employee> employees;
-    int currentId;
+    QueryCache() : rowCount(0) {}
 
-    Application()
+    /**
+     * @function normalize - static
+     *
+     * @description - Case folds the query and trims surrounding whitespace, so "Smith" and
+     * " smith" share an entry. Searches match on the key too, so the two always find the same rows.
+     *
+     * @param string query - The raw query.
+     *
+     * @return string - The cache key.
+     */
+    static std::string normalize(std::string query)
     {
-        this->currentId = 1;
+        query = foldKey(query);
 
-        // We check if path exists and if not, we create. If we get into the if we
-        // can return becuase we know that there are no employee files.
-        if (!fs::exists(EMPLOYEE_DIR))
+        size_t first = query.find_first_not_of(" \t\r\n");
+        if (first == std::string::npos)
         {
-            fs::create_directory(EMPLOYEE_DIR);
-            /* THIS IS ONLY FOR TESTING/GRADING: Create file for inital login.
-             * - Username: testing
-             * - Password: password
-             */
-            Employee newEmployee(1, "Titus", "Moore", "testing", "password",
-                                 HR_PERMS | MANAGEMENT_PERMS | GENERAL_PERMS);
-            newEmployee.write();
+            return "";
         }
+        size_t last = query.find_last_not_of(" \t\r\n");
 
-        // Iterates through employee directory, will call Employee::from to get an
-        // instance of Employee to add to employees vector.
-        for (const auto &employeeFile : fs::directory_iterator(EMPLOYEE_DIR))
+        return query.substr(first, last - first + 1);
+    }
+
+    bool lookup(const std::string &key, unsigned long generation, std::vector<uint32_t> &rows)
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+
+        auto it = this->entries.find(key);
+        if (it == this->entries.end())
         {
-            Employee e;
-            Employee::from(employeeFile.path(), &e);
+            return false;
+        }
 
-            try
-            {
-                int id = std::stoi(employeeFile.path().stem());
+        if (it->second.generation != generation)
+        {
+            this->erase(it);
+            return false;
+        }
 
-                if (id > this->currentId)
-                {
-                    this->currentId = id;
-                }
-            }
-            catch (...)
+        this->order.splice(this->order.begin(), this->order, it->second.position);
+        rows = it->second.rows;
+        return true;
+    }
+
+    void store(const std::string &key, unsigned long generation, std::vector<uint32_t> rows)
+    {
+        // A result this big would push everything else out, it is cheaper to rescan.
+        if (rows.size() > QUERY_CACHE_ROWS / 4)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> guard(this->lock);
+
+        auto existing = this->entries.find(key);
+        if (existing != this->entries.end())
+        {
+            this->erase(existing);
+        }
+
+        while (!this->order.empty() &&
+               (this->entries.size() >= QUERY_CACHE_ENTRIES || this->rowCount + rows.size() > QUERY_CACHE_ROWS))
+        {
+            this->erase(this->entries.find(this->order.back()));
+        }
+
+        this->order.push_front(key);
+        this->rowCount += rows.size();
+
+        Entry &entry = this->entries[key];
+        entry.generation = generation;
+        entry.rows = std::move(rows);
+        entry.position = this->order.begin();
+    }
+};
+
+/**
+ * @class RowBitmap
+ *
+ * @description - One bit per store row. Used for indexes where we only need to know
+ * which rows have a property, counting them is a popcount over 64 rows at a time.
+ *
+ * @method public set - Sets or clears the bit for a row, growing as needed.
+ * @method public test - Checks the bit for a row.
+ * @method public count - Number of rows with the bit set.
+ * @method public static countUnion - Number of rows set in any of the bitmaps.
+ *
+ */
+class RowBitmap
+{
+    std::vector<uint64_t> words;
+
+    static size_t popcount(uint64_t word)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(word);
+#else
+        size_t bits = 0;
+        for (; word != 0; word &= word - 1)
+        {
+            bits++;
+        }
+        return bits;
+#endif
+    }
+
+public:
+    void set(size_t row, bool value)
+    {
+        if (row / 64 >= this->words.size())
+        {
+            if (!value)
             {
-                std::cout << "Invalid file name." << std::endl;
+                return;
             }
+            this->words.resize(row / 64 + 1, 0);
+        }
 
-            employees.push_back(e);
+        uint64_t mask = (uint64_t)1 << (row % 64);
+        if (value)
+        {
+            this->words[row / 64] |= mask;
+        }
+        else
+        {
+            this->words[row / 64] &= ~mask;
         }
+    }
 
-        loadScreens();
+    bool test(size_t row) const
+    {
+        return row / 64 < this->words.size() && (this->words[row / 64] >> (row % 64)) & 1;
     }
 
-    /**
-     * @function start
-     *
-     * @description - This function is run after everything has been setup, and
-     * handles loading the first screen.
-     *
-     * @return void
-     *
-     */
-    void start() { this->screens.at("login")->display(); }
+    void clear()
+    {
+        this->words.clear();
+    }
 
-    /**
-     * @function navigateToScreen
-     *
-     * @description - This function handles looking up a screen by key (name) and
-     * printing it.
-     *
-     * @param screeenName string - The key of the screen to display.
-     *
-     * @return void
-     *
-     */
-    void navigateToScreen(std::string screenName)
+    size_t count() const
     {
-        if (this->screens.count(screenName) != 0)
+        size_t total = 0;
+        for (uint64_t word : this->words)
         {
-            this->screens.at(screenName)->display();
+            total += popcount(word);
         }
+        return total;
     }
 
-    /**
-     * @function getLoggedInEmployee
-     * 
-     * @description - This function will return the employee object that is currently logged in.
-     * 
-     * @return Employee * - The employee object that is currently logged in.
-     * 
-    */
-    Employee *getLoggedInEmployee() { return &this->employee; }
+    static size_t countUnion(const std::vector<const RowBitmap *> &bitmaps)
+    {
+        size_t longest = 0;
+        for (const RowBitmap *b : bitmaps)
+        {
+            longest = std::max(longest, b->words.size());
+        }
 
-    /**
-     * @function login
-     *
-     * @description - This function will handle the login process for the
-     * application.
-     *
-     * @param string username - The username that the user has entered.
-     * @param string password - The password that the user has entered.
-     *
-     * @return bool - Returns true if the login was successful, false otherwise.
-     *
-     */
-    bool login(std::string username, std::string password)
+        size_t total = 0;
+        for (size_t i = 0; i < longest; ++i)
+        {
+            uint64_t word = 0;
+            for (const RowBitmap *b : bitmaps)
+            {
+                if (i < b->words.size())
+                {
+                    word |= b->words[i];
+                }
+            }
+            total += popcount(word);
+        }
+        return total;
+    }
+};
+
+/**
+ * @function soundex
+ *
+ * @description - Builds the American Soundex key of a name, a letter followed by three digits
+ * for how the rest of the name sounds. Names that sound alike share a key, "Smith" and "Smyth"
+ * are both S530, "Jon" and "John" are both J500. Characters that are not ASCII letters are skipped.
+ *
+ * @param string name - The name to encode.
+ *
+ * @return string - The four character key, or empty if the name has no letters.
+ */
+std::string soundex(const std::string &name)
+{
+    // Digit for each letter A-Z, 0 for vowels and letters that are dropped.
+    static const char codes[] = "01230120022455012623010202";
+
+    std::string key;
+    char last = 0;
+    for (unsigned char c : name)
     {
-        for (auto e : this->employees)
+        if (!std::isalpha(c) || c >= 0x80)
         {
-            if (e.isValidLogin(username, password))
+            continue;
+        }
+
+        char upper = std::toupper(c);
+        char digit = codes[upper - 'A'];
+
+        if (key.empty())
+        {
+            key.push_back(upper);
+            last = digit;
+            continue;
+        }
+
+        if (digit != '0' && digit != last)
+        {
+            key.push_back(digit);
+            if (key.length() == 4)
             {
-                this->employee = e;
-                return true;
+                break;
             }
         }
 
+        // H and W do not separate letters with the same code, vowels do.
+        if (upper != 'H' && upper != 'W')
+        {
+            last = digit;
+        }
+    }
+
+    if (!key.empty())
+    {
+        key.resize(4, '0');
+    }
+
+    return key;
+}
+
+/**
+ * @function daysFromDate
+ *
+ * @description - Converts a calendar date to the number of days since 1970-01-01.
+ *
+ * @param int year - The year.
+ * @param int month - The month, 1 to 12.
+ * @param int day - The day of the month.
+ *
+ * @return int - Days since the epoch.
+ */
+int daysFromDate(int year, int month, int day)
+{
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+
+    return era * 146097 + dayOfEra - 719468;
+}
+
+/**
+ * @function parseDate
+ *
+ * @description - Parses a YYYY-MM-DD date. The day must exist in its month, leap years
+ * included. 1970-01-01 is refused, it is day 0, which stored dates use to mean never set.
+ *
+ * @param string text - The date text.
+ * @param int days - Set to the days since 1970-01-01 when parsing succeeds.
+ *
+ * @return bool - Returns true if the text is a valid date.
+ */
+bool parseDate(const std::string &text, int &days)
+{
+    static const int monthDays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+    int year, month, day;
+    char dash1, dash2;
+    std::istringstream iss(text);
+    iss >> year >> dash1 >> month >> dash2 >> day;
+
+    if (iss.fail() || !iss.eof() || dash1 != '-' || dash2 != '-' || month < 1 || month > 12 || day < 1)
+    {
+        return false;
+    }
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    if (day > monthDays[month - 1] + (month == 2 && leap ? 1 : 0))
+    {
         return false;
     }
 
-    /**
-     * @function findEmployeeById
-     * 
-     * @description - This function will find an employee by their id.
-     * 
-     * @param int id - The id of the employee to find.
-     * 
-     * @return Employee * - The employee object that was found, or nullptr if not found.
-     * 
-    */
-    Employee *findEmployeeById(int id)
+    days = daysFromDate(year, month, day);
+    return days != 0;
+}
+
+/**
+ * @function formatDate
+ *
+ * @description - Formats days since 1970-01-01 as YYYY-MM-DD. 0 is shown as NO_DEPARTMENT
+ * since it means the date was never set.
+ *
+ * @param int days - Days since the epoch.
+ *
+ * @return string - The formatted date.
+ */
+std::string formatDate(int days)
+{
+    if (days == 0)
     {
-        for (auto &e : this->employees)
+        return NO_DEPARTMENT;
+    }
+
+    days += 719468;
+    int era = (days >= 0 ? days : days - 146096) / 146097;
+    int dayOfEra = days - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int monthIndex = (5 * dayOfYear + 2) / 153;
+    int day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    int month = monthIndex + (monthIndex < 10 ? 3 : -9);
+    int year = yearOfEra + era * 400 + (month <= 2);
+
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d", year, month, day);
+    return buffer;
+}
+
+/**
+ * @function endOfDay
+ *
+ * @description - The last second of a day in UTC, the zone formatTime and the audit log's
+ * dates use, so a change made at any time on the date counts as made by then.
+ *
+ * @param int days - Days since 1970-01-01.
+ *
+ * @return time_t - Seconds since the epoch at 23:59:59 UTC on that day.
+ */
+time_t endOfDay(int days)
+{
+    return (time_t)(days + 1) * 86400 - 1;
+}
+
+/**
+ * @function promptField
+ *
+ * @description - Asks for one field of an employee record. Record fields are separated by
+ * spaces, so a value with whitespace in it would shift every field after it; those are
+ * refused and asked for again. Reads the whole line, so nothing is left for the next prompt.
+ *
+ * @param string prompt - The prompt to print.
+ * @param bool allowEmpty - True if an empty line is a valid answer, otherwise blank lines are skipped.
+ *
+ * @return string - The value.
+ */
+std::string promptField(const std::string &prompt, bool allowEmpty)
+{
+    while (true)
+    {
+        std::cout << prompt;
+        std::string value;
+        if (allowEmpty)
+        {
+            getline(std::cin, value);
+        }
+        else
+        {
+            getline(std::cin >> std::ws, value);
+        }
+
+        if (value.find_first_of(" \t\r\n") == std::string::npos || !std::cin)
+        {
+            return value;
+        }
+
+        std::cout << std::endl
+                  << "Please input a value without spaces." << std::endl;
+    }
+}
+
+/**
+ * @function parseColumnValue
+ *
+ * @description - Parses user input for one of the numeric columns: a date for the hire date,
+ * a whole number for the salary band, and a decimal like 0.5 for FTE.
+ *
+ * @param int column - Which column the value is for.
+ * @param string text - The text to parse.
+ * @param int32_t value - Set to the stored value when parsing succeeds.
+ *
+ * @return bool - Returns true if the text is valid for the column.
+ */
+bool parseColumnValue(int column, const std::string &text, int32_t &value)
+{
+    if (column == COLUMN_HIRE_DATE)
+    {
+        int days;
+        if (!parseDate(text, days))
+        {
+            return false;
+        }
+        value = days;
+        return true;
+    }
+
+    std::istringstream iss(text);
+    if (column == COLUMN_FTE)
+    {
+        double fte;
+        iss >> fte;
+        if (iss.fail() || !iss.eof() || fte < 0)
+        {
+            return false;
+        }
+        value = (int32_t)std::lround(fte * 100);
+        return true;
+    }
+
+    iss >> value;
+    return !iss.fail() && iss.eof() && value >= 0;
+}
+
+/**
+ * @struct RangePredicate
+ *
+ * @description - An inclusive range on one numeric column, from a query like "salary:3..5".
+ */
+struct RangePredicate
+{
+    int column;
+    int32_t low;
+    int32_t high;
+};
+
+/**
+ * @function parseRangeQuery
+ *
+ * @description - Parses a query made of comma separated column ranges, for example
+ * "hired:2020-01-01..2020-12-31,fte:..0.5". Columns are hired, salary, and fte, and either end
+ * of a range can be left off.
+ *
+ * @param string query - The query text.
+ * @param vector<RangePredicate> predicates - Filled with the parsed ranges.
+ *
+ * @return bool - Returns true if the whole query is a valid range query.
+ */
+bool parseRangeQuery(const std::string &query, std::vector<RangePredicate> &predicates)
+{
+    static const char *names[NUMERIC_COLUMNS] = {"hired", "salary", "fte"};
+
+    predicates.clear();
+    std::istringstream parts(query);
+    std::string part;
+    while (getline(parts, part, ','))
+    {
+        size_t colon = part.find(':');
+        size_t dots = part.find("..");
+        if (colon == std::string::npos || dots == std::string::npos || dots < colon)
+        {
+            return false;
+        }
+
+        RangePredicate predicate;
+        predicate.column = -1;
+        for (int column = 0; column < NUMERIC_COLUMNS; ++column)
+        {
+            if (part.compare(0, colon, names[column]) == 0 && colon == std::strlen(names[column]))
+            {
+                predicate.column = column;
+            }
+        }
+
+        std::string low = part.substr(colon + 1, dots - colon - 1);
+        std::string high = part.substr(dots + 2);
+        // Unset values are left out by maskRange, so an open low end reaches hire dates before 1970.
+        predicate.low = INT32_MIN;
+        predicate.high = INT32_MAX;
+
+        if (predicate.column < 0 ||
+            (!low.empty() && !parseColumnValue(predicate.column, low, predicate.low)) ||
+            (!high.empty() && !parseColumnValue(predicate.column, high, predicate.high)))
+        {
+            return false;
+        }
+
+        predicates.push_back(predicate);
+    }
+
+    return !predicates.empty();
+}
+
+/**
+ * @struct ColumnSummary
+ *
+ * @description - Aggregates of one numeric column over a set of rows. Rows where the column
+ * was never set are not counted.
+ */
+struct ColumnSummary
+{
+    size_t count = 0;
+    int64_t sum = 0;
+    int32_t min = INT32_MAX;
+    int32_t max = INT32_MIN;
+
+    double average() const
+    {
+        return this->count == 0 ? 0 : (double)this->sum / this->count;
+    }
+
+    void merge(const ColumnSummary &other)
+    {
+        this->count += other.count;
+        this->sum += other.sum;
+        this->min = std::min(this->min, other.min);
+        this->max = std::max(this->max, other.max);
+    }
+};
+
+/**
+ * @function maskRange
+ *
+ * @description - Clears selected[i] for every value outside [low, high], and for every unset
+ * value, 0, like summarizeColumn skips them. Branch free so the compiler runs it as SIMD
+ * compares over the column.
+ *
+ * @param int32_t *values - The column values.
+ * @param uint8_t *selected - The row mask to narrow.
+ * @param size_t count - Number of rows.
+ * @param int32_t low - Smallest value kept.
+ * @param int32_t high - Largest value kept.
+ *
+ * @return void
+ */
+void maskRange(const int32_t *__restrict values, uint8_t *__restrict selected, size_t count, int32_t low, int32_t high)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        selected[i] &= (uint8_t)((values[i] >= low) & (values[i] <= high) & (values[i] != 0));
+    }
+}
+
+/**
+ * @function summarizeColumn
+ *
+ * @description - Sum, min, max, and count of values[i] for every i where selected[i] is 1 and the
+ * value is set. There are no branches in the loop body, every row does the same masked work,
+ * so the compiler turns it into SIMD compares and blends.
+ *
+ * @param int32_t *values - The column values.
+ * @param uint8_t *selected - 1 for rows in the filtered set, 0 otherwise.
+ * @param size_t count - Number of rows.
+ *
+ * @return ColumnSummary - The aggregates.
+ */
+ColumnSummary summarizeColumn(const int32_t *values, const uint8_t *selected, size_t count)
+{
+    int64_t sum = 0;
+    int64_t taken = 0;
+    int32_t low = INT32_MAX;
+    int32_t high = INT32_MIN;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        int32_t value = values[i];
+        int32_t keep = -(int32_t)(selected[i] & (value != 0));
+
+        sum += value & keep;
+        taken += keep & 1;
+        low = std::min(low, (value & keep) | (INT32_MAX & ~keep));
+        high = std::max(high, (value & keep) | (INT32_MIN & ~keep));
+    }
+
+    ColumnSummary summary;
+    summary.count = taken;
+    summary.sum = sum;
+    summary.min = low;
+    summary.max = high;
+    return summary;
+}
+
+class Application;
+
+/**
+ * @function syncFile
+ *
+ * @description - Flushes a file and waits for it to reach the disk.
+ *
+ * @param FILE *file - An open file.
+ *
+ * @return bool - Returns true if everything written is on disk.
+ */
+bool syncFile(FILE *file)
+{
+    if (fflush(file) != 0)
+    {
+        return false;
+    }
+
+#if defined _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+/**
+ * @function syncDirectory
+ *
+ * @description - Waits for the entries of a directory to reach the disk, so files renamed into
+ * it stay renamed after a power loss. Windows commits renames with the file, so there it does
+ * nothing.
+ *
+ * @param fs::path directory - The directory.
+ *
+ * @return bool - Returns true if the directory is on disk.
+ */
+bool syncDirectory(const fs::path &directory)
+{
+#if defined _WIN32
+    return true;
+#else
+    int fd = open(directory.string().c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+    bool synced = fsync(fd) == 0;
+    close(fd);
+    return synced;
+#endif
+}
+
+#if !defined _WIN32
+// Descriptors of the lock files this process holds, by path. The flock lives as long as the descriptor.
+std::mutex heldLocksLock;
+std::unordered_map<std::string, int> heldLocks;
+#endif
+
+/**
+ * @function appendPrivate
+ *
+ * @description - Opens a file for appending, creating it readable and writable only by its
+ * owner. A file made before that is tightened to the same.
+ *
+ * @param fs::path path - The file.
+ *
+ * @return FILE * - The open file, nullptr if it couldn't be opened.
+ */
+FILE *appendPrivate(const fs::path &path)
+{
+#if defined _WIN32
+    return fopen(path.string().c_str(), "ab");
+#else
+    int fd = open(path.string().c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+    fchmod(fd, 0600);
+    FILE *file = fdopen(fd, "ab");
+    if (file == nullptr)
+    {
+        close(fd);
+    }
+    return file;
+#endif
+}
+
+/**
+ * @function writePrivate
+ *
+ * @description - Opens a file for writing from the start, like appendPrivate, creating it
+ * readable and writable only by its owner and emptying what was there.
+ *
+ * @param fs::path path - The file.
+ *
+ * @return FILE * - The open file, nullptr if it couldn't be opened.
+ */
+FILE *writePrivate(const fs::path &path)
+{
+#if defined _WIN32
+    return fopen(path.string().c_str(), "wb");
+#else
+    int fd = open(path.string().c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+    fchmod(fd, 0600);
+    FILE *file = fdopen(fd, "wb");
+    if (file == nullptr)
+    {
+        close(fd);
+    }
+    return file;
+#endif
+}
+
+/**
+ * @function lockFile
+ *
+ * @description - Takes a lock shared with other sessions and threads, waiting up to
+ * RECORD_LOCK_WAIT_MS. On POSIX it is an flock on the lock file, which the OS drops when the
+ * holder exits, so a crash never leaves a lock behind and a slow holder is never robbed. The
+ * holder removes the file before letting go, so a waiter that locked the removed file sees it
+ * is no longer the one at the path and tries again. Elsewhere the lock is creating the lock
+ * file, which only one session can do, and lock files older than RECORD_LOCK_STALE_SECONDS
+ * are taken to be left by a crash.
+ *
+ * @param fs::path lock - The lock file.
+ *
+ * @return bool - Returns true if the lock is held.
+ */
+bool lockFile(const fs::path &lock)
+{
+    auto giveUp = std::chrono::steady_clock::now() + std::chrono::milliseconds(RECORD_LOCK_WAIT_MS);
+
+#if !defined _WIN32
+    std::string path = lock.string();
+    while (true)
+    {
+        int fd = open(path.c_str(), O_CREAT | O_RDWR | O_CLOEXEC, 0600);
+        if (fd >= 0 && flock(fd, LOCK_EX | LOCK_NB) == 0)
+        {
+            struct stat held, current;
+            if (fstat(fd, &held) == 0 && stat(path.c_str(), &current) == 0 &&
+                held.st_dev == current.st_dev && held.st_ino == current.st_ino)
+            {
+                std::lock_guard<std::mutex> guard(heldLocksLock);
+                heldLocks[path] = fd;
+                return true;
+            }
+        }
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+
+        if (std::chrono::steady_clock::now() > giveUp)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+#else
+    while (true)
+    {
+        FILE *file = fopen(lock.string().c_str(), "wx");
+        if (file != nullptr)
+        {
+            fclose(file);
+            return true;
+        }
+
+        std::error_code ec;
+        auto written = fs::last_write_time(lock, ec);
+        if (!ec && fs::file_time_type::clock::now() - written > std::chrono::seconds(RECORD_LOCK_STALE_SECONDS))
+        {
+            fs::remove(lock, ec);
+            continue;
+        }
+
+        if (std::chrono::steady_clock::now() > giveUp)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+#endif
+}
+
+void unlockFile(const fs::path &lock)
+{
+    std::error_code ec;
+#if !defined _WIN32
+    int fd = -1;
+    {
+        std::lock_guard<std::mutex> guard(heldLocksLock);
+        auto held = heldLocks.find(lock.string());
+        if (held == heldLocks.end())
+        {
+            return;
+        }
+        fd = held->second;
+        heldLocks.erase(held);
+    }
+    // Removed while still locked, so no one can lock this file and think it is the current one.
+    fs::remove(lock, ec);
+    close(fd);
+#else
+    fs::remove(lock, ec);
+#endif
+}
+
+/**
+ * @function lzCompress
+ *
+ * @description - Compresses bytes with a small LZ77 coder in the LZ4 block layout: each sequence
+ * is a token byte (literal count high nibble, match length minus 4 low nibble, 15 meaning more
+ * length bytes follow), the literals, then a two byte match offset. The last sequence has only
+ * literals. Matches are found through a hash of the next four bytes, within 64 KiB.
+ *
+ * A dictionary is treated as if it came right before the input, so matches can point into it.
+ * The same dictionary must be given to lzDecompress.
+ *
+ * @param string input - The bytes to compress.
+ * @param string dictionary - Bytes like the input, shared by every block, at most 64 KiB.
+ *
+ * @return string - The compressed bytes.
+ */
+std::string lzCompress(const std::string &input, const std::string &dictionary = std::string())
+{
+    const size_t minMatch = 4;
+    const size_t hashBits = dictionary.empty() ? 12 : 14;
+    std::vector<uint32_t> table(1 << hashBits, UINT32_MAX);
+    std::string out;
+
+    auto writeLength = [&out](size_t length)
+    {
+        while (length >= 255)
+        {
+            out.push_back((char)255);
+            length -= 255;
+        }
+        out.push_back((char)length);
+    };
+
+    std::string window;
+    const std::string *source = &input;
+    if (!dictionary.empty())
+    {
+        window = dictionary + input;
+        source = &window;
+    }
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(source->data());
+    size_t size = source->size();
+    size_t anchor = dictionary.size();
+    size_t position = 0;
+
+    // The dictionary is only hashed, compressing starts after it.
+    for (; position + minMatch <= anchor; ++position)
+    {
+        uint32_t word;
+        std::memcpy(&word, data + position, sizeof(word));
+        table[(word * 2654435761u) >> (32 - hashBits)] = (uint32_t)position;
+    }
+    position = anchor;
+
+    while (position + minMatch <= size)
+    {
+        uint32_t word;
+        std::memcpy(&word, data + position, sizeof(word));
+        uint32_t hash = (word * 2654435761u) >> (32 - hashBits);
+        uint32_t candidate = table[hash];
+        table[hash] = (uint32_t)position;
+
+        if (candidate == UINT32_MAX || position - candidate > 0xFFFF ||
+            std::memcmp(data + candidate, data + position, minMatch) != 0)
+        {
+            position++;
+            continue;
+        }
+
+        size_t matchLength = minMatch;
+        while (position + matchLength < size && data[candidate + matchLength] == data[position + matchLength])
+        {
+            matchLength++;
+        }
+
+        size_t literals = position - anchor;
+        size_t extra = matchLength - minMatch;
+        out.push_back((char)((std::min<size_t>(literals, 15) << 4) | std::min<size_t>(extra, 15)));
+        if (literals >= 15)
+        {
+            writeLength(literals - 15);
+        }
+        out.append(*source, anchor, literals);
+
+        size_t offset = position - candidate;
+        out.push_back((char)(offset & 0xFF));
+        out.push_back((char)(offset >> 8));
+        if (extra >= 15)
+        {
+            writeLength(extra - 15);
+        }
+
+        position += matchLength;
+        anchor = position;
+    }
+
+    size_t literals = size - anchor;
+    out.push_back((char)(std::min<size_t>(literals, 15) << 4));
+    if (literals >= 15)
+    {
+        writeLength(literals - 15);
+    }
+    out.append(*source, anchor, literals);
+
+    return out;
+}
+
+/**
+ * @function lzDecompress
+ *
+ * @description - Reverses lzCompress. Checks every length and offset against the buffers, so a
+ * damaged block fails instead of reading or writing out of bounds.
+ *
+ * @param string input - The compressed bytes.
+ * @param size_t rawSize - The size of the original bytes.
+ * @param string &output - Set to the original bytes.
+ * @param string dictionary - The dictionary the input was compressed with, if any.
+ *
+ * @return bool - Returns false if the input is damaged.
+ */
+bool lzDecompress(const std::string &input, size_t rawSize, std::string &output,
+                  const std::string &dictionary = std::string())
+{
+    // Decoded after the dictionary so matches can reach into it, which is cut off at the end. A
+    // byte of input decodes to at most 255 of output, so a damaged size can't reserve past that.
+    output.reserve(dictionary.size() + std::min<size_t>(rawSize, input.size() * 255 + 16));
+    output.assign(dictionary);
+    rawSize += dictionary.size();
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(input.data());
+    size_t size = input.size();
+    size_t position = 0;
+
+    auto readLength = [&](size_t length, bool &ok)
+    {
+        if (length != 15)
+        {
+            return length;
+        }
+        while (position < size)
+        {
+            unsigned char more = data[position++];
+            length += more;
+            if (more != 255)
+            {
+                return length;
+            }
+        }
+        ok = false;
+        return length;
+    };
+
+    while (position < size)
+    {
+        bool ok = true;
+        unsigned char token = data[position++];
+        size_t literals = readLength(token >> 4, ok);
+        if (!ok || literals > size - position || output.size() + literals > rawSize)
+        {
+            return false;
+        }
+        output.append(input, position, literals);
+        position += literals;
+
+        // The last sequence ends after its literals.
+        if (position == size)
+        {
+            break;
+        }
+
+        if (position + 2 > size)
+        {
+            return false;
+        }
+        size_t offset = data[position] | (data[position + 1] << 8);
+        position += 2;
+        size_t matchLength = readLength(token & 0x0F, ok) + 4;
+        if (!ok || offset == 0 || offset > output.size() || output.size() + matchLength > rawSize)
+        {
+            return false;
+        }
+
+        // Byte by byte when the match overlaps the bytes it is copying. Otherwise in one copy,
+        // which never reallocates since the whole output was reserved.
+        size_t from = output.size() - offset;
+        if (offset >= matchLength)
+        {
+            output.append(output.data() + from, matchLength);
+            continue;
+        }
+        for (size_t i = 0; i < matchLength; ++i)
+        {
+            output.push_back(output[from + i]);
+        }
+    }
+
+    if (output.size() != rawSize)
+    {
+        return false;
+    }
+    output.erase(0, dictionary.size());
+    return true;
+}
+
+/**
+ * @function crc32cSoftware
+ *
+ * @description - CRC32C using slicing-by-8, eight bytes per step through eight lookup tables.
+ *
+ * @param uint32_t crc - The running checksum, inverted.
+ * @param const unsigned char *data - The bytes.
+ * @param size_t size - How many bytes.
+ *
+ * @return uint32_t - The running checksum, inverted.
+ */
+uint32_t crc32cSoftware(uint32_t crc, const unsigned char *data, size_t size)
+{
+    static const auto tables = []
+    {
+        std::vector<std::array<uint32_t, 256>> t(8);
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                value = (value >> 1) ^ (value & 1 ? CRC32C_POLYNOMIAL : 0);
+            }
+            t[0][i] = value;
+        }
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            for (int slice = 1; slice < 8; ++slice)
+            {
+                t[slice][i] = (t[slice - 1][i] >> 8) ^ t[0][t[slice - 1][i] & 0xFF];
+            }
+        }
+        return t;
+    }();
+
+    for (; size >= 8; data += 8, size -= 8)
+    {
+        uint32_t low = crc ^ (data[0] | (uint32_t)data[1] << 8 | (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24);
+        uint32_t high = data[4] | (uint32_t)data[5] << 8 | (uint32_t)data[6] << 16 | (uint32_t)data[7] << 24;
+        crc = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF] ^ tables[5][(low >> 16) & 0xFF] ^
+              tables[4][low >> 24] ^ tables[3][high & 0xFF] ^ tables[2][(high >> 8) & 0xFF] ^
+              tables[1][(high >> 16) & 0xFF] ^ tables[0][high >> 24];
+    }
+    for (; size > 0; ++data, --size)
+    {
+        crc = (crc >> 8) ^ tables[0][(crc ^ *data) & 0xFF];
+    }
+    return crc;
+}
+
+#if defined CRC32C_HARDWARE
+__attribute__((target("sse4.2"))) uint32_t crc32cHardware(uint32_t crc, const unsigned char *data, size_t size)
+{
+    uint64_t wide = crc;
+    for (; size >= 8; data += 8, size -= 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        wide = _mm_crc32_u64(wide, word);
+    }
+    crc = (uint32_t)wide;
+    for (; size > 0; ++data, --size)
+    {
+        crc = _mm_crc32_u8(crc, *data);
+    }
+    return crc;
+}
+#endif
+
+/**
+ * @function crc32c
+ *
+ * @description - CRC32C of a run of bytes, with the SSE4.2 instruction when the processor has
+ * it, checked once, and slicing-by-8 otherwise. Both give the same checksum.
+ *
+ * @param const char *data - The bytes.
+ * @param size_t size - How many bytes.
+ * @param uint32_t previous - Checksum of the bytes before these, to checksum a run in pieces.
+ *
+ * @return uint32_t - The checksum.
+ */
+uint32_t crc32c(const char *data, size_t size, uint32_t previous = 0)
+{
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+#if defined CRC32C_HARDWARE
+    static const bool hardware = __builtin_cpu_supports("sse4.2");
+    if (hardware)
+    {
+        return ~crc32cHardware(~previous, bytes, size);
+    }
+#endif
+    return ~crc32cSoftware(~previous, bytes, size);
+}
+
+uint32_t crc32c(const std::string &data)
+{
+    return crc32c(data.data(), data.size());
+}
+
+/**
+ * @function blockChecksum
+ *
+ * @description - Checksum of a compressed block in the archive or a backup, covering the
+ * record count and sizes in front of it as well as the compressed bytes.
+ *
+ * @param const uint32_t *header - Record count, raw size, and compressed size.
+ * @param string compressed - The compressed bytes.
+ *
+ * @return uint32_t - The checksum.
+ */
+uint32_t blockChecksum(const uint32_t *header, const std::string &compressed)
+{
+    uint32_t crc = crc32c(reinterpret_cast<const char *>(header), 3 * sizeof(uint32_t));
+    return crc32c(compressed.data(), compressed.size(), crc);
+}
+
+/**
+ * @class Employee
+ *
+ * @description - This class is what handles all of the logic and data storage
+ * for employees
+ *
+ * @prop private permissions short - permissions of employee
+ * @prop private password string - password of employee
+ * @prop public id int - id of employee
+ * @prop public firstName string - first name of employee
+ * @prop public lastName string - last name of employee
+ * @prop public username string - username of employee
+ * @prop public managerId int - id of the employee this one reports to, 0 for none
+ * @prop public department string - department of employee, empty for none
+ * @prop public hireDate int - day the employee was hired as days since 1970-01-01, 0 if unknown
+ * @prop public salaryBand int - salary band of employee, 0 if unknown
+ * @prop public ftePercent int - percent of full time the employee works, 0 if unknown
+ * @prop public revision int - number of times the record has been saved, used to catch edits that crossed
+ * @prop public file fs::path - file path of employee
+ *
+ * @method public write - Writes the current state of Employee to associated
+ * file. Will create file if not exists.
+ * @method public serialize - The contents of the employee's file.
+ * @method public static parseRecord - Reads the fields of one record line.
+ * @method public isValidLogin - This function will check if the username and
+ * password provided are valid for the employee.
+ * @method public static from - This function will read the contents of the file
+ * provided and create an instance of Employee from it.
+ * @method public hasPermission - This function will check if the employee has
+ * the permission provided.
+ * @method public updatePassword - This function will update the password of the
+ * employee.
+ * @method public updatePermissions - This function will update the permissions
+ * of the employee.
+ * @method public getPermissions - Returns the raw permission bits of the employee.
+ *
+ */
+class Employee
+{
+    short permissions;
+    std::string password;
+
+public:
+    int id;
+    std::string firstName;
+    std::string lastName;
+    std::string username;
+    int managerId;
+    std::string department;
+    int32_t hireDate;
+    int32_t salaryBand;
+    int32_t ftePercent;
+    int revision;
+    fs::path file;
+
+    Employee() : managerId(0), hireDate(0), salaryBand(0), ftePercent(0), revision(0) {}
+    Employee(int id, std::string firstName, std::string lastName, std::string username,
+             std::string password, short permissions, int managerId = 0)
+    {
+        this->id = id;
+        this->firstName = firstName;
+        this->lastName = lastName;
+        this->username = username;
+        this->password = password;
+        this->permissions = permissions;
+        this->managerId = managerId;
+        this->hireDate = 0;
+        this->salaryBand = 0;
+        this->ftePercent = 0;
+        this->revision = 0;
+    }
+
+    /**
+     * @function getColumn
+     *
+     * @description - Reads one of the numeric columns by its COLUMN_ constant.
+     *
+     * @param int column - The column to read.
+     *
+     * @return int32_t - The stored value, 0 if unset.
+     */
+    int32_t getColumn(int column) const
+    {
+        switch (column)
+        {
+        case COLUMN_HIRE_DATE:
+            return this->hireDate;
+        case COLUMN_SALARY_BAND:
+            return this->salaryBand;
+        default:
+            return this->ftePercent;
+        }
+    }
+
+    /**
+     * @function write
+     *
+     * @description - writes the current state of Employee to associated file.
+     * Will create file if not exists.
+     *  - Employee file will be named after the employee's id.
+     *  - File contents will be in the format of:
+     *  - #v<RECORD_FORMAT_VERSION> <CRC32C of the record line>
+     *  - id username firstName lastName password permissions managerId department hireDate salaryBand ftePercent revision
+     *  - The file is written beside the old one, synced, and only then renamed over it, so a
+     *    reader never sees half a record and a failed write leaves the old record in place.
+     *
+     * @return bool - indicates the success or failure of writing to employeeFile
+     *
+     */
+    bool write()
+    {
+        std::ostringstream oss;
+        oss << this->id << ".txt";
+
+        this->file = EMPLOYEE_DIR / oss.str();
+        fs::path pending = this->file;
+        pending += ".tmp";
+
+        FILE *employeeFile = fopen(pending.string().c_str(), "wb");
+
+        // Something went wrong while creating or opening the file, we need to
+        // return false;
+        if (employeeFile == nullptr)
+        {
+            return false;
+        }
+
+        std::string contents = this->serialize();
+        bool written = fwrite(contents.data(), 1, contents.size(), employeeFile) == contents.size() &&
+                       syncFile(employeeFile);
+        written = fclose(employeeFile) == 0 && written;
+
+        std::error_code ec;
+        if (written)
+        {
+            fs::rename(pending, this->file, ec);
+        }
+        if (!written || ec)
+        {
+            fs::remove(pending, ec);
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * @function serialize
+     *
+     * @description - Builds the contents of the employee's file, the version line with the
+     * checksum of the record, followed by the record line. Also used for the records in the
+     * transaction journal.
+     *
+     * @return string - The file contents, ending in a new line.
+     */
+    std::string serialize() const
+    {
+        std::ostringstream oss;
+        oss << this->id << " " << this->username << " " << this->firstName << " "
+            << this->lastName << " " << this->password << " " << this->permissions << " "
+            << this->managerId << " " << (this->department.empty() ? NO_DEPARTMENT : this->department) << " "
+            << formatDate(this->hireDate) << " " << this->salaryBand << " " << this->ftePercent << " "
+            << this->revision;
+        std::string record = oss.str();
+
+        char version[32];
+        std::snprintf(version, sizeof(version), "#v%d %08x\n", RECORD_FORMAT_VERSION, crc32c(record));
+        return version + record + "\n";
+    }
+
+    /**
+     * @function parseRecord - static
+     *
+     * @description - Reads the fields of one record line into an employee.
+     *
+     * @param string line - The record line.
+     * @param int version - The record format version the line was written in.
+     * @param Employee *employee - The employee to fill in.
+     *
+     * @return bool - Returns true if the line had at least the version 1 fields.
+     */
+    static bool parseRecord(const std::string &line, int version, Employee *employee)
+    {
+        std::istringstream iss(line);
+
+        iss >> employee->id >> employee->username >> employee->firstName >>
+            employee->lastName >> employee->password >> employee->permissions;
+        if (iss.fail())
+        {
+            return false;
+        }
+
+        // Files written before managers and departments existed stop early.
+        employee->managerId = 0;
+        employee->department.clear();
+        iss >> employee->managerId >> employee->department;
+        if (employee->department == NO_DEPARTMENT)
+        {
+            employee->department.clear();
+        }
+
+        employee->hireDate = 0;
+        employee->salaryBand = 0;
+        employee->ftePercent = 0;
+        if (version >= 2)
+        {
+            std::string hired;
+            iss >> hired >> employee->salaryBand >> employee->ftePercent;
+
+            int days;
+            if (parseDate(hired, days))
+            {
+                employee->hireDate = days;
+            }
+        }
+
+        employee->revision = 0;
+        if (version >= 3)
+        {
+            iss >> employee->revision;
+        }
+
+        return true;
+    }
+
+    /**
+     * @function checksumMatches - static
+     *
+     * @description - Checks a record line against the checksum on the version line before it.
+     * Versions before 4 have no checksum and always match.
+     *
+     * @param string versionLine - The "#v" line.
+     * @param string record - The record line.
+     *
+     * @return bool - Returns false if the record isn't what was written.
+     */
+    static bool checksumMatches(const std::string &versionLine, const std::string &record)
+    {
+        if (versionLine.compare(0, 2, "#v") != 0 || std::atoi(versionLine.c_str() + 2) < 4)
+        {
+            return true;
+        }
+
+        size_t space = versionLine.find(' ');
+        return space != std::string::npos &&
+               std::strtoul(versionLine.c_str() + space + 1, nullptr, 16) == crc32c(record);
+    }
+
+    /**
+     * @function isValidLogin
+     *
+     * @description - This function will check if the username and password
+     * provided are valid for the employee. Usernames are compared case folded.
+     *
+     * @param string username - The username that the user has entered.
+     * @param string password - The password that the user has entered.
+     *
+     * @return bool - Returns true if the login is valid, false otherwise.
+     *
+     */
+    bool isValidLogin(std::string username, std::string password)
+    {
+        return foldKey(this->username) == foldKey(username) && this->password == password;
+    }
+
+    /**
+     * @function from - static
+     *
+     * @description - This function will read the contents of the file provided
+     * and create an instance of Employee from it.
+     *
+     * @param file - file address of file that the employee will be built from.
+     * @param employee - Pointer to the instance of employee that will be written
+     * to if file reading succeeds
+     * @param error - Set to why the file was refused, if given.
+     *
+     * @return bool - returns true if file reading and employee creation was
+     * successful, false if the file couldn't be read, holds no record, or fails its checksum.
+     *
+     */
+    static bool from(fs::path employeeFile, Employee *employee, std::string *error = nullptr)
+    {
+        std::ifstream file;
+        file.open(employeeFile);
+
+        // Something has gone wrong with getting the file, so we return false
+        if (!file)
+        {
+            if (error != nullptr)
+            {
+                *error = "can't be read";
+            }
+            return false;
+        }
+
+        std::string contents, versionLine;
+        int version = 1;
+        bool parsed = false;
+        while (getline(file, contents))
+        {
+            if (contents.compare(0, 2, "#v") == 0)
+            {
+                versionLine = contents;
+                version = std::atoi(contents.c_str() + 2);
+                continue;
+            }
+
+            // A torn or rotted record fails here, before any of it is used.
+            if (!versionLine.empty() && !checksumMatches(versionLine, contents))
+            {
+                if (error != nullptr)
+                {
+                    *error = "fails its checksum";
+                }
+                return false;
+            }
+            parsed = parseRecord(contents, version, employee);
+        }
+
+        employee->file = employeeFile;
+
+        file.close();
+
+        if (!parsed && error != nullptr)
+        {
+            *error = "holds no record";
+        }
+        return parsed;
+    }
+
+    /**
+     * @function hasPermission
+     *
+     * @description - This function will check if the employee has the permission
+     * provided.
+     *
+     * @param short permission - The permission that we are checking if the
+     * employee has.
+     *
+     * @return bool - Returns true if the employee has the permission, false
+     * otherwise.
+     *
+     */
+    bool hasPermission(short permission) const
+    {
+        return (this->permissions & permission) != 0;
+    }
+
+    /**
+     * @function getPermissions
+     *
+     * @description - Returns the raw permission bits of the employee.
+     *
+     * @return short - The permissions of the employee.
+     */
+    short getPermissions() const
+    {
+        return this->permissions;
+    }
+
+    /**
+     * @function toString
+     *
+     * @description - Takes a strategy parameter and returns a string with the
+     * employee information.
+     *
+     * @param short mode - number value of what type of display
+     *  - 0 - Default, short list based display "id: First Last, Username"
+     *  - 1 - Page version of the display, that contains all the public
+     * information for a employee
+     *
+     *  @returns string - built string of display for the employee
+     */
+    std::string toString(short mode) const
+    {
+        std::ostringstream oss;
+
+        switch (mode)
+        {
+        case 1:
+            oss << "ID: " << this->id << std::endl
+                << "Name: " << this->firstName << " " << this->lastName << std::endl
+                << "Username: " << this->username << std::endl;
+            if (!this->department.empty())
+            {
+                oss << "Department: " << this->department << std::endl;
+            }
+            if (this->hireDate != 0)
+            {
+                oss << "Hired: " << formatDate(this->hireDate) << std::endl;
+            }
+            if (this->salaryBand != 0)
+            {
+                oss << "Salary Band: " << this->salaryBand << std::endl;
+            }
+            if (this->ftePercent != 0)
+            {
+                oss << "FTE: " << this->ftePercent / 100.0 << std::endl;
+            }
+            break;
+        default:
+            oss << this->id << ": " << this->firstName << " " << this->lastName
+                << ", " << this->username << std::endl;
+            break;
+        }
+
+        return oss.str();
+    }
+
+    /**
+    * @function updatePassword
+    *
+    * @description - This function will update the password of the employee.
+    * 
+    * @param string password - The new password that the employee will have.
+    * 
+    * @return void
+    * 
+    */
+    void updatePassword(std::string password)
+    {
+        this->password = password;
+    }
+
+    /**
+    * @function updatePermissions
+    *
+    * @description - This function will update the permissions of the employee.
+    * 
+    * @param int permissions - The new permissions that the employee will have.
+    * 
+    * @return void   
+    */
+    void updatePermissions(int permissions)
+    {
+        this->permissions = permissions;
+    }
+};
+
+/**
+ * @struct RecordCheck
+ *
+ * @description - What the integrity check found in one employee file.
+ *
+ * @prop file path - The file checked.
+ * @prop employee Employee - The record, when it could be read.
+ * @prop readable bool - True if the record parsed cleanly, so it can be rewritten.
+ * @prop damaged bool - True if the contents can't be trusted and must not be loaded.
+ * @prop problems vector<string> - Each problem found, empty for a healthy record.
+ * @prop notices vector<string> - Things worth knowing that aren't wrong, like an older format.
+ */
+struct RecordCheck
+{
+    fs::path file;
+    Employee employee;
+    bool readable = false;
+    bool damaged = false;
+    std::vector<std::string> problems;
+    std::vector<std::string> notices;
+};
+
+/**
+ * @function checkRecordFile
+ *
+ * @description - Checks one employee file: the version line and checksum, that the record has
+ * exactly the fields its version has and each one reads back as written, and that the file is
+ * named after the id it holds.
+ *
+ * @param path file - The employee file.
+ *
+ * @return RecordCheck - What was found.
+ */
+RecordCheck checkRecordFile(const fs::path &file)
+{
+    static const char *FIELDS[] = {"id", "username", "firstName", "lastName", "password", "permissions",
+                                   "managerId", "department", "hireDate", "salaryBand", "ftePercent", "revision"};
+
+    RecordCheck check;
+    check.file = file;
+
+    std::ifstream in(file, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (!in.good() && !in.eof())
+    {
+        check.damaged = true;
+        check.problems.push_back("can't be read");
+        return check;
+    }
+
+    std::vector<std::string> lines;
+    std::istringstream stream(contents);
+    for (std::string line; getline(stream, line);)
+    {
+        lines.push_back(line);
+    }
+
+    int version = 1;
+    std::string checksum;
+    size_t recordLine = 0;
+    if (!lines.empty() && lines[0].compare(0, 2, "#v") == 0)
+    {
+        std::istringstream header(lines[0].substr(2));
+        header >> version >> checksum;
+        recordLine = 1;
+    }
+    if (lines.size() != recordLine + 1 || contents.back() != '\n')
+    {
+        check.damaged = true;
+        check.problems.push_back(lines.size() <= recordLine ? "holds no record" : "is truncated or has extra lines");
+        return check;
+    }
+    if (version < 1 || version > RECORD_FORMAT_VERSION)
+    {
+        check.damaged = true;
+        check.problems.push_back("has unknown format version " + std::to_string(version));
+        return check;
+    }
+
+    const std::string &record = lines[recordLine];
+    std::vector<std::string> tokens, parsed;
+    std::istringstream fields(record);
+    for (std::string token; fields >> token;)
+    {
+        tokens.push_back(token);
+    }
+    // Version 1 records may stop before the manager or the department.
+    size_t expected = version == 1 ? std::min<size_t>(std::max<size_t>(tokens.size(), 6), 8) : version == 2 ? 11 : 12;
+    if (tokens.size() != expected)
+    {
+        check.damaged = true;
+        check.problems.push_back("has " + std::to_string(tokens.size()) + " fields, expected " + std::to_string(expected));
+        return check;
+    }
+    if (!Employee::parseRecord(record, version, &check.employee))
+    {
+        check.damaged = true;
+        check.problems.push_back("can't be parsed");
+        return check;
+    }
+
+    // Every field must read back exactly as written, which catches numbers that didn't parse.
+    std::string rewritten = check.employee.serialize();
+    std::istringstream written(rewritten.substr(rewritten.find('\n') + 1));
+    for (std::string token; written >> token;)
+    {
+        parsed.push_back(token);
+    }
+    for (size_t i = 0; i < expected; ++i)
+    {
+        if (tokens[i] != parsed[i])
+        {
+            check.damaged = true;
+            check.problems.push_back(std::string("has a malformed ") + FIELDS[i]);
+            return check;
+        }
+    }
+    if (check.employee.id <= 0 || (check.employee.getPermissions() & ~(HR_PERMS | MANAGEMENT_PERMS | GENERAL_PERMS)) != 0)
+    {
+        check.damaged = true;
+        check.problems.push_back(check.employee.id <= 0 ? "has an invalid id" : "has unknown permission bits");
+        return check;
+    }
+
+    if (version >= 4)
+    {
+        if (checksum.size() != 8 || !Employee::checksumMatches(lines[0], record))
+        {
+            check.damaged = true;
+            check.problems.push_back("fails its checksum");
+            return check;
+        }
+    }
+    else
+    {
+        // Files from before checksums are still valid, only not checked.
+        check.notices.push_back("has no checksum (format v" + std::to_string(version) + ")");
+    }
+
+    check.readable = true;
+    if (file.stem() != std::to_string(check.employee.id))
+    {
+        check.problems.push_back("holds employee " + std::to_string(check.employee.id));
+    }
+    return check;
+}
+
+/**
+ * @struct FsckReport
+ *
+ * @description - Totals from an integrity check of the store.
+ */
+struct FsckReport
+{
+    // Files checked, and how many of those or leftover partial writes had a problem.
+    size_t checked = 0;
+    size_t problems = 0;
+    size_t repaired = 0;
+    size_t quarantined = 0;
+    // Packed employees without a file of their own, checked against the files and each other.
+    size_t packed = 0;
+    // Files with only notices, like an older format without a checksum. They don't fail the check.
+    size_t notices = 0;
+};
+
+/**
+ * @struct RecordVersion
+ *
+ * @description - One immutable version of an employee, with its folded search keys. Once a
+ * version is published it is never changed, a write makes a new one.
+ */
+struct RecordVersion
+{
+    Employee employee;
+    SearchKeys keys;
+};
+
+typedef std::shared_ptr<const RecordVersion> RecordRef;
+
+/**
+ * @class SnapshotStore
+ *
+ * @description - Multi-version copy of the employee table for readers that must not see a
+ * write half done, like a background search or a list running while another session edits.
+ *
+ * The table is published as an immutable StoreVersion made of pages of record pointers. A write
+ * builds a new version that shares every page it did not touch, swaps it in, and retires the old
+ * one. Readers pin the current version through a Snapshot and iterate it without taking any lock.
+ *
+ * Old versions are freed with epoch based reclamation: pinning writes the global epoch into a
+ * reader slot before loading the current version, and a retired version is only deleted once no
+ * pinned slot holds an epoch at or before the one it was retired in. Pages and records are shared
+ * between versions and freed with the last version that uses them.
+ *
+ * Only one thread may publish, any number may pin.
+ *
+ * @method public publishAll - Publishes the whole table, used after loading and when rows move.
+ * @method public publishRows - Publishes new versions of a few rows, sharing everything else.
+ * @method public pin - Takes a Snapshot of the current version.
+ *
+ */
+class SnapshotStore
+{
+    typedef std::vector<RecordRef> Page;
+
+    struct StoreVersion
+    {
+        unsigned long generation;
+        size_t size;
+        std::vector<std::shared_ptr<const Page>> pages;
+    };
+
+    std::atomic<StoreVersion *> current;
+    std::atomic<unsigned long> epoch;
+    std::atomic<unsigned long> readers[SNAPSHOT_READER_SLOTS];
+    std::vector<std::pair<unsigned long, StoreVersion *>> retired;
+
+    static RecordRef makeRecord(const Employee &e, const SearchKeys &keys)
+    {
+        auto record = std::make_shared<RecordVersion>();
+        record->employee = e;
+        record->keys = keys;
+        return record;
+    }
+
+    void swapIn(StoreVersion *next)
+    {
+        StoreVersion *previous = this->current.exchange(next);
+        if (previous != nullptr)
+        {
+            this->retired.emplace_back(this->epoch.fetch_add(1), previous);
+        }
+        this->reclaim();
+    }
+
+    /**
+     * @function reclaim
+     *
+     * @description - Deletes retired versions no pinned reader can still be looking at.
+     *
+     * @return void
+     */
+    void reclaim()
+    {
+        unsigned long oldestPinned = ULONG_MAX;
+        for (auto &slot : this->readers)
+        {
+            unsigned long pinned = slot.load();
+            if (pinned != 0)
+            {
+                oldestPinned = std::min(oldestPinned, pinned);
+            }
+        }
+
+        auto keep = std::remove_if(this->retired.begin(), this->retired.end(),
+                                   [oldestPinned](const std::pair<unsigned long, StoreVersion *> &entry)
+                                   {
+                                       if (entry.first < oldestPinned)
+                                       {
+                                           delete entry.second;
+                                           return true;
+                                       }
+                                       return false;
+                                   });
+        this->retired.erase(keep, this->retired.end());
+    }
+
+public:
+    /**
+     * @class Snapshot
+     *
+     * @description - A pinned, consistent view of the table. Rows are numbered like the
+     * employees vector was at the time of the snapshot. Unpins when destroyed.
+     */
+    class Snapshot
+    {
+        SnapshotStore *store;
+        int slot;
+        const StoreVersion *version;
+
+        friend class SnapshotStore;
+
+    public:
+        Snapshot() : store(nullptr), slot(-1), version(nullptr) {}
+
+        Snapshot(Snapshot &&other) : store(other.store), slot(other.slot), version(other.version)
+        {
+            other.store = nullptr;
+            other.slot = -1;
+            other.version = nullptr;
+        }
+
+        Snapshot &operator=(Snapshot &&other)
+        {
+            if (this != &other)
+            {
+                this->release();
+                std::swap(this->store, other.store);
+                std::swap(this->slot, other.slot);
+                std::swap(this->version, other.version);
+            }
+            return *this;
+        }
+
+        Snapshot(const Snapshot &) = delete;
+        Snapshot &operator=(const Snapshot &) = delete;
+
+        ~Snapshot() { this->release(); }
+
+        void release()
+        {
+            if (this->store != nullptr)
+            {
+                this->store->readers[this->slot].store(0);
+                this->store = nullptr;
+                this->version = nullptr;
+            }
+        }
+
+        size_t size() const { return this->version == nullptr ? 0 : this->version->size; }
+
+        unsigned long generation() const { return this->version == nullptr ? 0 : this->version->generation; }
+
+        const RecordRef &at(size_t row) const
+        {
+            return (*this->version->pages[row / SNAPSHOT_PAGE_ROWS])[row % SNAPSHOT_PAGE_ROWS];
+        }
+    };
+
+    SnapshotStore() : current(nullptr), epoch(1)
+    {
+        for (auto &slot : this->readers)
+        {
+            slot.store(0);
+        }
+    }
+
+    ~SnapshotStore()
+    {
+        delete this->current.load();
+        for (auto &entry : this->retired)
+        {
+            delete entry.second;
+        }
+    }
+
+    SnapshotStore(const SnapshotStore &) = delete;
+    SnapshotStore &operator=(const SnapshotStore &) = delete;
+
+    void publishAll(const std::vector<Employee> &employees, const std::vector<SearchKeys> &keys,
+                    unsigned long generation)
+    {
+        StoreVersion *next = new StoreVersion;
+        next->generation = generation;
+        next->size = employees.size();
+
+        for (size_t first = 0; first < employees.size(); first += SNAPSHOT_PAGE_ROWS)
+        {
+            auto page = std::make_shared<Page>();
+            size_t last = std::min(employees.size(), first + SNAPSHOT_PAGE_ROWS);
+            page->reserve(last - first);
+            for (size_t row = first; row < last; ++row)
+            {
+                page->push_back(makeRecord(employees[row], keys[row]));
+            }
+            next->pages.push_back(page);
+        }
+
+        this->swapIn(next);
+    }
+
+    /**
+     * @function publishRows
+     *
+     * @description - Publishes new versions of the given rows. Rows past the end of the current
+     * version are appended, and rows past the end of employees are dropped. Only pages holding a
+     * changed row are copied.
+     *
+     * @param vector<Employee> employees - The writer's table.
+     * @param vector<SearchKeys> keys - Search keys lined up with employees.
+     * @param vector<size_t> rows - The rows that changed or were added.
+     * @param unsigned long generation - Store generation after the change.
+     *
+     * @return void
+     */
+    void publishRows(const std::vector<Employee> &employees, const std::vector<SearchKeys> &keys,
+                     const std::vector<size_t> &rows, unsigned long generation)
+    {
+        const StoreVersion *previous = this->current.load();
+        if (previous == nullptr)
+        {
+            this->publishAll(employees, keys, generation);
+            return;
+        }
+
+        StoreVersion *next = new StoreVersion(*previous);
+        next->generation = generation;
+        next->size = employees.size();
+        next->pages.resize((next->size + SNAPSHOT_PAGE_ROWS - 1) / SNAPSHOT_PAGE_ROWS);
+
+        std::vector<bool> copied(next->pages.size(), false);
+
+        // When the table shrank, the last page drops the rows past the end so their records can be freed.
+        size_t tail = next->size % SNAPSHOT_PAGE_ROWS;
+        if (tail != 0 && next->pages.back() && next->pages.back()->size() > tail)
+        {
+            auto page = std::make_shared<Page>(next->pages.back()->begin(), next->pages.back()->begin() + tail);
+            next->pages.back() = page;
+            copied.back() = true;
+        }
+        for (size_t row : rows)
+        {
+            size_t index = row / SNAPSHOT_PAGE_ROWS;
+            if (!copied[index])
+            {
+                next->pages[index] = next->pages[index] ? std::make_shared<Page>(*next->pages[index])
+                                                        : std::make_shared<Page>();
+                copied[index] = true;
+            }
+
+            Page &page = const_cast<Page &>(*next->pages[index]);
+            if (page.size() <= row % SNAPSHOT_PAGE_ROWS)
+            {
+                page.resize(row % SNAPSHOT_PAGE_ROWS + 1);
+            }
+            page[row % SNAPSHOT_PAGE_ROWS] = makeRecord(employees[row], keys[row]);
+        }
+
+        this->swapIn(next);
+    }
+
+    /**
+     * @function pin
+     *
+     * @description - Pins the current version. Lock free: it claims a free reader slot with a
+     * compare and swap and only waits if every slot is in use.
+     *
+     * @return Snapshot - The pinned view.
+     */
+    Snapshot pin()
+    {
+        Snapshot snapshot;
+        while (true)
+        {
+            for (int slot = 0; slot < SNAPSHOT_READER_SLOTS; ++slot)
+            {
+                unsigned long idle = 0;
+                if (this->readers[slot].compare_exchange_strong(idle, this->epoch.load()))
+                {
+                    snapshot.store = this;
+                    snapshot.slot = slot;
+                    snapshot.version = this->current.load();
+                    return snapshot;
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+};
+
+/**
+ * @struct ChangeEvent
+ *
+ * @description - One change to the store, as carried by the change feed.
+ *
+ * @prop sequence unsigned long - Position in the feed, starting at 1 and never reused.
+ * @prop kind string - "add", "edit", "permissions" for an edit of only the permissions, or "remove".
+ * @prop id int - Id of the employee changed.
+ * @prop employee Employee - The employee after the change, only the id is set for a remove.
+ */
+struct ChangeEvent
+{
+    unsigned long sequence = 0;
+    std::string kind;
+    int id = 0;
+    Employee employee;
+
+    /**
+     * @function toString
+     *
+     * @description - The line written to the change log, ending in " #" and the CRC32C of
+     * what comes before it in hex:
+     *  - <sequence> <kind> <id> v<RECORD_FORMAT_VERSION> <record fields> #<checksum>
+     *  - <sequence> remove <id> #<checksum>
+     *
+     * @param bool redact - True for a line to print, with the password replaced by REDACTED_PASSWORD.
+     *
+     * @return string - The line, without a new line.
+     */
+    std::string toString(bool redact = false) const
+    {
+        std::ostringstream oss;
+        oss << this->sequence << " " << this->kind << " " << this->id;
+        if (this->kind != "remove")
+        {
+            Employee shown = this->employee;
+            if (redact)
+            {
+                shown.updatePassword(REDACTED_PASSWORD);
+            }
+            // The record line is the second line of the employee's file contents.
+            std::string record = shown.serialize();
+            size_t start = record.find('\n') + 1;
+            oss << " v" << RECORD_FORMAT_VERSION << " " << record.substr(start, record.size() - start - 1);
+        }
+
+        std::string line = oss.str();
+        char checksum[16];
+        std::snprintf(checksum, sizeof(checksum), " #%08x", crc32c(line));
+        return line + checksum;
+    }
+
+    /**
+     * @function parse - static
+     *
+     * @description - Reads a line of the change log.
+     *
+     * @param string line - The line.
+     * @param ChangeEvent *event - The event to fill in.
+     *
+     * @return bool - Returns true if the line was a whole event and matches its checksum. Only
+     * lines logged before checksums may have none: records in formats before v4, and removes,
+     * which must then be nothing but the three fields.
+     */
+    static bool parse(std::string line, ChangeEvent *event)
+    {
+        size_t mark = line.size() >= 10 ? line.size() - 10 : std::string::npos;
+        bool checked = mark != std::string::npos && line.compare(mark, 2, " #") == 0;
+        if (checked)
+        {
+            if (std::strtoul(line.c_str() + mark + 2, nullptr, 16) != crc32c(line.data(), mark))
+            {
+                return false;
+            }
+            line.resize(mark);
+        }
+
+        std::istringstream iss(line);
+        iss >> event->sequence >> event->kind >> event->id;
+        if (iss.fail())
+        {
+            return false;
+        }
+
+        event->employee = Employee();
+        event->employee.id = event->id;
+        std::string version, record;
+        iss >> version;
+        if (event->kind == "remove")
+        {
+            return checked || version.empty();
+        }
+
+        getline(iss, record);
+        int format = version.size() > 1 && version[0] == 'v' ? std::atoi(version.c_str() + 1) : 0;
+        return format > 0 && (checked || format < 4) && Employee::parseRecord(record, format, &event->employee);
+    }
+};
+
+/**
+ * @class ChangeFeed
+ *
+ * @description - Ordered feed of changes to the store. Every change is appended to
+ * EMPLOYEE_CHANGES with the next sequence number, then handed to each subscriber in this process.
+ * Consumers keep the last sequence they handled and resume after it, from the log or by
+ * subscribing with it, so they only ever see the changes they haven't processed.
+ *
+ * @method public publish - Numbers, logs, and delivers a batch of changes.
+ * @method public subscribe - Delivers every change after a sequence number, then new ones as they happen.
+ * @method public unsubscribe - Stops delivering to a subscriber.
+ * @method public static readLog - Reads the logged changes after a sequence number.
+ * @method public static lastLoggedSequence - The sequence of the last logged change.
+ * @method public static loggedSize - The length of the log up to its last whole line.
+ *
+ */
+class ChangeFeed
+{
+    typedef std::function<void(const ChangeEvent &)> Subscriber;
+
+    std::mutex lock;
+    std::map<int, Subscriber> subscribers;
+    int nextSubscription;
+    std::vector<ChangeEvent> unlogged;
+
+    /**
+     * @function append
+     *
+     * @description - Numbers a batch of changes after the last logged one and appends them to
+     * the log under the log's lock. A failed append is cut back off the log, so it never ends
+     * in half a line, and so is half a line left by a session that stopped partway through one.
+     *
+     * @param vector<ChangeEvent> &events - The changes, sequence numbers are filled in.
+     *
+     * @return bool - Returns true if every line was logged.
+     */
+    static bool append(std::vector<ChangeEvent> &events)
+    {
+        if (!lockFile(EMPLOYEE_CHANGES_LOCK))
+        {
+            return false;
+        }
+
+        std::error_code ec;
+        std::streamoff size = loggedSize();
+        if (fs::file_size(EMPLOYEE_CHANGES, ec) != (uintmax_t)size && !ec)
+        {
+            fs::resize_file(EMPLOYEE_CHANGES, size, ec);
+        }
+
+        unsigned long sequence = lastLoggedSequence();
+        std::string lines;
+        for (ChangeEvent &event : events)
+        {
+            event.sequence = ++sequence;
+            lines += event.toString();
+            lines += '\n';
+        }
+
+        FILE *log = appendPrivate(EMPLOYEE_CHANGES);
+        bool logged = log != nullptr && fwrite(lines.data(), 1, lines.size(), log) == lines.size();
+        if (log != nullptr)
+        {
+            logged = fclose(log) == 0 && logged;
+        }
+        if (!logged)
+        {
+            fs::resize_file(EMPLOYEE_CHANGES, size, ec);
+            for (ChangeEvent &event : events)
+            {
+                event.sequence = 0;
+            }
+        }
+
+        unlockFile(EMPLOYEE_CHANGES_LOCK);
+        return logged;
+    }
+
+    /**
+     * @function endOfLines - static
+     *
+     * @description - Searches back from an offset for the last newline, a chunk at a time since
+     * a line can be any length.
+     *
+     * @param ifstream &log - The open log.
+     * @param streamoff size - The offset to search back from.
+     *
+     * @return streamoff - The offset just after the newline, 0 if there is none.
+     */
+    static std::streamoff endOfLines(std::ifstream &log, std::streamoff size)
+    {
+        char chunk[4096];
+        while (size > 0)
+        {
+            std::streamoff start = std::max<std::streamoff>(0, size - (std::streamoff)sizeof(chunk));
+            log.clear();
+            log.seekg(start);
+            if (!log.read(chunk, size - start))
+            {
+                return 0;
+            }
+            for (std::streamoff i = size - start; i > 0; --i)
+            {
+                if (chunk[i - 1] == '\n')
+                {
+                    return start + i;
+                }
+            }
+            size = start;
+        }
+        return 0;
+    }
+
+public:
+    /**
+     * @function loggedSize - static
+     *
+     * @description - The length of the log up to the end of its last whole line. A session that
+     * stopped partway through an append can leave a line without its newline, which isn't logged.
+     *
+     * @param streamoff before - Only looks at the log before this byte offset, -1 for the whole log.
+     *
+     * @return streamoff - The offset just after the last newline, 0 if there is none.
+     */
+    static std::streamoff loggedSize(std::streamoff before = -1)
+    {
+        std::ifstream log(EMPLOYEE_CHANGES, std::ios::binary);
+        if (!log)
+        {
+            return 0;
+        }
+        log.seekg(0, std::ios::end);
+        std::streamoff size = log.tellg();
+        return endOfLines(log, before < 0 ? size : std::min(before, size));
+    }
+
+    /**
+     * @function lastLoggedSequence - static
+     *
+     * @description - Reads the sequence number of the last whole line in the log. Another session
+     * may have appended since this one did, so it is read again for every batch.
+     *
+     * @param streamoff before - Reads the last line before this byte offset instead, -1 for the end of the log.
+     *
+     * @return unsigned long - The last sequence number, 0 if the log is empty.
+     */
+    static unsigned long lastLoggedSequence(std::streamoff before = -1)
+    {
+        std::ifstream log(EMPLOYEE_CHANGES, std::ios::binary);
+        if (!log)
+        {
+            return 0;
+        }
+
+        log.seekg(0, std::ios::end);
+        std::streamoff size = log.tellg();
+        std::streamoff end = endOfLines(log, before < 0 ? size : std::min(before, size));
+        if (end == 0)
+        {
+            return 0;
+        }
+        std::streamoff begin = endOfLines(log, end - 1);
+
+        // The sequence number leads the line, so only its first few bytes are needed.
+        char head[32] = {};
+        log.clear();
+        log.seekg(begin);
+        log.read(head, std::min<std::streamoff>(end - 1 - begin, sizeof(head) - 1));
+        return std::strtoul(head, nullptr, 10);
+    }
+
+    ChangeFeed() : nextSubscription(1) {}
+
+    /**
+     * @function publish
+     *
+     * @description - Gives each change the next sequence number, appends them to the log, and
+     * delivers them to every subscriber in order. Called after the changes are saved. Only
+     * logged changes are delivered, since subscribers key on the sequence number: if the log
+     * can't be appended to after CHANGE_LOG_ATTEMPTS tries, the changes wait and are logged and
+     * delivered, in order, ahead of the next batch.
+     *
+     * @param vector<ChangeEvent> events - The changes, sequence numbers are filled in.
+     *
+     * @return bool - Returns true if the changes, and any that were waiting, were logged.
+     */
+    bool publish(std::vector<ChangeEvent> events)
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+
+        this->unlogged.insert(this->unlogged.end(), events.begin(), events.end());
+        bool logged = false;
+        for (int attempt = 0; attempt < CHANGE_LOG_ATTEMPTS && !logged; ++attempt)
+        {
+            logged = append(this->unlogged);
+        }
+        if (!logged)
+        {
+            return false;
+        }
+
+        for (const ChangeEvent &event : this->unlogged)
+        {
+            for (auto &subscriber : this->subscribers)
+            {
+                subscriber.second(event);
+            }
+        }
+        this->unlogged.clear();
+
+        return true;
+    }
+
+    /**
+     * @function subscribe
+     *
+     * @description - Delivers every logged change after a sequence number, then every new change
+     * as it is published, until unsubscribed. Called on the thread that made the change.
+     *
+     * @param function<void(const ChangeEvent &)> subscriber - Called once per change, in order.
+     * @param unsigned long after - Last sequence the subscriber already has, 0 for everything.
+     * @param streamoff from - Byte offset in the log to start reading at, where the subscriber
+     * knows every earlier change is, 0 to read the whole log.
+     *
+     * @return int - Id to unsubscribe with.
+     */
+    int subscribe(Subscriber subscriber, unsigned long after = 0, std::streamoff from = 0)
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+
+        for (const ChangeEvent &event : readLog(after, from))
+        {
+            subscriber(event);
+        }
+
+        int id = this->nextSubscription++;
+        this->subscribers[id] = std::move(subscriber);
+        return id;
+    }
+
+    void unsubscribe(int id)
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->subscribers.erase(id);
+    }
+
+    /**
+     * @function readLog - static
+     *
+     * @description - Reads the changes in the log after a sequence number. Only whole lines are
+     * read, one still being appended by another session is left for the next read.
+     *
+     * @param unsigned long after - Last sequence already seen, 0 for everything.
+     * @param streamoff from - Byte offset to start reading at, the start of a line.
+     * @param streamoff *end - Set to the offset just after the last whole line, if given.
+     * @param streamoff until - Stops at this byte offset, -1 to read to the end of the log.
+     *
+     * @return vector<ChangeEvent> - The changes, in order.
+     */
+    static std::vector<ChangeEvent> readLog(unsigned long after, std::streamoff from = 0, std::streamoff *end = nullptr,
+                                            std::streamoff until = -1)
+    {
+        std::vector<ChangeEvent> events;
+        std::ifstream log(EMPLOYEE_CHANGES, std::ios::binary);
+        log.seekg(from);
+        std::streamoff position = log ? from : 0;
+        std::string line;
+        while (getline(log, line) && !log.eof())
+        {
+            if (until >= 0 && position + (std::streamoff)line.size() + 1 > until)
+            {
+                break;
+            }
+            position += line.size() + 1;
+
+            // Sequence numbers are at the front, so old lines are skipped without parsing the record.
+            if (std::strtoul(line.c_str(), nullptr, 10) <= after)
+            {
+                continue;
+            }
+
+            ChangeEvent event;
+            if (ChangeEvent::parse(line, &event))
+            {
+                events.push_back(event);
+            }
+        }
+
+        if (end != nullptr)
+        {
+            *end = position;
+        }
+        return events;
+    }
+};
+
+/**
+ * @class ChangeTail
+ *
+ * @description - Follows the change log from a background thread for a replica. Every
+ * REPLICA_POLL_MS it reads only the bytes appended since the last look, parses the whole lines,
+ * and queues the events for the main thread, which takes them when it is safe to change the
+ * store. A line still being written is read again once its newline arrives, since one left by a
+ * session that stopped partway through is cut off by the next append.
+ *
+ * @method public start - Starts following the log from a byte offset.
+ * @method public take - Takes the events queued so far.
+ * @method public static logSize - The size of the log's whole lines now, to start from.
+ *
+ */
+class ChangeTail
+{
+    std::mutex lock;
+    std::condition_variable wake;
+    bool stopping;
+    std::thread reader;
+    std::deque<ChangeEvent> pending;
+    std::streamoff offset;
+
+    void poll()
+    {
+        std::ifstream log(EMPLOYEE_CHANGES, std::ios::binary | std::ios::ate);
+        if (!log)
+        {
+            return;
+        }
+
+        std::streamoff size = log.tellg();
+        if (size < this->offset)
+        {
+            // The log was replaced, so it is read again from the start. Sequence numbers tell
+            // the replica which events it already has.
+            this->offset = 0;
+        }
+        if (size == this->offset)
+        {
+            return;
+        }
+
+        std::string chunk(size - this->offset, '\0');
+        log.seekg(this->offset);
+        if (!log.read(&chunk[0], chunk.size()))
+        {
+            return;
+        }
+        size_t whole = chunk.rfind('\n');
+        if (whole == std::string::npos)
+        {
+            return;
+        }
+        this->offset += whole + 1;
+
+        std::vector<ChangeEvent> events;
+        for (size_t start = 0, end; start <= whole; start = end + 1)
+        {
+            end = chunk.find('\n', start);
+            ChangeEvent event;
+            if (ChangeEvent::parse(chunk.substr(start, end - start), &event))
+            {
+                events.push_back(event);
+            }
+        }
+
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->pending.insert(this->pending.end(), events.begin(), events.end());
+    }
+
+    void run()
+    {
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> guard(this->lock);
+                this->wake.wait_for(guard, std::chrono::milliseconds(REPLICA_POLL_MS),
+                                    [this]
+                                    { return this->stopping; });
+                if (this->stopping)
+                {
+                    return;
+                }
+            }
+            this->poll();
+        }
+    }
+
+public:
+    ChangeTail() : stopping(false), offset(0) {}
+
+    ~ChangeTail()
+    {
+        {
+            std::lock_guard<std::mutex> guard(this->lock);
+            this->stopping = true;
+        }
+        this->wake.notify_one();
+        if (this->reader.joinable())
+        {
+            this->reader.join();
+        }
+    }
+
+    ChangeTail(const ChangeTail &) = delete;
+    ChangeTail &operator=(const ChangeTail &) = delete;
+
+    void start(std::streamoff from)
+    {
+        this->offset = from;
+        this->reader = std::thread([this]
+                                   { this->run(); });
+    }
+
+    std::vector<ChangeEvent> take()
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        std::vector<ChangeEvent> events(this->pending.begin(), this->pending.end());
+        this->pending.clear();
+        return events;
+    }
+
+    static std::streamoff logSize()
+    {
+        return ChangeFeed::loggedSize();
+    }
+};
+
+/**
+ * @struct HistoryEntry
+ *
+ * @description - One past version of an employee.
+ *
+ * @prop time time_t - When the version was saved.
+ * @prop removed bool - True if this entry is the employee being removed.
+ * @prop employee Employee - The employee as saved, rebuilt from the history.
+ * @prop changed vector<string> - Names of the fields that changed from the version before.
+ */
+struct HistoryEntry
+{
+    time_t time = 0;
+    bool removed = false;
+    Employee employee;
+    std::vector<std::string> changed;
+};
+
+/**
+ * @class RecordHistory
+ *
+ * @description - Keeps every saved version of each employee in EMPLOYEE_HISTORY_DIR/<id>.hist,
+ * one line per version, so past states can be looked up. Lines are:
+ *  - <time> full v<format> <record fields> - the whole record.
+ *  - <time> delta <field>=<value> ... - the fields that changed since the line before.
+ *  - <time> removed
+ *
+ * A full line is written every HISTORY_FULL_INTERVAL lines and when the record format changes,
+ * so any version is rebuilt from the nearest full line before it. History is only written when
+ * an employee is saved and only read when asked for, the current employees never touch it.
+ * Changes are appended while the record lock is held, so lines are in revision order even when
+ * several sessions save the same employee.
+ *
+ * @method public static append - Adds the version from a change to the employee's history.
+ * @method public static entries - Every version of an employee, oldest first.
+ * @method public static asOf - The employee as it was at a point in time.
+ *
+ */
+class RecordHistory
+{
+    /**
+     * @struct Tail
+     *
+     * @description - What append needs from the end of a history file, kept from the last append
+     * so the file is only read again when another session has appended to it.
+     *
+     * @prop size uintmax_t - Size of the file the tail was taken at.
+     * @prop fields vector<string> - Record fields of the last line, empty if it was a remove.
+     * @prop version int - Record format version of the fields.
+     * @prop sinceFull size_t - Lines after the last full line.
+     */
+    struct Tail
+    {
+        uintmax_t size = 0;
+        std::vector<std::string> fields;
+        int version = 0;
+        size_t sinceFull = 0;
+    };
+
+    static std::mutex &tailsLock()
+    {
+        static std::mutex lock;
+        return lock;
+    }
+
+    static std::unordered_map<int, Tail> &tails()
+    {
+        static std::unordered_map<int, Tail> cached;
+        return cached;
+    }
+
+    static Tail readTail(int id, uintmax_t size)
+    {
+        Tail tail;
+        tail.size = size;
+        std::vector<std::string> lines = readLines(id);
+        while (tail.sinceFull < lines.size() && kindOf(lines[lines.size() - 1 - tail.sinceFull]) != "full")
+        {
+            tail.sinceFull++;
+        }
+        if (!lines.empty() && !fieldsAt(lines, lines.size() - 1, tail.fields, tail.version, nullptr))
+        {
+            tail.fields.clear();
+        }
+        return tail;
+    }
+
+    static fs::path pathOf(int id)
+    {
+        return EMPLOYEE_HISTORY_DIR / (std::to_string(id) + ".hist");
+    }
+
+    static std::vector<std::string> splitFields(const std::string &text)
+    {
+        std::vector<std::string> fields;
+        std::istringstream iss(text);
+        std::string field;
+        while (iss >> field)
+        {
+            fields.push_back(field);
+        }
+        return fields;
+    }
+
+    static std::string kindOf(const std::string &line)
+    {
+        size_t start = line.find(' ') + 1;
+        return line.substr(start, line.find(' ', start) - start);
+    }
+
+    static std::vector<std::string> readLines(int id)
+    {
+        std::vector<std::string> lines;
+        std::ifstream file(pathOf(id));
+        std::string line;
+        while (getline(file, line))
+        {
+            if (!line.empty())
+            {
+                lines.push_back(line);
+            }
+        }
+        return lines;
+    }
+
+    /**
+     * @function fieldsAt - static
+     *
+     * @description - Rebuilds the record fields as of one line, starting from the last full line
+     * at or before it, so at most HISTORY_FULL_INTERVAL lines are applied.
+     *
+     * @param vector<string> lines - The history lines.
+     * @param size_t at - The line to rebuild.
+     * @param vector<string> &fields - Set to the fields.
+     * @param int &version - Set to the record format version of the fields.
+     * @param vector<string> *changed - If given, set to the names of the fields the line changed.
+     *
+     * @return bool - Returns false if the line is a remove or there is no full line to start from.
+     */
+    static bool fieldsAt(const std::vector<std::string> &lines, size_t at, std::vector<std::string> &fields,
+                         int &version, std::vector<std::string> *changed)
+    {
+        size_t start = at + 1;
+        while (start > 0 && kindOf(lines[start - 1]) != "full")
+        {
+            start--;
+        }
+        if (start == 0)
+        {
+            return false;
+        }
+        start--;
+
+        for (size_t i = start; i <= at; ++i)
+        {
+            std::vector<std::string> tokens = splitFields(lines[i]);
+            if (tokens.size() < 2 || tokens[1] == "removed")
+            {
+                return false;
+            }
+
+            if (tokens[1] == "full")
+            {
+                version = tokens.size() > 2 ? std::atoi(tokens[2].c_str() + 1) : 0;
+                fields.assign(tokens.begin() + std::min<size_t>(3, tokens.size()), tokens.end());
+                if (changed != nullptr)
+                {
+                    changed->assign(1, "all");
+                }
+                continue;
+            }
+
+            if (changed != nullptr)
+            {
+                changed->clear();
+            }
+            for (size_t t = 2; t < tokens.size(); ++t)
+            {
+                size_t equals = tokens[t].find('=');
+                size_t field = std::strtoul(tokens[t].c_str(), nullptr, 10);
+                if (equals == std::string::npos || field >= fields.size())
+                {
+                    continue;
+                }
+                fields[field] = tokens[t].substr(equals + 1);
+                // Every save bumps the revision, it isn't news.
+                if (changed != nullptr && fieldName(field) != "revision")
+                {
+                    changed->push_back(fieldName(field));
+                }
+            }
+        }
+
+        return true;
+    }
+
+    static std::string fieldName(size_t field)
+    {
+        static const char *names[] = {"id", "username", "firstName", "lastName", "password", "permissions",
+                                      "managerId", "department", "hireDate", "salaryBand", "fte", "revision"};
+        return field < sizeof(names) / sizeof(names[0]) ? names[field] : std::to_string(field);
+    }
+
+    static bool toEmployee(const std::vector<std::string> &fields, int version, Employee *employee)
+    {
+        std::string record;
+        for (const std::string &field : fields)
+        {
+            record += field;
+            record += ' ';
+        }
+        return Employee::parseRecord(record, version, employee);
+    }
+
+public:
+    /**
+     * @function append - static
+     *
+     * @description - Adds the employee from a change to its history, as the fields that differ
+     * from the last version unless a full line is due. Called with the record lock held. The last
+     * version is taken from the tail kept by the previous append while the file is still the
+     * size it left it, so a save doesn't read the whole history.
+     *
+     * @param ChangeEvent event - The change that was saved.
+     *
+     * @return bool - Returns true if the history was written.
+     */
+    static bool append(const ChangeEvent &event)
+    {
+        std::error_code ec;
+        fs::create_directory(EMPLOYEE_HISTORY_DIR, ec);
+
+        std::lock_guard<std::mutex> guard(tailsLock());
+        uintmax_t size = fs::file_size(pathOf(event.id), ec);
+        if (ec)
+        {
+            size = 0;
+        }
+        auto cached = tails().find(event.id);
+        Tail tail = cached != tails().end() && cached->second.size == size ? cached->second : readTail(event.id, size);
+
+        std::ostringstream oss;
+        oss << std::time(nullptr) << " ";
+        std::vector<std::string> current;
+        bool full = false;
+
+        if (event.kind == "remove")
+        {
+            oss << "removed";
+        }
+        else
+        {
+            std::string record = event.employee.serialize();
+            current = splitFields(record.substr(record.find('\n') + 1));
+
+            full = tail.fields.empty() || tail.sinceFull + 1 >= (size_t)HISTORY_FULL_INTERVAL ||
+                   tail.version != RECORD_FORMAT_VERSION || tail.fields.size() != current.size();
+            if (full)
+            {
+                oss << "full v" << RECORD_FORMAT_VERSION;
+                for (const std::string &field : current)
+                {
+                    oss << " " << field;
+                }
+            }
+            else
+            {
+                oss << "delta";
+                for (size_t field = 0; field < current.size(); ++field)
+                {
+                    if (current[field] != tail.fields[field])
+                    {
+                        oss << " " << field << "=" << current[field];
+                    }
+                }
+            }
+        }
+
+        std::string line = oss.str() + "\n";
+        FILE *file = appendPrivate(pathOf(event.id));
+        bool written = file != nullptr && fwrite(line.data(), 1, line.size(), file) == line.size();
+        if (file != nullptr)
+        {
+            written = fclose(file) == 0 && written;
+        }
+
+        // A failed write may have left part of a line, the next append reads the file again.
+        if (!written)
+        {
+            tails().erase(event.id);
+            return false;
+        }
+        tail.size = size + line.size();
+        tail.fields = current;
+        tail.version = RECORD_FORMAT_VERSION;
+        tail.sinceFull = full ? 0 : tail.sinceFull + 1;
+        tails()[event.id] = tail;
+        return true;
+    }
+
+    /**
+     * @function entries - static
+     *
+     * @description - Every version of an employee in the order they were saved.
+     *
+     * @param int id - The id of the employee.
+     *
+     * @return vector<HistoryEntry> - The versions, empty if there is no history.
+     */
+    static std::vector<HistoryEntry> entries(int id)
+    {
+        std::vector<std::string> lines = readLines(id);
+        std::vector<HistoryEntry> out;
+
+        std::vector<std::string> fields;
+        int version = 0;
+        for (size_t i = 0; i < lines.size(); ++i)
+        {
+            HistoryEntry entry;
+            entry.time = std::strtoll(lines[i].c_str(), nullptr, 10);
+            entry.removed = kindOf(lines[i]) == "removed";
+            entry.employee.id = id;
+
+            if (!entry.removed && fieldsAt(lines, i, fields, version, &entry.changed))
+            {
+                toEmployee(fields, version, &entry.employee);
+            }
+            out.push_back(entry);
+        }
+
+        return out;
+    }
+
+    /**
+     * @function asOf - static
+     *
+     * @description - Rebuilds an employee as it was at a point in time, from the last version
+     * saved at or before it. An employee with no history hasn't been saved since history was
+     * kept, so the current record is the only version known and is given for any time.
+     *
+     * @param int id - The id of the employee.
+     * @param time_t when - The point in time.
+     * @param Employee *current - The employee as the store holds them now, nullptr if it doesn't.
+     * @param Employee *employee - Set to the employee as it was.
+     *
+     * @return bool - Returns false if the employee didn't exist then, or had been removed.
+     */
+    static bool asOf(int id, time_t when, const Employee *current, Employee *employee)
+    {
+        std::vector<std::string> lines = readLines(id);
+        if (lines.empty() && current != nullptr)
+        {
+            *employee = *current;
+            return true;
+        }
+
+        // Lines are in time order, so the version in effect is the last one not after when.
+        size_t count = 0;
+        while (count < lines.size() && std::strtoll(lines[count].c_str(), nullptr, 10) <= when)
+        {
+            count++;
+        }
+        if (count == 0)
+        {
+            return false;
+        }
+
+        std::vector<std::string> fields;
+        int version = 0;
+        return fieldsAt(lines, count - 1, fields, version, nullptr) && toEmployee(fields, version, employee);
+    }
+};
+
+/**
+ * @struct AuditRecord
+ *
+ * @description - One audited action, written to segments as these 24 bytes in host byte order.
+ *
+ * @prop timeMs int64_t - When it happened, in milliseconds since 1970-01-01.
+ * @prop actor int32_t - Id of the employee who did it, 0 if unknown, like a failed login.
+ * @prop target int32_t - Id of the employee it was done to.
+ * @prop action uint32_t - One of the AUDIT_ constants.
+ * @prop checksum uint32_t - CRC32C of the 20 bytes before it, 0 in records written before checksums.
+ */
+struct AuditRecord
+{
+    int64_t timeMs;
+    int32_t actor;
+    int32_t target;
+    uint32_t action;
+    uint32_t checksum;
+};
+
+static_assert(sizeof(AuditRecord) == 24, "audit records are written as raw 24 byte blocks");
+
+/**
+ * @struct AuditBatch
+ *
+ * @description - Header written before each batch of records, as these 16 bytes in host byte order.
+ *
+ * @prop mark uint32_t - AUDIT_BATCH_MARK.
+ * @prop count uint32_t - Records in the batch, 1 to AUDIT_RING_CAPACITY.
+ * @prop records uint32_t - CRC32C of the records.
+ * @prop checksum uint32_t - CRC32C of the 12 bytes before it.
+ */
+struct AuditBatch
+{
+    uint32_t mark;
+    uint32_t count;
+    uint32_t records;
+    uint32_t checksum;
+};
+
+static_assert(sizeof(AuditBatch) == 16, "audit batch headers are written as raw 16 byte blocks");
+
+/**
+ * @struct AuditFilter
+ *
+ * @description - What to look for in the audit log. Zero in any field matches everything.
+ */
+struct AuditFilter
+{
+    int32_t actor = 0;
+    int32_t target = 0;
+    uint32_t action = 0;
+    int64_t fromMs = 0;
+    int64_t toMs = 0;
+};
+
+/**
+ * @class AuditLog
+ *
+ * @description - Records who logged in and who viewed, edited, and removed whom, without slowing
+ * down the screens that do it. Screens hand records to a bounded lock free queue for many
+ * producers and one consumer, and a background writer drains it every AUDIT_FLUSH_MS, writing
+ * each batch to the current segment in one call.
+ *
+ * The queue is a ring of cells with a sequence number each: a producer claims a slot by moving
+ * the enqueue position with a compare and swap, fills the cell, and publishes it by setting the
+ * cell's sequence. The writer is the only consumer, so its position is a plain counter. If the
+ * ring is full a producer wakes the writer and waits for room rather than drop a record.
+ *
+ * Segments are AUDIT_DIR/<number>.seg, starting with AUDIT_MAGIC and then batches, each an
+ * AuditBatch header and its records. They are opened for append so sessions can share one, and a
+ * new one is started when the current passes AUDIT_SEGMENT_BYTES or a write to it fails. Segments
+ * from before batches were framed start with AUDIT_MAGIC_V1 and are bare records, they are read
+ * but never appended to. A session holds a shared lock on the segment it appends to, and old
+ * segments are only deleted when no session holds one, so a slower session never writes to a
+ * deleted file.
+ *
+ * @method public record - Queues an audit record. Never blocks unless the ring is full.
+ * @method public static query - Reads the records matching a filter from every segment.
+ * @method public static actionName - Name of an action for printing.
+ *
+ */
+class AuditLog
+{
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        AuditRecord record;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    alignas(64) std::atomic<size_t> enqueuePosition;
+    alignas(64) size_t dequeuePosition;
+
+    std::mutex wakeLock;
+    std::condition_variable wake;
+    std::atomic<bool> stopping;
+    std::thread writer;
+
+    FILE *segment;
+    long segmentBytes;
+    unsigned long segmentNumber;
+    std::vector<AuditRecord> pending;
+
+    bool tryPush(const AuditRecord &record)
+    {
+        size_t position = this->enqueuePosition.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell &cell = this->cells[position & (AUDIT_RING_CAPACITY - 1)];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+            if (difference == 0)
+            {
+                if (this->enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.record = record;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = this->enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(AuditRecord &record)
+    {
+        Cell &cell = this->cells[this->dequeuePosition & (AUDIT_RING_CAPACITY - 1)];
+        if (cell.sequence.load(std::memory_order_acquire) != this->dequeuePosition + 1)
+        {
+            return false;
+        }
+
+        record = cell.record;
+        cell.sequence.store(this->dequeuePosition + AUDIT_RING_CAPACITY, std::memory_order_release);
+        this->dequeuePosition++;
+        return true;
+    }
+
+    static fs::path segmentPath(unsigned long number)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%08lu.seg", number);
+        return AUDIT_DIR / name;
+    }
+
+    static std::vector<fs::path> segmentFiles()
+    {
+        std::vector<fs::path> segments;
+        std::error_code ec;
+        for (const auto &entry : fs::directory_iterator(AUDIT_DIR, ec))
+        {
+            if (entry.path().extension() == ".seg")
+            {
+                segments.push_back(entry.path());
+            }
+        }
+        // Names are zero padded, so name order is segment order.
+        std::sort(segments.begin(), segments.end());
+        return segments;
+    }
+
+    /**
+     * @function openSegment
+     *
+     * @description - Opens a segment for append, creating it with the header if it is new. Writes
+     * are unbuffered so each batch reaches the file in one write, even with other sessions
+     * appending to the same segment. A segment that doesn't start with AUDIT_MAGIC, an old one or
+     * one whose header was never written, is passed over for the next number.
+     *
+     * @param unsigned long number - The segment number to start at.
+     *
+     * @return bool - Returns true if the segment is open.
+     */
+    bool openSegment(unsigned long number)
+    {
+        for (int attempt = 0; attempt < 4; ++attempt, ++number)
+        {
+            std::string path = segmentPath(number).string();
+            this->segmentNumber = number;
+            FILE *file = fopen(path.c_str(), "wbx");
+            if (file != nullptr)
+            {
+                fwrite(AUDIT_MAGIC, 1, sizeof(AUDIT_MAGIC), file);
+                fclose(file);
+            }
+
+            char magic[sizeof(AUDIT_MAGIC)];
+            std::ifstream header(path, std::ios::binary);
+            if (!header.read(magic, sizeof(magic)) || std::memcmp(magic, AUDIT_MAGIC, sizeof(magic)) != 0)
+            {
+                continue;
+            }
+
+            this->segment = fopen(path.c_str(), "ab");
+            if (this->segment == nullptr)
+            {
+                return false;
+            }
+            if (!holdSegment(this->segment, path))
+            {
+                fclose(this->segment);
+                this->segment = nullptr;
+                continue;
+            }
+            setvbuf(this->segment, nullptr, _IONBF, 0);
+            fseek(this->segment, 0, SEEK_END);
+            this->segmentBytes = ftell(this->segment);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @function holdSegment - static
+     *
+     * @description - Takes a shared lock on an open segment for as long as it stays open, and
+     * checks the path still names it, since another session may have deleted it in between.
+     *
+     * @param FILE *file - The segment, open for append.
+     * @param string path - Its path.
+     *
+     * @return bool - Returns true if the segment is held and still in AUDIT_DIR.
+     */
+    static bool holdSegment(FILE *file, const std::string &path)
+    {
+#if !defined _WIN32
+        struct stat held, current;
+        return flock(fileno(file), LOCK_SH) == 0 && fstat(fileno(file), &held) == 0 &&
+               stat(path.c_str(), &current) == 0 && held.st_dev == current.st_dev && held.st_ino == current.st_ino;
+#else
+        (void)file;
+        (void)path;
+        return true;
+#endif
+    }
+
+    /**
+     * @function removeUnheld - static
+     *
+     * @description - Deletes a segment unless a session still holds it. Windows won't delete an
+     * open file, so there it is just removed.
+     *
+     * @param path segment - The segment.
+     *
+     * @return void
+     */
+    static void removeUnheld(const fs::path &segment)
+    {
+        std::error_code ec;
+#if !defined _WIN32
+        int fd = open(segment.string().c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return;
+        }
+        if (flock(fd, LOCK_EX | LOCK_NB) == 0)
+        {
+            fs::remove(segment, ec);
+        }
+        close(fd);
+#else
+        fs::remove(segment, ec);
+#endif
+    }
+
+    /**
+     * @function rotate
+     *
+     * @description - Closes the current segment, starts the next, and deletes the segments past
+     * the newest AUDIT_SEGMENTS_KEPT that no session is still appending to.
+     *
+     * @return void
+     */
+    void rotate()
+    {
+        if (this->segment != nullptr)
+        {
+            fclose(this->segment);
+            this->segment = nullptr;
+        }
+        this->openSegment(this->segmentNumber + 1);
+
+        std::vector<fs::path> segments = segmentFiles();
+        for (size_t i = 0; i + AUDIT_SEGMENTS_KEPT < segments.size(); ++i)
+        {
+            removeUnheld(segments[i]);
+        }
+    }
+
+    /**
+     * @function drain
+     *
+     * @description - Writes everything queued so far, and anything an earlier drain couldn't
+     * write, to the current segment in batches. When a write fails the segment is left, since it
+     * may end in part of a batch, and the records are written to the next segment on the next
+     * drain. Past AUDIT_PENDING_LIMIT waiting records the oldest are dropped.
+     *
+     * @return void
+     */
+    void drain()
+    {
+        AuditRecord record;
+        while (this->tryPop(record))
+        {
+            this->pending.push_back(record);
+        }
+        if (this->pending.empty())
+        {
+            return;
+        }
+
+        if (this->segment == nullptr)
+        {
+            this->rotate();
+        }
+
+        size_t done = 0;
+        std::string block;
+        while (this->segment != nullptr && done < this->pending.size())
+        {
+            AuditBatch batch;
+            batch.mark = AUDIT_BATCH_MARK;
+            batch.count = (uint32_t)std::min(this->pending.size() - done, AUDIT_RING_CAPACITY);
+            batch.records = crc32c(reinterpret_cast<const char *>(&this->pending[done]), batch.count * sizeof(AuditRecord));
+            batch.checksum = crc32c(reinterpret_cast<const char *>(&batch), offsetof(AuditBatch, checksum));
+
+            block.assign(reinterpret_cast<const char *>(&batch), sizeof(batch));
+            block.append(reinterpret_cast<const char *>(&this->pending[done]), batch.count * sizeof(AuditRecord));
+            if (fwrite(block.data(), 1, block.size(), this->segment) != block.size())
+            {
+                fclose(this->segment);
+                this->segment = nullptr;
+                break;
+            }
+
+            done += batch.count;
+            this->segmentBytes += block.size();
+            if (this->segmentBytes >= AUDIT_SEGMENT_BYTES)
+            {
+                this->rotate();
+            }
+        }
+
+        this->pending.erase(this->pending.begin(), this->pending.begin() + done);
+        if (this->pending.size() > AUDIT_PENDING_LIMIT)
+        {
+            this->pending.erase(this->pending.begin(), this->pending.end() - AUDIT_PENDING_LIMIT);
+        }
+    }
+
+    void run()
+    {
+        while (!this->stopping.load())
+        {
+            {
+                std::unique_lock<std::mutex> guard(this->wakeLock);
+                this->wake.wait_for(guard, std::chrono::milliseconds(AUDIT_FLUSH_MS),
+                                    [this]
+                                    { return this->stopping.load(); });
+            }
+            this->drain();
+        }
+        this->drain();
+    }
+
+public:
+    AuditLog() : cells(new Cell[AUDIT_RING_CAPACITY]), enqueuePosition(0), dequeuePosition(0),
+                 stopping(false), segment(nullptr), segmentBytes(0), segmentNumber(0)
+    {
+        for (size_t i = 0; i < AUDIT_RING_CAPACITY; ++i)
+        {
+            this->cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        std::error_code ec;
+        fs::create_directory(AUDIT_DIR, ec);
+        std::vector<fs::path> segments = segmentFiles();
+        this->openSegment(segments.empty() ? 1 : std::strtoul(segments.back().stem().string().c_str(), nullptr, 10));
+
+        this->writer = std::thread([this]
+                                   { this->run(); });
+    }
+
+    ~AuditLog()
+    {
+        this->stopping.store(true);
+        this->wake.notify_one();
+        this->writer.join();
+        if (this->segment != nullptr)
+        {
+            fclose(this->segment);
+        }
+    }
+
+    AuditLog(const AuditLog &) = delete;
+    AuditLog &operator=(const AuditLog &) = delete;
+
+    /**
+     * @function record
+     *
+     * @description - Queues an audit record stamped with the current time.
+     *
+     * @param uint32_t action - One of the AUDIT_ constants.
+     * @param int actor - Id of the employee acting, 0 if unknown.
+     * @param int target - Id of the employee acted on.
+     *
+     * @return void
+     */
+    void record(uint32_t action, int actor, int target)
+    {
+        AuditRecord entry;
+        entry.timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::system_clock::now().time_since_epoch())
+                           .count();
+        entry.actor = actor;
+        entry.target = target;
+        entry.action = action;
+        entry.checksum = crc32c(reinterpret_cast<const char *>(&entry), offsetof(AuditRecord, checksum));
+
+        while (!this->tryPush(entry))
+        {
+            this->wake.notify_one();
+            std::this_thread::yield();
+        }
+    }
+
+    static const char *actionName(uint32_t action)
+    {
+        static const char *names[] = {"unknown", "login", "login-failed", "view", "edit", "remove", "restore"};
+        return names[action < sizeof(names) / sizeof(names[0]) ? action : 0];
+    }
+
+    /**
+     * @function query - static
+     *
+     * @description - Reads every segment, oldest first, and keeps the records matching the filter.
+     * A batch whose header or records fail their checksum, like one torn by a failed write, is
+     * skipped by searching forward for the next header that checks out. Old segments are read a
+     * record at a time, skipping a partial record at the end and records that fail their
+     * checksum. Segments with neither magic are skipped.
+     *
+     * @param AuditFilter filter - What to match.
+     *
+     * @return vector<AuditRecord> - The matching records, in the order they were written.
+     */
+    static std::vector<AuditRecord> query(const AuditFilter &filter)
+    {
+        std::vector<AuditRecord> matches;
+        auto keep = [&filter, &matches](const AuditRecord &r)
+        {
+            if (r.checksum != 0 &&
+                r.checksum != crc32c(reinterpret_cast<const char *>(&r), offsetof(AuditRecord, checksum)))
+            {
+                return;
+            }
+            if ((filter.actor == 0 || r.actor == filter.actor) &&
+                (filter.target == 0 || r.target == filter.target) &&
+                (filter.action == 0 || r.action == filter.action) &&
+                (filter.fromMs == 0 || r.timeMs >= filter.fromMs) &&
+                (filter.toMs == 0 || r.timeMs <= filter.toMs))
+            {
+                matches.push_back(r);
+            }
+        };
+
+        for (const fs::path &path : segmentFiles())
+        {
+            std::ifstream file(path, std::ios::binary);
+            std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            if (data.size() < sizeof(AUDIT_MAGIC))
+            {
+                continue;
+            }
+
+            AuditRecord r;
+            if (std::memcmp(data.data(), AUDIT_MAGIC_V1, sizeof(AUDIT_MAGIC_V1)) == 0)
+            {
+                for (size_t at = sizeof(AUDIT_MAGIC_V1); at + sizeof(r) <= data.size(); at += sizeof(r))
+                {
+                    std::memcpy(&r, data.data() + at, sizeof(r));
+                    keep(r);
+                }
+                continue;
+            }
+            if (std::memcmp(data.data(), AUDIT_MAGIC, sizeof(AUDIT_MAGIC)) != 0)
+            {
+                continue;
+            }
+
+            size_t at = sizeof(AUDIT_MAGIC);
+            while (at + sizeof(AuditBatch) <= data.size())
+            {
+                AuditBatch batch;
+                std::memcpy(&batch, data.data() + at, sizeof(batch));
+                size_t bytes = (size_t)batch.count * sizeof(AuditRecord);
+                const char *records = data.data() + at + sizeof(batch);
+                if (batch.mark != AUDIT_BATCH_MARK ||
+                    batch.checksum != crc32c(reinterpret_cast<const char *>(&batch), offsetof(AuditBatch, checksum)) ||
+                    batch.count == 0 || batch.count > AUDIT_RING_CAPACITY ||
+                    bytes > data.size() - at - sizeof(batch) || batch.records != crc32c(records, bytes))
+                {
+                    at++;
+                    continue;
+                }
+
+                for (size_t i = 0; i < batch.count; ++i)
+                {
+                    std::memcpy(&r, records + i * sizeof(r), sizeof(r));
+                    keep(r);
+                }
+                at += sizeof(batch) + bytes;
+            }
+        }
+
+        return matches;
+    }
+};
+
+/**
+ * @struct ArchivedEmployee
+ *
+ * @description - A removed employee kept in the archive.
+ *
+ * @prop employee Employee - The employee as it was when removed.
+ * @prop removedAt time_t - When it was removed.
+ */
+struct ArchivedEmployee
+{
+    Employee employee;
+    time_t removedAt = 0;
+};
+
+/**
+ * @class EmployeeArchive
+ *
+ * @description - Cold storage for removed employees, so a remove can be undone without keeping
+ * ex-employees in the store every search scans. The archive is a file of compressed blocks:
+ *  - ARCHIVE_BLOCK_MAGIC, then record count, raw size, compressed size, and blockChecksum as
+ *    uint32_t. Blocks written before checksums start with ARCHIVE_BLOCK_MAGIC_V1 and have no checksum.
+ *  - The compressed lines, each "<removed at> v<format> <record fields>".
+ *
+ * A remove appends a block holding just that employee. Restores and purges rewrite the archive,
+ * packing what is left into blocks of ARCHIVE_BLOCK_RECORDS, which compress far better. Nothing
+ * is read until the archive is first used, so starting up and active queries never pay for it.
+ * A block torn by a failed append is skipped, the blocks appended after it are still read.
+ *
+ * @method public add - Archives a removed employee.
+ * @method public find - Looks up an archived employee by id.
+ * @method public list - Every archived employee, by id.
+ * @method public take - Removes an employee from the archive to restore it.
+ * @method public purge - Drops employees removed before a point in time.
+ *
+ */
+class EmployeeArchive
+{
+    bool loaded;
+    std::map<int, ArchivedEmployee> entries;
+
+    static std::string encode(const ArchivedEmployee &entry)
+    {
+        std::string record = entry.employee.serialize();
+        std::ostringstream oss;
+        oss << entry.removedAt << " v" << RECORD_FORMAT_VERSION << " " << record.substr(record.find('\n') + 1);
+        return oss.str();
+    }
+
+    static bool appendBlock(FILE *file, const std::vector<const ArchivedEmployee *> &block)
+    {
+        std::string raw;
+        for (const ArchivedEmployee *entry : block)
+        {
+            raw += encode(*entry);
+        }
+        std::string compressed = lzCompress(raw);
+
+        uint32_t header[4] = {(uint32_t)block.size(), (uint32_t)raw.size(), (uint32_t)compressed.size(), 0};
+        header[3] = blockChecksum(header, compressed);
+        return fwrite(ARCHIVE_BLOCK_MAGIC, 1, sizeof(ARCHIVE_BLOCK_MAGIC), file) == sizeof(ARCHIVE_BLOCK_MAGIC) &&
+               fwrite(header, sizeof(header), 1, file) == 1 &&
+               fwrite(compressed.data(), 1, compressed.size(), file) == compressed.size();
+    }
+
+    /**
+     * @function load
+     *
+     * @description - Reads every block into memory the first time the archive is used. The
+     * checksum is checked before decompressing, and sizes are checked against what is left of the
+     * file. At a damaged or partly written block it looks for the next block magic after it and
+     * goes on from there.
+     *
+     * @return void
+     */
+    void load()
+    {
+        if (this->loaded)
+        {
+            return;
+        }
+        this->loaded = true;
+
+        std::ifstream file(EMPLOYEE_ARCHIVE, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        uint32_t header[4] = {0, 0, 0, 0};
+        size_t at = 0;
+        while (at + sizeof(ARCHIVE_BLOCK_MAGIC) <= data.size())
+        {
+            bool checked = std::memcmp(data.data() + at, ARCHIVE_BLOCK_MAGIC, sizeof(ARCHIVE_BLOCK_MAGIC)) == 0;
+            bool old = std::memcmp(data.data() + at, ARCHIVE_BLOCK_MAGIC_V1, sizeof(ARCHIVE_BLOCK_MAGIC_V1)) == 0;
+            size_t headerBytes = (checked ? 4 : 3) * sizeof(uint32_t);
+            size_t start = at + sizeof(ARCHIVE_BLOCK_MAGIC) + headerBytes;
+            std::string raw;
+            bool whole = (checked || old) && start <= data.size();
+            if (whole)
+            {
+                std::memcpy(header, data.data() + at + sizeof(ARCHIVE_BLOCK_MAGIC), headerBytes);
+                std::string compressed;
+                whole = header[2] <= data.size() - start;
+                if (whole)
+                {
+                    compressed = data.substr(start, header[2]);
+                    whole = (!checked || blockChecksum(header, compressed) == header[3]) &&
+                            lzDecompress(compressed, header[1], raw);
+                }
+            }
+            if (!whole)
+            {
+                size_t next = std::min(data.find(std::string(ARCHIVE_BLOCK_MAGIC, sizeof(ARCHIVE_BLOCK_MAGIC)), at + 1),
+                                       data.find(std::string(ARCHIVE_BLOCK_MAGIC_V1, sizeof(ARCHIVE_BLOCK_MAGIC_V1)), at + 1));
+                if (next == std::string::npos)
+                {
+                    break;
+                }
+                at = next;
+                continue;
+            }
+            at = start + header[2];
+
+            std::istringstream lines(raw);
+            std::string line;
+            while (getline(lines, line))
+            {
+                std::istringstream fields(line);
+                ArchivedEmployee entry;
+                std::string version, record;
+                fields >> entry.removedAt >> version;
+                getline(fields, record);
+                if (version.size() > 1 && Employee::parseRecord(record, std::atoi(version.c_str() + 1), &entry.employee))
+                {
+                    this->entries[entry.employee.id] = entry;
+                }
+            }
+        }
+    }
+
+    /**
+     * @function rewrite
+     *
+     * @description - Writes the archive again from memory, packed into full blocks, beside the old
+     * one and renamed over it. Caller holds the archive lock.
+     *
+     * @return bool - Returns true if the new archive is in place.
+     */
+    bool rewrite()
+    {
+        fs::path pending = EMPLOYEE_ARCHIVE;
+        pending += ".tmp";
+        FILE *file = writePrivate(pending);
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        bool written = true;
+        std::vector<const ArchivedEmployee *> block;
+        for (const auto &entry : this->entries)
+        {
+            block.push_back(&entry.second);
+            if (block.size() == ARCHIVE_BLOCK_RECORDS)
+            {
+                written = appendBlock(file, block) && written;
+                block.clear();
+            }
+        }
+        if (!block.empty())
+        {
+            written = appendBlock(file, block) && written;
+        }
+        written = syncFile(file) && written;
+        fclose(file);
+
+        std::error_code ec;
+        if (written)
+        {
+            fs::rename(pending, EMPLOYEE_ARCHIVE, ec);
+        }
+        if (!written || ec)
+        {
+            fs::remove(pending, ec);
+            return false;
+        }
+        return true;
+    }
+
+public:
+    EmployeeArchive() : loaded(false) {}
+
+    /**
+     * @function add
+     *
+     * @description - Appends a removed employee to the archive as its own block and waits for it
+     * to reach the disk, so the employee's file can be deleted after.
+     *
+     * @param Employee e - The employee being removed.
+     *
+     * @return bool - Returns true if the employee is safely archived.
+     */
+    bool add(const Employee &e)
+    {
+        ArchivedEmployee entry;
+        entry.employee = e;
+        entry.removedAt = std::time(nullptr);
+
+        if (!lockFile(EMPLOYEE_ARCHIVE_LOCK))
+        {
+            return false;
+        }
+        FILE *file = appendPrivate(EMPLOYEE_ARCHIVE);
+        bool written = file != nullptr && appendBlock(file, {&entry}) && syncFile(file);
+        if (file != nullptr)
+        {
+            fclose(file);
+        }
+        unlockFile(EMPLOYEE_ARCHIVE_LOCK);
+
+        if (written && this->loaded)
+        {
+            this->entries[e.id] = entry;
+        }
+        return written;
+    }
+
+    bool find(int id, ArchivedEmployee *entry)
+    {
+        this->load();
+        auto it = this->entries.find(id);
+        if (it == this->entries.end())
+        {
+            return false;
+        }
+        *entry = it->second;
+        return true;
+    }
+
+    std::vector<ArchivedEmployee> list()
+    {
+        this->load();
+        std::vector<ArchivedEmployee> out;
+        for (const auto &entry : this->entries)
+        {
+            out.push_back(entry.second);
+        }
+        return out;
+    }
+
+    /**
+     * @function take
+     *
+     * @description - Removes an employee from the archive, for restoring it to the store.
+     *
+     * @param int id - The id of the employee.
+     * @param ArchivedEmployee *entry - Set to the archived employee.
+     *
+     * @return bool - Returns false if the employee isn't archived or the archive couldn't be
+     * saved, the employee stays archived then.
+     */
+    bool take(int id, ArchivedEmployee *entry)
+    {
+        if (!lockFile(EMPLOYEE_ARCHIVE_LOCK))
+        {
+            return false;
+        }
+
+        // Read again under the lock, another session may have archived since.
+        this->loaded = false;
+        this->entries.clear();
+        this->load();
+
+        auto it = this->entries.find(id);
+        bool taken = it != this->entries.end();
+        if (taken)
+        {
+            *entry = it->second;
+            this->entries.erase(it);
+            taken = this->rewrite();
+            if (!taken)
+            {
+                this->loaded = false;
+                this->entries.clear();
+            }
+        }
+        unlockFile(EMPLOYEE_ARCHIVE_LOCK);
+        return taken;
+    }
+
+    /**
+     * @function purge
+     *
+     * @description - Permanently drops every employee removed before a point in time.
+     *
+     * @param time_t before - Employees removed earlier than this are dropped.
+     * @param size_t &dropped - Set to how many employees were dropped.
+     *
+     * @return bool - Returns false if the archive couldn't be rewritten, nothing was dropped then.
+     */
+    bool purge(time_t before, size_t &dropped)
+    {
+        dropped = 0;
+        if (!lockFile(EMPLOYEE_ARCHIVE_LOCK))
+        {
+            return false;
+        }
+
+        this->loaded = false;
+        this->entries.clear();
+        this->load();
+
+        for (auto it = this->entries.begin(); it != this->entries.end();)
+        {
+            if (it->second.removedAt < before)
+            {
+                it = this->entries.erase(it);
+                dropped++;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        // Rewriting even when nothing was dropped packs the single record blocks together.
+        bool written = this->rewrite();
+        if (!written)
+        {
+            // The old archive is still in place, read it again on next use.
+            this->loaded = false;
+            this->entries.clear();
+            dropped = 0;
+        }
+        unlockFile(EMPLOYEE_ARCHIVE_LOCK);
+        return written;
+    }
+};
+
+/**
+ * @struct PackBlock
+ *
+ * @description - Index entry for one block of the pack, written as these 32 bytes.
+ *
+ * @prop firstId int32_t - Lowest id in the block.
+ * @prop lastId int32_t - Highest id in the block.
+ * @prop offset uint64_t - Where the compressed block starts in the file.
+ * @prop count uint32_t - Records in the block.
+ * @prop rawSize uint32_t - Size of the block decompressed.
+ * @prop compressedSize uint32_t - Size of the block in the file.
+ * @prop checksum uint32_t - CRC32C of the compressed block.
+ */
+struct PackBlock
+{
+    int32_t firstId;
+    int32_t lastId;
+    uint64_t offset;
+    uint32_t count;
+    uint32_t rawSize;
+    uint32_t compressedSize;
+    uint32_t checksum;
+};
+
+static_assert(sizeof(PackBlock) == 32, "pack index entries are written as raw 32 byte blocks");
+
+/**
+ * @class PackStore
+ *
+ * @description - Read only, compressed copy of the employee files. Records are sorted by id and
+ * compressed in blocks of PACK_BLOCK_RECORDS with lzCompress, all sharing one dictionary trained
+ * on the first names, last names, departments, and username stems that repeat most. The file is:
+ *  - PACK_MAGIC, the dictionary size as uint32_t, and the dictionary.
+ *  - The compressed blocks, each holding lines of "v<format> <record fields>".
+ *  - The index, one PackBlock per block in id order.
+ *  - The index offset as uint64_t, the block count, and the CRC32C of dictionary and index.
+ *
+ * Opening reads only the dictionary and index. Looking up one employee reads and decompresses
+ * the one block whose id range holds it, found by binary search.
+ *
+ * @method public static trainDictionary - Builds a dictionary from the employees.
+ * @method public static write - Writes a pack of the employees.
+ * @method public open - Reads the dictionary and index, if there is a pack.
+ * @method public find - Reads one employee.
+ * @method public loadAll - Reads every employee, decompressing blocks in parallel.
+ * @method public decompressAll - Decompresses every block, for timing.
+ * @method public damagedBlocks - Checks every block against its checksum.
+ *
+ */
+class PackStore
+{
+    fs::path path;
+    bool present;
+    std::string dictionary;
+    std::vector<PackBlock> blocks;
+    uintmax_t fileSize;
+    fs::file_time_type modified;
+
+    bool decompressBlock(const PackBlock &block, const std::string &compressed, std::string &raw) const
+    {
+        return crc32c(compressed) == block.checksum && lzDecompress(compressed, block.rawSize, raw, this->dictionary);
+    }
+
+    static bool parseLine(const std::string &raw, size_t start, size_t end, Employee *e)
+    {
+        size_t space = raw.find(' ', start);
+        if (raw[start] != 'v' || space >= end ||
+            !Employee::parseRecord(raw.substr(space + 1, end - space - 1), std::atoi(raw.c_str() + start + 1), e))
+        {
+            return false;
+        }
+        e->file = EMPLOYEE_DIR / (std::to_string(e->id) + ".txt");
+        return true;
+    }
+
+    bool decodeBlock(const PackBlock &block, const std::string &compressed, std::vector<Employee> &out) const
+    {
+        std::string raw;
+        if (!this->decompressBlock(block, compressed, raw))
+        {
+            return false;
+        }
+
+        size_t start = 0;
+        for (uint32_t i = 0; i < block.count; ++i)
+        {
+            size_t end = raw.find('\n', start);
+            Employee e;
+            if (end == std::string::npos || !parseLine(raw, start, end, &e))
+            {
+                return false;
+            }
+            out.push_back(std::move(e));
+            start = end + 1;
+        }
+        return true;
+    }
+
+    bool readBlock(std::ifstream &file, const PackBlock &block, std::string &compressed) const
+    {
+        compressed.resize(block.compressedSize);
+        file.seekg(block.offset);
+        return (bool)file.read(&compressed[0], compressed.size());
+    }
+
+    /**
+     * @function refresh
+     *
+     * @description - Opens the pack again if it was rewritten since it was opened.
+     *
+     * @return void
+     */
+    void refresh()
+    {
+        std::error_code ec;
+        uintmax_t size = fs::file_size(this->path, ec);
+        if (ec ? this->present : size != this->fileSize || fs::last_write_time(this->path, ec) != this->modified)
+        {
+            this->open();
+        }
+    }
+
+public:
+    PackStore(const fs::path &file = EMPLOYEE_PACK) : path(file), present(false), fileSize(0) {}
+
+    bool isPresent() const { return this->present; }
+
+    size_t blockCount() const { return this->blocks.size(); }
+
+    /**
+     * @function trainDictionary - static
+     *
+     * @description - Picks the name fragments that would save the most if every block could
+     * point at them: each repeating first name, last name, department, and username without its
+     * digits, with the spaces around it, scored by count times length. The best are placed at
+     * the end of the dictionary, nearest the block.
+     *
+     * @param vector<Employee> employees - The employees to train on.
+     *
+     * @return string - The dictionary, at most PACK_DICTIONARY_BYTES.
+     */
+    static std::string trainDictionary(const std::vector<Employee> &employees)
+    {
+        std::unordered_map<std::string, size_t> counts;
+        for (const Employee &e : employees)
+        {
+            const std::string stem = e.username.substr(0, e.username.find_last_not_of("0123456789") + 1);
+            for (const std::string *fragment : {&e.firstName, &e.lastName, &e.department, &stem})
+            {
+                if (fragment->size() >= 2)
+                {
+                    counts[" " + *fragment + " "]++;
+                }
+            }
+        }
+
+        std::vector<std::pair<size_t, std::string>> scored;
+        for (const auto &entry : counts)
+        {
+            if (entry.second > 1)
+            {
+                scored.emplace_back(entry.second * entry.first.size(), entry.first);
+            }
+        }
+        std::sort(scored.begin(), scored.end(), std::greater<std::pair<size_t, std::string>>());
+
+        std::vector<const std::string *> picked;
+        size_t bytes = 0;
+        for (const auto &entry : scored)
+        {
+            if (bytes + entry.second.size() > PACK_DICTIONARY_BYTES)
+            {
+                continue;
+            }
+            bytes += entry.second.size();
+            picked.push_back(&entry.second);
+        }
+
+        std::string dictionary;
+        dictionary.reserve(bytes);
+        for (auto it = picked.rbegin(); it != picked.rend(); ++it)
+        {
+            dictionary += **it;
+        }
+        return dictionary;
+    }
+
+    /**
+     * @function write - static
+     *
+     * @description - Writes a pack of the employees beside the target, syncs it, and renames it
+     * over the target.
+     *
+     * @param vector<Employee> employees - The employees to pack, in any order.
+     * @param path target - Where to write the pack.
+     * @param bool useDictionary - False to compress without a dictionary, for comparing.
+     *
+     * @return bool - Returns true if the pack is in place.
+     */
+    static bool write(std::vector<Employee> employees, const fs::path &target, bool useDictionary = true)
+    {
+        std::sort(employees.begin(), employees.end(), [](const Employee &a, const Employee &b)
+                  { return a.id < b.id; });
+        std::string dictionary = useDictionary ? trainDictionary(employees) : std::string();
+
+        fs::path pending = target;
+        pending += ".tmp";
+        FILE *file = writePrivate(pending);
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        uint32_t dictionarySize = (uint32_t)dictionary.size();
+        bool written = fwrite(PACK_MAGIC, 1, sizeof(PACK_MAGIC), file) == sizeof(PACK_MAGIC) &&
+                       fwrite(&dictionarySize, sizeof(dictionarySize), 1, file) == 1 &&
+                       fwrite(dictionary.data(), 1, dictionary.size(), file) == dictionary.size();
+
+        std::vector<PackBlock> index;
+        uint64_t offset = sizeof(PACK_MAGIC) + sizeof(dictionarySize) + dictionary.size();
+        for (size_t first = 0; written && first < employees.size(); first += PACK_BLOCK_RECORDS)
+        {
+            size_t last = std::min(employees.size(), first + PACK_BLOCK_RECORDS);
+            std::string raw;
+            for (size_t i = first; i < last; ++i)
+            {
+                std::string record = employees[i].serialize();
+                raw += "v" + std::to_string(RECORD_FORMAT_VERSION) + " " + record.substr(record.find('\n') + 1);
+            }
+            std::string compressed = lzCompress(raw, dictionary);
+
+            PackBlock block;
+            block.firstId = employees[first].id;
+            block.lastId = employees[last - 1].id;
+            block.offset = offset;
+            block.count = (uint32_t)(last - first);
+            block.rawSize = (uint32_t)raw.size();
+            block.compressedSize = (uint32_t)compressed.size();
+            block.checksum = crc32c(compressed);
+            index.push_back(block);
+
+            written = fwrite(compressed.data(), 1, compressed.size(), file) == compressed.size();
+            offset += compressed.size();
+        }
+
+        uint32_t trailer[2] = {(uint32_t)index.size(), 0};
+        trailer[1] = crc32c(reinterpret_cast<const char *>(index.data()), index.size() * sizeof(PackBlock),
+                            crc32c(dictionary));
+        written = written && fwrite(index.data(), sizeof(PackBlock), index.size(), file) == index.size() &&
+                  fwrite(&offset, sizeof(offset), 1, file) == 1 && fwrite(trailer, sizeof(trailer), 1, file) == 1;
+        written = syncFile(file) && written;
+        fclose(file);
+
+        std::error_code ec;
+        if (written)
+        {
+            fs::rename(pending, target, ec);
+        }
+        else
+        {
+            fs::remove(pending, ec);
+        }
+        return written && !ec;
+    }
+
+    /**
+     * @function open
+     *
+     * @description - Reads the dictionary and index of the pack. A pack that fails its checksum
+     * is treated as missing.
+     *
+     * @return bool - Returns true if there is a usable pack.
+     */
+    bool open()
+    {
+        this->present = false;
+        this->dictionary.clear();
+        this->blocks.clear();
+
+        std::error_code ec;
+        this->fileSize = fs::file_size(this->path, ec);
+        this->modified = fs::last_write_time(this->path, ec);
+        std::ifstream file(this->path, std::ios::binary);
+        char magic[sizeof(PACK_MAGIC)];
+        uint32_t dictionarySize;
+        if (ec || this->fileSize < 24 || !file.read(magic, sizeof(magic)) ||
+            std::memcmp(magic, PACK_MAGIC, sizeof(magic)) != 0 ||
+            !file.read(reinterpret_cast<char *>(&dictionarySize), sizeof(dictionarySize)) ||
+            dictionarySize > this->fileSize)
+        {
+            return false;
+        }
+        this->dictionary.resize(dictionarySize);
+        file.read(&this->dictionary[0], dictionarySize);
+
+        uint64_t indexOffset;
+        uint32_t trailer[2];
+        file.seekg(this->fileSize - sizeof(indexOffset) - sizeof(trailer));
+        if (!file.read(reinterpret_cast<char *>(&indexOffset), sizeof(indexOffset)) ||
+            !file.read(reinterpret_cast<char *>(trailer), sizeof(trailer)) ||
+            indexOffset + (uint64_t)trailer[0] * sizeof(PackBlock) + 16 != this->fileSize)
+        {
+            return false;
+        }
+
+        this->blocks.resize(trailer[0]);
+        file.seekg(indexOffset);
+        if (!file.read(reinterpret_cast<char *>(this->blocks.data()), this->blocks.size() * sizeof(PackBlock)) ||
+            crc32c(reinterpret_cast<const char *>(this->blocks.data()), this->blocks.size() * sizeof(PackBlock),
+                   crc32c(this->dictionary)) != trailer[1])
+        {
+            this->blocks.clear();
+            this->dictionary.clear();
+            return false;
+        }
+
+        this->present = true;
+        return true;
+    }
+
+    /**
+     * @function find
+     *
+     * @description - Reads one employee from the pack, opening it again first if it was rewritten.
+     *
+     * @param int id - The id of the employee.
+     * @param Employee *employee - Set to the employee, if found.
+     *
+     * @return bool - Returns true if the pack holds the employee.
+     */
+    bool find(int id, Employee *employee)
+    {
+        this->refresh();
+        auto block = std::lower_bound(this->blocks.begin(), this->blocks.end(), id,
+                                      [](const PackBlock &b, int value)
+                                      { return b.lastId < value; });
+        if (block == this->blocks.end() || block->firstId > id)
+        {
+            return false;
+        }
+
+        std::ifstream file(this->path, std::ios::binary);
+        std::string compressed, raw;
+        if (!this->readBlock(file, *block, compressed) || !this->decompressBlock(*block, compressed, raw))
+        {
+            return false;
+        }
+
+        // Only the line with the id is parsed, the id is the first field after the version.
+        for (size_t start = 0; start < raw.size();)
+        {
+            size_t end = raw.find('\n', start);
+            if (end == std::string::npos)
+            {
+                break;
+            }
+            size_t space = raw.find(' ', start);
+            if (space < end && std::atoi(raw.c_str() + space + 1) == id)
+            {
+                return parseLine(raw, start, end, employee);
+            }
+            start = end + 1;
+        }
+        return false;
+    }
+
+    /**
+     * @function loadAll
+     *
+     * @description - Reads every employee in the pack. The file is read in one go and the blocks
+     * decompressed in parallel on the pool.
+     *
+     * @param TaskPool &pool - The pool to decompress on.
+     * @param vector<Employee> &out - Set to the employees, in id order.
+     *
+     * @return bool - Returns false if any block is damaged.
+     */
+    bool loadAll(TaskPool &pool, std::vector<Employee> &out)
+    {
+        out.clear();
+        if (!this->present)
+        {
+            return true;
+        }
+
+        std::ifstream file(this->path, std::ios::binary);
+        std::string contents(this->fileSize, '\0');
+        if (!file.read(&contents[0], contents.size()))
+        {
+            return false;
+        }
+
+        std::vector<std::vector<Employee>> decoded(this->blocks.size());
+        std::atomic<bool> intact(true);
+        pool.parallelFor(0, this->blocks.size(), 4, [&](size_t lo, size_t hi)
+                         {
+            for (size_t i = lo; i < hi; ++i)
+            {
+                const PackBlock &block = this->blocks[i];
+                if (block.offset + block.compressedSize > contents.size() ||
+                    !this->decodeBlock(block, contents.substr(block.offset, block.compressedSize), decoded[i]))
+                {
+                    intact.store(false);
+                }
+            } });
+
+        for (std::vector<Employee> &block : decoded)
+        {
+            out.insert(out.end(), std::make_move_iterator(block.begin()), std::make_move_iterator(block.end()));
+        }
+        return intact.load();
+    }
+
+    /**
+     * @function decompressAll
+     *
+     * @description - Decompresses every block without parsing the records, for timing the codec.
+     *
+     * @return size_t - Bytes decompressed, 0 if a block is damaged.
+     */
+    size_t decompressAll()
+    {
+        std::ifstream file(this->path, std::ios::binary);
+        std::string compressed, raw;
+        size_t total = 0;
+        for (const PackBlock &block : this->blocks)
+        {
+            if (!this->readBlock(file, block, compressed) || !this->decompressBlock(block, compressed, raw))
+            {
+                return 0;
+            }
+            total += raw.size();
+        }
+        return total;
+    }
+
+    /**
+     * @function damagedBlocks
+     *
+     * @description - Reads every block and checks it decompresses to what its index entry says.
+     *
+     * @return vector<size_t> - The numbers of the damaged blocks.
+     */
+    std::vector<size_t> damagedBlocks()
+    {
+        std::vector<size_t> damaged;
+        std::ifstream file(this->path, std::ios::binary);
+        std::string compressed;
+        for (size_t i = 0; i < this->blocks.size(); ++i)
+        {
+            std::vector<Employee> decoded;
+            if (!this->readBlock(file, this->blocks[i], compressed) || !this->decodeBlock(this->blocks[i], compressed, decoded))
+            {
+                file.clear();
+                damaged.push_back(i);
+            }
+        }
+        return damaged;
+    }
+};
+
+#if defined SHARED_STORE_POSIX
+/**
+ * @struct SharedHeader
+ *
+ * @description - Start of the shared store's segment. Everything after it is found by offsets
+ * from the start of the segment, never pointers, since each process maps it at its own address.
+ *
+ * @prop magic char[4] - SHARED_STORE_MAGIC, written last so a half built segment isn't used.
+ * @prop layout uint32_t - sizeof(SharedHeader), so a different build's segment isn't misread.
+ * @prop sequence atomic<uint64_t> - Seqlock, odd while the writer is changing the segment.
+ * @prop retired atomic<uint32_t> - Set once the writer has stopped or replaced the segment.
+ * @prop writer int32_t - Process id of the writer.
+ * @prop capacity uint32_t - Slots and names there is room for.
+ * @prop count uint32_t - Slots and names in use.
+ * @prop slotsOffset uint64_t - Where the SharedSlot array starts, sorted by id.
+ * @prop namesOffset uint64_t - Where the SharedName array starts, sorted by hash then id.
+ * @prop heapOffset uint64_t - Where the record lines start.
+ * @prop heapSize uint64_t - Bytes of room for record lines.
+ * @prop heapUsed uint64_t - Bytes of that handed out so far.
+ */
+struct SharedHeader
+{
+    char magic[4];
+    uint32_t layout;
+    std::atomic<uint64_t> sequence;
+    std::atomic<uint32_t> retired;
+    int32_t writer;
+    uint32_t capacity;
+    uint32_t count;
+    uint64_t slotsOffset;
+    uint64_t namesOffset;
+    uint64_t heapOffset;
+    uint64_t heapSize;
+    uint64_t heapUsed;
+};
+
+/**
+ * @struct SharedSlot
+ *
+ * @description - One employee in the shared store.
+ *
+ * @prop id int32_t - Id of the employee.
+ * @prop length uint32_t - Length of the record line.
+ * @prop room uint32_t - Bytes the line may grow to before it has to move.
+ * @prop nameHash uint32_t - CRC32C of the folded username, to find its SharedName.
+ * @prop offset uint64_t - Where the record line starts, from the start of the heap.
+ */
+struct SharedSlot
+{
+    int32_t id;
+    uint32_t length;
+    uint32_t room;
+    uint32_t nameHash;
+    uint64_t offset;
+};
+
+struct SharedName
+{
+    uint32_t hash;
+    int32_t id;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "the seqlock is shared between processes, so it can't be a hidden lock");
+
+volatile sig_atomic_t sharingStopped = 0;
+
+void stopSharing(int)
+{
+    sharingStopped = 1;
+}
+
+/**
+ * @class SharedStore
+ *
+ * @description - The employees in a POSIX shared memory segment, named for the employee
+ * directory, so processes on the host can look employees up without loading the files or
+ * keeping their own copy. One process, started with --share, creates the segment and changes it
+ * in place; any number of others attach to it read only, which is one shm_open and mmap.
+ *
+ * Each employee is a SharedSlot pointing at its record line in the heap, in the format of the
+ * employee files, with slack after it so small edits are written over the old line. Slots are
+ * sorted by id and names by username hash, so both lookups are binary searches.
+ *
+ * Writes are bracketed by the seqlock in the header: the sequence is odd while a write is under
+ * way. Readers copy what they need out, then check the sequence is still the even value they
+ * started with, and try again if not, so they never block the writer or each other. When the
+ * writer runs out of slots or heap it builds a new, larger segment under the same name and
+ * marks the old one retired; readers of a retired segment find nothing and should attach again.
+ * The records hold passwords, so the segment is created readable only by its owner, and only
+ * sessions run by the same user can attach.
+ *
+ * @method public static segmentName - The name of the segment for this employee directory.
+ * @method public create - Builds a new segment from the employees, as its writer.
+ * @method public attach - Maps the current segment read only.
+ * @method public put - Adds or replaces an employee, as the writer.
+ * @method public remove - Drops an employee, as the writer.
+ * @method public find - Reads one employee by id.
+ * @method public findUsername - Reads one employee by username.
+ * @method public ids - The ids of every employee.
+ *
+ */
+class SharedStore
+{
+    int fd;
+    char *base;
+    size_t size;
+    bool writable;
+
+    SharedHeader *header() const { return reinterpret_cast<SharedHeader *>(this->base); }
+    SharedSlot *slots() const { return reinterpret_cast<SharedSlot *>(this->base + this->header()->slotsOffset); }
+    SharedName *names() const { return reinterpret_cast<SharedName *>(this->base + this->header()->namesOffset); }
+    char *heap() const { return this->base + this->header()->heapOffset; }
+
+    static std::string recordLine(const Employee &e)
+    {
+        // The record line is the second line of the employee's file contents.
+        std::string contents = e.serialize();
+        size_t start = contents.find('\n') + 1;
+        return contents.substr(start, contents.size() - start - 1);
+    }
+
+    size_t slotAt(int id, uint32_t count) const
+    {
+        SharedSlot *slots = this->slots();
+        return std::lower_bound(slots, slots + count, id, [](const SharedSlot &slot, int value)
+                                { return slot.id < value; }) -
+               slots;
+    }
+
+    static bool nameBefore(const SharedName &a, const SharedName &b)
+    {
+        return a.hash < b.hash || (a.hash == b.hash && a.id < b.id);
+    }
+
+    size_t nameAt(uint32_t hash, int id, uint32_t count) const
+    {
+        return std::lower_bound(this->names(), this->names() + count, SharedName{hash, id}, nameBefore) - this->names();
+    }
+
+    void insertName(uint32_t hash, int id, uint32_t count)
+    {
+        size_t at = this->nameAt(hash, id, count);
+        std::memmove(this->names() + at + 1, this->names() + at, (count - at) * sizeof(SharedName));
+        this->names()[at] = SharedName{hash, id};
+    }
+
+    void removeName(uint32_t hash, int id, uint32_t count)
+    {
+        size_t at = this->nameAt(hash, id, count);
+        if (at < count && this->names()[at].id == id)
+        {
+            std::memmove(this->names() + at, this->names() + at + 1, (count - at - 1) * sizeof(SharedName));
+        }
+    }
+
+    void beginWrite()
+    {
+        SharedHeader *h = this->header();
+        h->sequence.store(h->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void endWrite()
+    {
+        SharedHeader *h = this->header();
+        h->sequence.store(h->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @function consistent
+     *
+     * @description - Runs a read of the segment until it sees no write in the middle of it. The
+     * read must only copy out of the segment, and must not trust offsets it reads to be in
+     * bounds until it has been checked, since a torn read can see anything.
+     *
+     * @param Read read - The read, returning whether it found what it looked for.
+     *
+     * @return bool - What the last, whole read returned, or false if nothing is attached, the
+     * segment is retired, or a write never finished.
+     */
+    template <typename Read>
+    bool consistent(Read read) const
+    {
+        if (this->base == nullptr)
+        {
+            return false;
+        }
+
+        const SharedHeader *h = this->header();
+        for (int attempt = 0; attempt < SHARED_READ_ATTEMPTS; ++attempt)
+        {
+            uint64_t before = h->sequence.load(std::memory_order_acquire);
+            if (h->retired.load(std::memory_order_relaxed) != 0)
+            {
+                return false;
+            }
+            if (before % 2 == 0)
+            {
+                bool found = read();
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (h->sequence.load(std::memory_order_relaxed) == before)
+                {
+                    return found;
+                }
+            }
+            std::this_thread::yield();
+        }
+        return false;
+    }
+
+    bool readLine(size_t at, uint32_t count, std::string &line) const
+    {
+        if (at >= count)
+        {
+            return false;
+        }
+        SharedSlot slot = this->slots()[at];
+        if (slot.offset + slot.length > this->header()->heapSize)
+        {
+            return false;
+        }
+        line.assign(this->heap() + slot.offset, slot.length);
+        return true;
+    }
+
+    void close()
+    {
+        if (this->base != nullptr)
+        {
+            if (this->writable)
+            {
+                this->header()->retired.store(1, std::memory_order_release);
+                shm_unlink(segmentName().c_str());
+            }
+            munmap(this->base, this->size);
+        }
+        if (this->fd >= 0)
+        {
+            ::close(this->fd);
+        }
+        this->fd = -1;
+        this->base = nullptr;
+        this->size = 0;
+        this->writable = false;
+    }
+
+public:
+    SharedStore() : fd(-1), base(nullptr), size(0), writable(false) {}
+
+    ~SharedStore()
+    {
+        this->close();
+    }
+
+    SharedStore(const SharedStore &) = delete;
+    SharedStore &operator=(const SharedStore &) = delete;
+
+    /**
+     * @function segmentName - static
+     *
+     * @description - The segment is named for the absolute path of the employee directory, so
+     * stores in different directories don't share one.
+     *
+     * @return string - The name for shm_open.
+     */
+    static std::string segmentName()
+    {
+        std::error_code ec;
+        char name[32];
+        std::snprintf(name, sizeof(name), "/employees-%08x", crc32c(fs::absolute(EMPLOYEE_DIR, ec).string()));
+        return name;
+    }
+
+    /**
+     * @function create
+     *
+     * @description - Builds a new segment holding the employees, with room for twice as many,
+     * and becomes its writer. Replaces a segment this store already writes, or one left by a
+     * writer that has exited, but not one another running process writes.
+     *
+     * @param vector<Employee> employees - The employees.
+     * @param string &error - Set to why the segment couldn't be built.
+     *
+     * @return bool - Returns true if the segment was built.
+     */
+    bool create(const std::vector<Employee> &employees, std::string &error)
+    {
+        if (!this->writable)
+        {
+            SharedStore existing;
+            std::string ignored;
+            if (existing.attach(ignored) && existing.header()->writer != getpid() && kill(existing.header()->writer, 0) == 0)
+            {
+                error = "Process " + std::to_string(existing.header()->writer) + " is already sharing the employees.";
+                return false;
+            }
+        }
+
+        std::vector<const Employee *> sorted;
+        for (const Employee &e : employees)
+        {
+            sorted.push_back(&e);
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const Employee *a, const Employee *b)
+                  { return a->id < b->id; });
+
+        std::vector<std::string> lines;
+        uint64_t bytes = 0;
+        for (const Employee *e : sorted)
+        {
+            lines.push_back(recordLine(*e));
+            bytes += lines.back().size() + SHARED_RECORD_SLACK;
+        }
+
+        uint32_t capacity = std::max<uint32_t>(SHARED_MIN_SLOTS, employees.size() * 2);
+        uint64_t slotsOffset = (sizeof(SharedHeader) + 63) / 64 * 64;
+        uint64_t namesOffset = slotsOffset + capacity * sizeof(SharedSlot);
+        uint64_t heapOffset = namesOffset + capacity * sizeof(SharedName);
+        uint64_t heapSize = std::max<uint64_t>(bytes * 2, capacity * 128);
+
+        this->close();
+        std::string name = segmentName();
+        shm_unlink(name.c_str());
+        this->fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        this->size = heapOffset + heapSize;
+        if (this->fd < 0 || ftruncate(this->fd, this->size) != 0)
+        {
+            error = std::string("Could not create shared memory: ") + std::strerror(errno);
+            shm_unlink(name.c_str());
+            this->close();
+            return false;
+        }
+        void *mapped = mmap(nullptr, this->size, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+        if (mapped == MAP_FAILED)
+        {
+            error = std::string("Could not map shared memory: ") + std::strerror(errno);
+            shm_unlink(name.c_str());
+            this->close();
+            return false;
+        }
+        this->base = static_cast<char *>(mapped);
+        this->writable = true;
+
+        SharedHeader *h = new (this->base) SharedHeader();
+        h->layout = sizeof(SharedHeader);
+        h->writer = getpid();
+        h->capacity = capacity;
+        h->slotsOffset = slotsOffset;
+        h->namesOffset = namesOffset;
+        h->heapOffset = heapOffset;
+        h->heapSize = heapSize;
+
+        for (size_t i = 0; i < lines.size(); ++i)
+        {
+            uint32_t hash = crc32c(foldKey(sorted[i]->username));
+            uint32_t room = lines[i].size() + SHARED_RECORD_SLACK;
+            this->slots()[i] = SharedSlot{sorted[i]->id, (uint32_t)lines[i].size(), room, hash, h->heapUsed};
+            std::memcpy(this->heap() + h->heapUsed, lines[i].data(), lines[i].size());
+            h->heapUsed += room;
+            this->names()[i] = SharedName{hash, sorted[i]->id};
+        }
+        std::sort(this->names(), this->names() + lines.size(), nameBefore);
+        h->count = lines.size();
+
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(h->magic, SHARED_STORE_MAGIC, sizeof(h->magic));
+        return true;
+    }
+
+    /**
+     * @function attach
+     *
+     * @description - Maps the current segment read only.
+     *
+     * @param string &error - Set to why it couldn't be.
+     *
+     * @return bool - Returns true if a whole, current segment was mapped.
+     */
+    bool attach(std::string &error)
+    {
+        this->close();
+        this->fd = shm_open(segmentName().c_str(), O_RDONLY, 0);
+        struct stat status;
+        if (this->fd < 0 || fstat(this->fd, &status) != 0 || (size_t)status.st_size < sizeof(SharedHeader))
+        {
+            error = "No process is sharing the employees, start one with --share.";
+            this->close();
+            return false;
+        }
+
+        this->size = status.st_size;
+        void *mapped = mmap(nullptr, this->size, PROT_READ, MAP_SHARED, this->fd, 0);
+        if (mapped == MAP_FAILED)
+        {
+            error = std::string("Could not map shared memory: ") + std::strerror(errno);
+            this->size = 0;
+            this->close();
+            return false;
+        }
+        this->base = static_cast<char *>(mapped);
+
+        const SharedHeader *h = this->header();
+        bool whole = std::memcmp(h->magic, SHARED_STORE_MAGIC, sizeof(h->magic)) == 0;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (!whole || h->layout != sizeof(SharedHeader) || h->heapOffset + h->heapSize > this->size ||
+            h->retired.load(std::memory_order_acquire) != 0)
+        {
+            error = "The shared employees are being rebuilt, try again.";
+            this->close();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @function put
+     *
+     * @description - Adds an employee, or replaces the one with its id. The record line is
+     * written over the old one if it fits in its room, otherwise at the end of the heap.
+     *
+     * @param Employee e - The employee.
+     *
+     * @return bool - Returns false if the segment is out of slots or heap, and needs building again.
+     */
+    bool put(const Employee &e)
+    {
+        SharedHeader *h = this->header();
+        std::string line = recordLine(e);
+        uint32_t hash = crc32c(foldKey(e.username));
+        size_t at = this->slotAt(e.id, h->count);
+        bool exists = at < h->count && this->slots()[at].id == e.id;
+        bool moves = !exists || line.size() > this->slots()[at].room;
+        if ((!exists && h->count == h->capacity) || (moves && h->heapUsed + line.size() + SHARED_RECORD_SLACK > h->heapSize))
+        {
+            return false;
+        }
+
+        this->beginWrite();
+        if (!exists)
+        {
+            std::memmove(this->slots() + at + 1, this->slots() + at, (h->count - at) * sizeof(SharedSlot));
+            this->slots()[at] = SharedSlot{e.id, 0, 0, hash, 0};
+            this->insertName(hash, e.id, h->count);
+            ++h->count;
+        }
+        else if (this->slots()[at].nameHash != hash)
+        {
+            this->removeName(this->slots()[at].nameHash, e.id, h->count);
+            this->insertName(hash, e.id, h->count - 1);
+        }
+
+        SharedSlot &slot = this->slots()[at];
+        if (moves)
+        {
+            slot.offset = h->heapUsed;
+            slot.room = line.size() + SHARED_RECORD_SLACK;
+            h->heapUsed += slot.room;
+        }
+        std::memcpy(this->heap() + slot.offset, line.data(), line.size());
+        slot.length = line.size();
+        slot.nameHash = hash;
+        this->endWrite();
+        return true;
+    }
+
+    /**
+     * @function remove
+     *
+     * @description - Drops an employee. Its record line's heap is only reclaimed when the
+     * segment is built again.
+     *
+     * @param int id - The id of the employee.
+     *
+     * @return bool - Returns true, there is always room to remove.
+     */
+    bool remove(int id)
+    {
+        SharedHeader *h = this->header();
+        size_t at = this->slotAt(id, h->count);
+        if (at >= h->count || this->slots()[at].id != id)
+        {
+            return true;
+        }
+
+        this->beginWrite();
+        this->removeName(this->slots()[at].nameHash, id, h->count);
+        std::memmove(this->slots() + at, this->slots() + at + 1, (h->count - at - 1) * sizeof(SharedSlot));
+        --h->count;
+        this->endWrite();
+        return true;
+    }
+
+    /**
+     * @function find
+     *
+     * @description - Reads one employee by id.
+     *
+     * @param int id - The id of the employee.
+     * @param Employee *employee - Set to the employee, if found.
+     *
+     * @return bool - Returns true if the store holds the employee.
+     */
+    bool find(int id, Employee *employee) const
+    {
+        std::string line;
+        bool found = this->consistent([&]
+                                      {
+            uint32_t count = std::min(this->header()->count, this->header()->capacity);
+            return this->readLine(this->slotAt(id, count), count, line) && std::atoi(line.c_str()) == id; });
+        if (!found || !Employee::parseRecord(line, RECORD_FORMAT_VERSION, employee))
+        {
+            return false;
+        }
+        employee->file = EMPLOYEE_DIR / (std::to_string(employee->id) + ".txt");
+        return true;
+    }
+
+    /**
+     * @function findUsername
+     *
+     * @description - Reads one employee by username, matched by folded key like logins are, so
+     * case and Unicode forms don't matter.
+     *
+     * @param string username - The username.
+     * @param Employee *employee - Set to the employee, if found.
+     *
+     * @return bool - Returns true if the store holds an employee with the username.
+     */
+    bool findUsername(const std::string &username, Employee *employee) const
+    {
+        std::string key = foldKey(username);
+        uint32_t hash = crc32c(key);
+        std::vector<std::string> candidates;
+        this->consistent([&]
+                         {
+            candidates.clear();
+            uint32_t count = std::min(this->header()->count, this->header()->capacity);
+            for (size_t at = this->nameAt(hash, INT_MIN, count); at < count && this->names()[at].hash == hash; ++at)
+            {
+                std::string line;
+                if (this->readLine(this->slotAt(this->names()[at].id, count), count, line))
+                {
+                    candidates.push_back(std::move(line));
+                }
+            }
+            return true; });
+
+        // Different usernames can share a hash, so the match is checked on the parsed record.
+        for (const std::string &line : candidates)
+        {
+            if (Employee::parseRecord(line, RECORD_FORMAT_VERSION, employee) && foldKey(employee->username) == key)
+            {
+                employee->file = EMPLOYEE_DIR / (std::to_string(employee->id) + ".txt");
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @function ids
+     *
+     * @description - The ids of every employee in the store.
+     *
+     * @return vector<int> - The ids, in order.
+     */
+    std::vector<int> ids() const
+    {
+        std::vector<int> out;
+        this->consistent([&]
+                         {
+            uint32_t count = std::min(this->header()->count, this->header()->capacity);
+            out.resize(count);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                out[i] = this->slots()[i].id;
+            }
+            return true; });
+        return out;
+    }
+};
+#endif
+
+/**
+ * @function writeBackup
+ *
+ * @description - Writes every employee in a snapshot to a backup file, compressed in blocks of
+ * BACKUP_BLOCK_RECORDS. The file is written beside the target and renamed over it once synced,
+ * so a backup file is always complete. It holds passwords, so it is readable only by its owner.
+ * Reads only the snapshot, so it can run on any thread while employees are being saved.
+ *
+ * @param Snapshot &snapshot - The pinned store to back up.
+ * @param unsigned long sequence - The change sequence the snapshot reflects.
+ * @param path target - Where to write the backup.
+ *
+ * @return bool - Returns true if the backup is in place.
+ */
+bool writeBackup(const SnapshotStore::Snapshot &snapshot, unsigned long sequence, const fs::path &target)
+{
+    fs::path pending = target;
+    pending += ".tmp";
+    FILE *file = writePrivate(pending);
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    uint64_t header[2] = {sequence, snapshot.size()};
+    bool written = fwrite(BACKUP_FILE_MAGIC, 1, sizeof(BACKUP_FILE_MAGIC), file) == sizeof(BACKUP_FILE_MAGIC) &&
+                   fwrite(header, sizeof(header), 1, file) == 1;
+
+    for (size_t first = 0; written && first < snapshot.size(); first += BACKUP_BLOCK_RECORDS)
+    {
+        size_t last = std::min(snapshot.size(), first + BACKUP_BLOCK_RECORDS);
+        std::string raw;
+        for (size_t row = first; row < last; ++row)
+        {
+            std::string record = snapshot.at(row)->employee.serialize();
+            raw += "v" + std::to_string(RECORD_FORMAT_VERSION) + " " + record.substr(record.find('\n') + 1);
+        }
+        std::string compressed = lzCompress(raw);
+
+        uint32_t block[4] = {(uint32_t)(last - first), (uint32_t)raw.size(), (uint32_t)compressed.size(), 0};
+        block[3] = blockChecksum(block, compressed);
+        written = fwrite(block, sizeof(block), 1, file) == 1 &&
+                  fwrite(compressed.data(), 1, compressed.size(), file) == compressed.size();
+    }
+    written = syncFile(file) && written;
+    fclose(file);
+
+    std::error_code ec;
+    if (written)
+    {
+        fs::rename(pending, target, ec);
+    }
+    else
+    {
+        fs::remove(pending, ec);
+    }
+    return written && !ec;
+}
+
+/**
+ * @function readBackup
+ *
+ * @description - Reads every employee from a backup file. Fails if a block fails its checksum
+ * or the file holds fewer records than its header says.
+ *
+ * @param path source - The backup file.
+ * @param vector<Employee> &out - Set to the employees in the backup.
+ * @param unsigned long &sequence - Set to the change sequence the backup reflects.
+ *
+ * @return bool - Returns true if the whole backup was read.
+ */
+bool readBackup(const fs::path &source, std::vector<Employee> &out, unsigned long &sequence)
+{
+    std::ifstream file(source, std::ios::binary);
+    char magic[sizeof(BACKUP_FILE_MAGIC)];
+    uint64_t header[2];
+    if (!file.read(magic, sizeof(magic)) ||
+        (std::memcmp(magic, BACKUP_FILE_MAGIC, sizeof(magic)) != 0 && std::memcmp(magic, BACKUP_FILE_MAGIC_V1, sizeof(magic)) != 0) ||
+        !file.read(reinterpret_cast<char *>(header), sizeof(header)))
+    {
+        return false;
+    }
+    bool checked = std::memcmp(magic, BACKUP_FILE_MAGIC, sizeof(magic)) == 0;
+    sequence = header[0];
+    out.clear();
+
+    // Sizes in the file are only trusted as far as the file goes, a damaged header can't ask for
+    // more memory than the backup could hold. Every record takes at least a byte.
+    std::error_code ec;
+    uintmax_t fileSize = fs::file_size(source, ec);
+    if (ec || header[1] > fileSize)
+    {
+        return false;
+    }
+    out.reserve(header[1]);
+
+    uint32_t block[4];
+    while (out.size() < header[1] && file.read(reinterpret_cast<char *>(block), (checked ? 4 : 3) * sizeof(uint32_t)))
+    {
+        if (block[2] > fileSize - (uintmax_t)file.tellg() || block[0] > BACKUP_BLOCK_RECORDS)
+        {
+            return false;
+        }
+        std::string compressed(block[2], '\0');
+        std::string raw;
+        if (!file.read(&compressed[0], compressed.size()) ||
+            (checked && blockChecksum(block, compressed) != block[3]) || !lzDecompress(compressed, block[1], raw))
+        {
+            return false;
+        }
+
+        std::istringstream lines(raw);
+        std::string line;
+        for (uint32_t i = 0; i < block[0]; ++i)
+        {
+            Employee e;
+            if (!getline(lines, line) || line.size() < 2 || line[0] != 'v' ||
+                !Employee::parseRecord(line.substr(line.find(' ') + 1), std::atoi(line.c_str() + 1), &e))
+            {
+                return false;
+            }
+            out.push_back(e);
+        }
+    }
+
+    return out.size() == header[1];
+}
+
+/**
+ * @struct UndoStep
+ *
+ * @description - One change made in this session, with what is needed to reverse and repeat it.
+ * An add keeps only the employee added, a remove only the employee removed, both are reversed
+ * through the archive. An edit keeps the employee before and after.
+ *
+ * @prop kind int - UNDO_ADD, UNDO_EDIT, or UNDO_REMOVE.
+ * @prop before Employee - The employee before the change, unused for an add.
+ * @prop after Employee - The employee after the change, unused for a remove.
+ */
+struct UndoStep
+{
+    int kind = 0;
+    Employee before;
+    Employee after;
+
+    /**
+     * @function bytes
+     *
+     * @description - Roughly how much memory the step holds, for the journal budget.
+     *
+     * @return size_t - Bytes used.
+     */
+    size_t bytes() const
+    {
+        size_t total = sizeof(UndoStep);
+        for (const Employee *e : {&this->before, &this->after})
+        {
+            total += e->firstName.capacity() + e->lastName.capacity() + e->username.capacity() +
+                     e->department.capacity() + e->file.native().capacity();
+        }
+        return total;
+    }
+
+    std::string describe() const
+    {
+        const Employee &e = this->kind == UNDO_REMOVE ? this->before : this->after;
+        std::string name = e.firstName + " " + e.lastName;
+        switch (this->kind)
+        {
+        case UNDO_ADD:
+            return "Add of " + name;
+        case UNDO_REMOVE:
+            return "Remove of " + name;
+        default:
+            return (this->before.getPermissions() != this->after.getPermissions() ? "Permission change of " : "Edit of ") + name;
+        }
+    }
+};
+
+/**
+ * @class UndoJournal
+ *
+ * @description - Undo and redo stacks of the changes made in this session. A new change clears
+ * the redo stack. When the steps use more than UNDO_BUDGET_BYTES the oldest are forgotten, so
+ * memory stays bounded however long the session runs.
+ *
+ * @method public record - Adds a new change.
+ * @method public takeUndo - Removes the newest change to undo it.
+ * @method public takeRedo - Removes the newest undone change to redo it.
+ * @method public pushUndo - Puts a step back on the undo stack after a redo, or a failed undo.
+ * @method public pushRedo - Puts a step on the redo stack after an undo, or a failed redo.
+ *
+ */
+class UndoJournal
+{
+    std::deque<UndoStep> undoSteps;
+    std::deque<UndoStep> redoSteps;
+    size_t used;
+
+    void trim()
+    {
+        while (this->used > UNDO_BUDGET_BYTES && !this->redoSteps.empty())
+        {
+            this->used -= this->redoSteps.front().bytes();
+            this->redoSteps.pop_front();
+        }
+        while (this->used > UNDO_BUDGET_BYTES && !this->undoSteps.empty())
+        {
+            this->used -= this->undoSteps.front().bytes();
+            this->undoSteps.pop_front();
+        }
+    }
+
+public:
+    UndoJournal() : used(0) {}
+
+    void record(UndoStep step)
+    {
+        for (const UndoStep &redo : this->redoSteps)
+        {
+            this->used -= redo.bytes();
+        }
+        this->redoSteps.clear();
+        this->pushUndo(std::move(step));
+    }
+
+    void pushUndo(UndoStep step)
+    {
+        this->used += step.bytes();
+        this->undoSteps.push_back(std::move(step));
+        this->trim();
+    }
+
+    void pushRedo(UndoStep step)
+    {
+        this->used += step.bytes();
+        this->redoSteps.push_back(std::move(step));
+        this->trim();
+    }
+
+    bool takeUndo(UndoStep &step)
+    {
+        if (this->undoSteps.empty())
+        {
+            return false;
+        }
+        step = std::move(this->undoSteps.back());
+        this->undoSteps.pop_back();
+        this->used -= step.bytes();
+        return true;
+    }
+
+    bool takeRedo(UndoStep &step)
+    {
+        if (this->redoSteps.empty())
+        {
+            return false;
+        }
+        step = std::move(this->redoSteps.back());
+        this->redoSteps.pop_back();
+        this->used -= step.bytes();
+        return true;
+    }
+
+    const UndoStep *nextUndo() const { return this->undoSteps.empty() ? nullptr : &this->undoSteps.back(); }
+
+    const UndoStep *nextRedo() const { return this->redoSteps.empty() ? nullptr : &this->redoSteps.back(); }
+};
+
+/**
+ * @class Screen
+ * 
+ * @description - This class is a abstract class that will be used to create
+ * screens for the application. It will provide a base for the screens to be
+ * built from.
+ * 
+ * @prop name - The name of the screen.
+ * @prop headerText - The text that will be displayed in the header of the screen.
+ * @prop headerWidth - The width of the header of the screen.
+ * @prop notice - A message for the user, shown once under the body the next time the screen is displayed.
+ * 
+ * @method display - This function will be used to display the screen to the user.
+ * @method renderScreenBody - Pure virtual function that will be used to render
+ * the body of the screen.
+ * @method renderInteractiveContent - Pure virtual function that will be used to render
+ * the interactive content of the screen.
+ * @method printScreenHeader - This function will be used to print the header of the screen.
+ * @method clearScreen - This function will be used to clear the screen.
+ * 
+*/
+class Screen
+{
+public:
+    std::string name;
+    std::string headerText;
+    short headerWidth;
+    std::string notice;
+
+    virtual ~Screen() = 0;
+
+    /**
+     * @function display
+     * 
+     * @description - This function will be used to display the screen to the user.
+     * 
+     * @return void
+     * 
+    */
+    void display()
+    {
+        Screen::clearScreen();
+
+        this->printScreenHeader();
+        this->renderScreenBody();
+        if (!this->notice.empty())
+        {
+            std::cout << this->notice << std::endl
+                      << std::endl;
+            this->notice.clear();
+        }
+        this->renderInteractiveContent();
+    }
+
+    /**
+     * @function renderScreenBody - pure virtual
+     *
+     * @description - This function will be used to render the body of the screen. Which is 
+     * displayed just prior to interactive content.
+     * 
+     * @return void
+     */
+    virtual void renderScreenBody() = 0;
+
+    /**
+     * @function renderInteractiveContent - pure virtual
+     *
+     * @description - This function will be used to render the interactive content of the screen.
+     * 
+     * @return void
+     */
+    virtual void renderInteractiveContent() = 0;
+
+    /**
+     * @function printScreenHeader
+     *
+     * @description This function will calculate the height needed to provide
+     * spacing around the title, and will print via cout.
+     *
+     * @return void
+     */
+    virtual void printScreenHeader()
+    {
+        // To calc height we need to divide to find the number of lines needed, we
+        // want a minimum of 5 lines. We include 2 blank spaces on both sides
+        // horizontally, then we also want a blank line above and below screen.
+        int lineCount =
+            (int)ceil((float)this->headerText.length() / (this->headerWidth - 4));
+        int height = std::max(lineCount + 2, 5);
+
+        // This is the index in which we need to start printing the screenName
+        int startIndex = round(((float)height / 2) - floor(lineCount / 2)) - 1;
+
+        for (int i = 0; i < height; ++i)
+        {
+            if (i == 0 || i == height - 1)
+            {
+                std::string s(headerWidth, '*');
+
+                std::cout << s << std::endl;
+                continue;
+            }
+
+            // For now we are going to support one line, here we are going to build
+            // the line where we provide space around the word.
+            if (i == startIndex)
+            {
+                std::string left(ceil((headerWidth - this->headerText.length()) / 2.0), ' ');
+                std::string right(headerWidth - (left.length() + this->headerText.length()),
+                             ' ');
+                left[0] = '*';
+                right[right.length() - 1] = '*';
+
+                std::cout << left << this->headerText << right << std::endl;
+                continue;
+            }
+
+            std::string s(headerWidth, ' ');
+            s[0] = '*';
+            s[s.length() - 1] = '*';
+
+            std::cout << s << std::endl;
+        }
+
+        // I want a newline after the title
+        std::cout << std::endl;
+    }
+
+    /**
+     * @function clearScreen
+     * 
+     * @description - This function will be used to clear the screen.
+     * 
+     * @return void
+    */
+    static void clearScreen()
+    {
+#if defined _WIN32
+        system("cls");
+#elif defined(__LINUX__) || defined(__gnu_linux__) || defined(__linux__)
+        system("clear");
+#elif defined(__APPLE__)
+        system("clear");
+#endif
+    }
+};
+// Destructor
+Screen::~Screen(){};
+
+/**
+ * @class LoginScreen
+ * 
+ * @description - This class will be used to create the login screen for the application.
+ * 
+ * @prop private Application *app - The application object.
+ * 
+ * @method public LoginScreen(Application *a) - The constructor for the login screen.
+ * @method public renderInteractiveContent - This function will be used to render the interactive content of the screen.
+ * @method public renderScreenBody - This function will be used to render the body of the screen.
+ * 
+*/
+class LoginScreen : public Screen
+{
+    Application *app;
+
+public:
+    void renderInteractiveContent() override;
+    LoginScreen(Application *a) : app(a)
+    {
+        name = "login";
+        headerText = "Welcome to FooBar Employee Management";
+        headerWidth = HEADER_WIDTH;
+    }
+
+    void renderScreenBody() override
+    {
+        std::cout << "***  Login to Continue  ***" << std::endl
+             << std::endl;
+    }
+};
+
+/**
+ * @class MenuOption
+ * 
+ * @description - This class will be used to create menu options for the menu screen.
+ * 
+ * @prop private Application *app - The application object.
+ * @prop private vector<string> options - The options that will be displayed to the user.
+ * @prop private bool optionsInitialized - A flag to determine if the options have been initialized. 
+ * This is due to them needing the application object.
+ * 
+ * @method public MenuOption(Application *a) - Constructor that takes the application object.
+ * @method public void buildMenuOptions() - This function will be used to build the menu options.
+ * 
+*/
+class MenuScreen : public Screen
+{
+    Application *app;
+    std::vector<MenuOption> options;
+    bool optionsInitialized;
+
+public:
+    MenuScreen(Application *a) : app(a)
+    {
+        this->name = "menu";
+        this->headerWidth = HEADER_WIDTH;
+        this->headerText = "testing";
+        this->optionsInitialized = false;
+    }
+
+    void prePrintHeader();
+    void renderInteractiveContent() override;
+    void buildMenuOptions();
+
+    /**
+     * @function renderScreenHeader
+     * 
+     * @description - This function will be used to render the header of the screen. 
+     * This is an override, that calls the base implementation.
+     * 
+     * @return void
+    */
+    void printScreenHeader() override
+    {
+        this->prePrintHeader();
+
+        Screen::printScreenHeader();
+    }
+
+    /**
+     * @function renderScreenBody
+     * 
+     * @description - This function will be used to render the body of the screen.
+     * 
+     * @return void
+    */
+    void renderScreenBody() override
+    {
+        std::cout << "***  What do you need to do today?  ***" << std::endl
+             << std::endl;
+    }
+};
+
+/**
+ * 
+ * @class ListScreen
+ * 
+ * @description - This class will be used to create the list screen for the application. 
+ * Is also used for search results and listing on the remove page.
+ * 
+ * @prop private Application *app - The application object.
+ * @prop public vector<Employee> employees - The employees that will be displayed on the screen.
+ * @prop public bool employeesOverriden - A flag to determine if the employees have been overriden. 
+ * If true use this class's employees. Otherwise use the application's employees.
+ * @prop private bool isRemove - A flag to determine if this is the remove screen.
+ * @prop private shared_ptr<BoundedChannel<RecordRef>> results - Records streamed in by a running search, if any.
+ * @prop private bool resultsOpen - A flag that is true until the streamed search has sent its last row.
+ * 
+ * @method public ListScreen(Application *a) - The constructor for the list screen.
+ * @method public ListScreen(Application *a, string searchQuery, vector<Employee> employees) - 
+ * The constructor for the list screen with search results.
+ * @method public ListScreen(Application *a, string searchQuery, shared_ptr<BoundedChannel<RecordRef>> results) - 
+ * The constructor for the list screen with search results that are still being found.
+ * @method public ListScreen(Application *a, bool isRemove) - The constructor for the list screen for the remove screen.
+ * @method public void renderInteractiveContent - This function will be used to render the interactive content of the screen.
+ * @method public vector<Employee> getEmployees - This function will be used to get the employees. 
+ * This is where the employeesOverriden flag is used.
+ * @method private bool printResultsPage - Prints the next page of streamed results.
+ * @method private void stopResults - Cancels the streamed search and waits for it to stop.
+ * 
+ * 
+*/
+class ListScreen : public Screen
+{
+    bool isRemove;
+    Application *app;
+    std::shared_ptr<BoundedChannel<RecordRef>> results;
+    bool resultsOpen;
+
+    bool printResultsPage();
+    void stopResults();
+
+public:
+    std::vector<Employee> employees;
+    bool employeesOverriden;
+
+    void renderInteractiveContent() override;
+    std::vector<Employee> getEmployees();
+
+    ListScreen(Application *a) : app(a)
+    {
+        name = "list";
+        headerText = "Viewing All Employees";
+        headerWidth = HEADER_WIDTH;
+        employeesOverriden = false;
+        isRemove = false;
+        resultsOpen = false;
+    }
+
+    ListScreen(Application *a, std::string searchQuery, std::vector<Employee> employees) : app(a)
+    {
+        name = "search-list";
+
+        std::ostringstream oss;
+        oss << "Showing employees like \"" << searchQuery << "\"";
+        headerText = oss.str();
+        headerWidth = HEADER_WIDTH;
+
+        this->employees = employees;
+        employeesOverriden = true;
+        isRemove = false;
+        resultsOpen = false;
+    }
+
+    ListScreen(Application *a, std::string searchQuery, std::shared_ptr<BoundedChannel<RecordRef>> results) : app(a)
+    {
+        name = "search-list";
+
+        std::ostringstream oss;
+        oss << "Showing employees like \"" << searchQuery << "\"";
+        headerText = oss.str();
+        headerWidth = HEADER_WIDTH;
+
+        this->results = results;
+        resultsOpen = true;
+        employeesOverriden = true;
+        isRemove = false;
+    }
+
+    ListScreen(Application *a, std::string remove) : app(a)
+    {
+        name = "list";
+        headerText = "Remove Employee";
+        headerWidth = HEADER_WIDTH;
+        isRemove = true;
+        employeesOverriden = false;
+        resultsOpen = false;
+    }
+
+    ~ListScreen()
+    {
+        this->stopResults();
+    }
+
+    void renderScreenBody() override
+    {
+        if (this->isRemove)
+        {
+            std::cout << "***  Insert Id of Employee to Remove ***" << std::endl
+                 << std::endl;
+        }
+        else
+        {
+            std::cout << "***  Insert Id of Employee to Edit/View  ***" << std::endl
+                 << std::endl;
+        }
+    }
+};
+
+/**
+ * @class SearchScreen
+ * 
+ * @description - This class will be used to create the search screen for the application.
+ * 
+ * @prop private Application *app - The application object.
+ * 
+ * @method public SearchScreen(Application *a) - The constructor for the search screen.
+ * @method public void renderInteractiveContent - This function will be used to render the interactive content of the screen.
+ * 
+*/
+class SearchScreen : public Screen
+{
+    Application *app;
+
+public:
+    void renderInteractiveContent() override;
+    SearchScreen(Application *a) : app(a)
+    {
+        name = "search";
+        headerText = "Search Employees";
+        headerWidth = HEADER_WIDTH;
+    }
+
+    void renderScreenBody() override
+    {
+        std::cout << "***  Insert Search Query by names, or username to Search ***" << std::endl
+             << "***  Start with " << PHONETIC_QUERY_PREFIX << " to find names that sound alike ***" << std::endl
+             << std::endl;
+    }
+};
+
+/**
+ * @class AddEmployeeScreen
+ * 
+ * @description - This class will be used to create the add employee screen for the application.
+ * 
+ * @prop private Application *app - The application object.
+ * 
+ * @method public AddEmployeeScreen(Application *a) - The constructor for the add employee screen.
+ * @method public void renderInteractiveContent - This function will be used to render the interactive content of the screen.
+ * 
+*/
+class AddEmployeeScreen : public Screen
+{
+    Application *app;
+
+public:
+    void renderInteractiveContent() override;
+    AddEmployeeScreen(Application *a) : app(a)
+    {
+        name = "add";
+        headerText = "Add a new Employee";
+        headerWidth = HEADER_WIDTH;
+    }
+
+    void renderScreenBody() override
+    {
+        std::cout << "***  Answer prompts to add new employee.  ***" << std::endl
+             << std::endl;
+    };
+};
+
+/**
+ * @class EditScreen
+ * 
+ * @description - This class will be used to create the edit screen for the application.
+ * 
+ * @prop private Application *app - The application object.
+ * @prop private Employee *employee - The employee object.
+ * 
+ * @method public EditScreen(Application *a, Employee *employee) - The constructor for the edit screen.
+ * @method public void renderInteractiveContent - This function will be used to render the interactive content of the screen.
+ * 
+*/
+class EditScreen : public Screen
+{
+    Application *app;
+    Employee *employee;
+
+public:
+    void renderInteractiveContent() override;
+
+    EditScreen(Application *a, Employee *employee) : app(a)
+    {
+        name = "edit";
+        headerText = "Edit Employee";
+        headerWidth = HEADER_WIDTH;
+        this->employee = employee;
+    }
+
+    void renderScreenBody() override
+    {
+        std::cout << "***  Answer prompts to employee information (Leave blank for no change).  ***" << std::endl
+             << std::endl;
+    };
+};
+
+/**
+ * @class HistoryScreen
+ * 
+ * @description - This class will be used to create the screen that lists every saved version of an
+ * employee and looks up what their record was on a given date.
+ * 
+ * @prop private Application *app - The application object.
+ * @prop private int id - The id of the employee.
+ * 
+ * @method public HistoryScreen(Application *a, int id) - The constructor for the history screen.
+ * @method public void renderInteractiveContent - Prints the versions and answers as of date lookups.
+ * 
+*/
+class HistoryScreen : public Screen
+{
+    Application *app;
+    int id;
+
+public:
+    void renderInteractiveContent() override;
+
+    HistoryScreen(Application *a, int id) : app(a)
+    {
+        name = "history";
+        headerText = "Employee History";
+        headerWidth = HEADER_WIDTH;
+        this->id = id;
+    }
+
+    void renderScreenBody() override
+    {
+        std::cout << "***  Insert a Date to See the Record as it Was Then  ***" << std::endl
+             << std::endl;
+    };
+};
+
+/**
+ * @class DepartmentScreen
+ * 
+ * @description - This class will be used to create the department report screen for the application.
+ * 
+ * @prop private Application *app - The application object.
+ * 
+ * @method public DepartmentScreen(Application *a) - The constructor for the department screen.
+ * @method public void renderInteractiveContent - Prints the headcount report and lets the user list a department.
+ * 
+*/
+class DepartmentScreen : public Screen
+{
+    Application *app;
+
+public:
+    void renderInteractiveContent() override;
+    DepartmentScreen(Application *a) : app(a)
+    {
+        name = "departments";
+        headerText = "Department Report";
+        headerWidth = HEADER_WIDTH;
+    }
+
+    void renderScreenBody() override
+    {
+        std::cout << "***  Insert a Department to List its Employees  ***" << std::endl
+             << std::endl;
+    }
+};
+
+/**
+ * @class PayrollScreen
+ * 
+ * @description - This class will be used to create the payroll summary screen for the application.
+ * 
+ * @prop private Application *app - The application object.
+ * 
+ * @method public PayrollScreen(Application *a) - The constructor for the payroll screen.
+ * @method public void renderInteractiveContent - Asks for a filter and prints salary band, FTE and hire date totals.
+ * 
+*/
+class PayrollScreen : public Screen
+{
+    Application *app;
+
+public:
+    void renderInteractiveContent() override;
+    PayrollScreen(Application *a) : app(a)
+    {
+        name = "payroll";
+        headerText = "Payroll Summary";
+        headerWidth = HEADER_WIDTH;
+    }
+
+    void renderScreenBody() override
+    {
+        std::cout << "***  Filter like salary:3..5,fte:..0.5,hired:2020-01-01.. or all  ***" << std::endl
+             << std::endl;
+    }
+};
+
+/**
+ * @struct Department
+ *
+ * @description - Members of a department and counts kept up to date as employees are added,
+ * edited, and removed, so reports never have to walk every employee.
+ *
+ * @prop members - Ids of the employees in the department.
+ * @prop hr size_t - Members with HR permissions.
+ * @prop management size_t - Members with management permissions.
+ * @prop general size_t - Members with general permissions.
+ */
+struct Department
+{
+    std::unordered_set<int> members;
+    size_t hr = 0;
+    size_t management = 0;
+    size_t general = 0;
+};
+
+/**
+ * @class FileScreen
+ * 
+ * @description - This class will be used to create the file screen for the application.
+ * 
+ * @prop private Application *app - The application object.
+ * @prop private Employee *employee - The employee object.
+ * @prop private bool employeeOverriden - The flag to check if the employee object is overriden.
+ * 
+ * @method public FileScreen(Application *a) - The constructor for the file screen.
+ * @method public FileScreen(Application *a, Employee *employee) - The constructor for the file screen with a specific employee.
+*/
+class FileScreen : public Screen
+{
+    Application *app;
+    Employee *employee;
+    bool employeeOverriden;
+
+public:
+    void renderInteractiveContent() override;
+    Employee *getEmployee();
+    FileScreen(Application *a) : app(a)
+    {
+        name = "file";
+        headerText = "Viewing Your Profile";
+        headerWidth = HEADER_WIDTH;
+        employeeOverriden = false;
+    }
+
+    FileScreen(Application *a, Employee *employee) : app(a)
+    {
+        name = "specific file";
+        headerText = "Viewing Profile";
+        headerWidth = HEADER_WIDTH;
+        this->employee = employee;
+        employeeOverriden = true;
+    }
+
+    void renderScreenBody() override{};
+};
+
+/**
+ * @class ReorgScreen
+ * 
+ * @description - This class will be used to create the screen that moves every direct report of
+ * one manager to another, optionally into a new department, as a single transaction.
+ * 
+ * @prop private Application *app - The application object.
+ * 
+ * @method public ReorgScreen(Application *a) - The constructor for the reorg screen.
+ * @method public void renderInteractiveContent - Asks for the managers and department and commits the move.
+ * 
+*/
+class ReorgScreen : public Screen
+{
+    Application *app;
+
+public:
+    void renderInteractiveContent() override;
+    ReorgScreen(Application *a) : app(a)
+    {
+        name = "reorg";
+        headerText = "Reassign Reports";
+        headerWidth = HEADER_WIDTH;
+    }
+
+    void renderScreenBody() override
+    {
+        std::cout << "***  Move every direct report of a manager to another  ***" << std::endl
+             << std::endl;
+    }
+};
+
+/**
+ * @class ArchiveScreen
+ * 
+ * @description - This class will be used to create the screen that lists removed employees and
+ * restores them from the archive.
+ * 
+ * @prop private Application *app - The application object.
+ * 
+ * @method public ArchiveScreen(Application *a) - The constructor for the archive screen.
+ * @method public void renderInteractiveContent - Lists the archive and restores the employee picked.
+ * 
+*/
+class ArchiveScreen : public Screen
+{
+    Application *app;
+
+public:
+    void renderInteractiveContent() override;
+    ArchiveScreen(Application *a) : app(a)
+    {
+        name = "archive";
+        headerText = "Removed Employees";
+        headerWidth = HEADER_WIDTH;
+    }
+
+    void renderScreenBody() override
+    {
+        std::cout << "***  Insert Id of Employee to Restore  ***" << std::endl
+             << std::endl;
+    }
+};
+
+/**
+ * @class UndoScreen
+ * 
+ * @description - This class will be used to create the screen that undoes and redoes the changes
+ * made this session.
+ * 
+ * @prop private Application *app - The application object.
+ * 
+ * @method public UndoScreen(Application *a) - The constructor for the undo screen.
+ * @method public void renderInteractiveContent - Shows the next undo and redo and applies the one picked.
+ * 
+*/
+class UndoScreen : public Screen
+{
+    Application *app;
+
+public:
+    void renderInteractiveContent() override;
+    UndoScreen(Application *a) : app(a)
+    {
+        name = "undo";
+        headerText = "Undo / Redo";
+        headerWidth = HEADER_WIDTH;
+    }
+
+    void renderScreenBody() override
+    {
+        std::cout << "***  Changes Made This Session  ***" << std::endl
+             << std::endl;
+    }
+};
+
+/**
+ * @class Transaction
+ *
+ * @description - Groups changes to many employees so they are saved all together or not at all.
+ * Changes are staged on copies and nothing is written until commit, which checks them against
+ * the store as it will look afterwards and then saves them through one journal record.
+ *
+ * @prop private Application *app - The application the changes are for.
+ * @prop private map<int, Employee> staged - Staged copies by id.
+ * @prop private bool open - True from begin until commit or abort.
+ *
+ * @method public Transaction(Application *a) - Begins a transaction.
+ * @method public Employee *stage - Gets the staged copy of an employee to change.
+ * @method public void put - Stages a whole employee, new or existing.
+ * @method public bool usernameTaken - Checks a username against the staged state.
+ * @method public bool commit - Validates and saves every staged change at once.
+ * @method public void abort - Drops every staged change.
+ *
+ */
+class Transaction
+{
+    Application *app;
+    std::map<int, Employee> staged;
+    bool open;
+
+public:
+    Transaction(Application *a) : app(a), open(true) {}
+
+    Employee *stage(int id);
+    void put(const Employee &e);
+    bool usernameTaken(const std::string &username, int skipId);
+    bool commit(std::string &error);
+
+    void abort()
+    {
+        this->staged.clear();
+        this->open = false;
+    }
+
+    bool isOpen() const { return this->open; }
+
+    size_t size() const { return this->staged.size(); }
+};
+
+/**
+ * @class Application
+ * 
+ * @description - This class will be used to create the application object for the application.
+ * 
+ * @prop private Employee employee - The employee that is signed in object.
+ * @prop private std::unordered_map<std::string, std::unique_ptr<Screen>> screens - The screens object.
+ * @prop public employees - List of all employees being tracked by the application. 
+ * @prop public int currentId - The current highest id of the employees.
+ * @prop public TaskPool pool - Shared work-stealing scheduler used by loading, searching and bulk work.
+ * @prop private unsigned long generation - Bumped by every add, edit, and remove of an employee.
+ * @prop private QueryCache queryCache - Search results cached by query and generation.
+ * @prop private SnapshotStore snapshots - Published versions of the store for lock free readers.
+ * @prop public ChangeFeed changes - Ordered feed of every add, edit, and remove.
+ * @prop public AuditLog audit - Record of who logged in and viewed, edited, or removed whom.
+ * @prop private EmployeeArchive archive - Removed employees, compressed, until restored or purged.
+ * @prop private PackStore pack - The packed store, if the employees have been packed.
+ * @prop private bool replica - True for a read only replica, see startReplica.
+ * @prop private ChangeTail tail - Follows the change log for a replica.
+ * @prop private UndoJournal undoJournal - Changes made this session that can be undone and redone.
+ * @prop private idIndex - Row of each employee by id.
+ * @prop private searchKeys - Case folded names and username of each row.
+ * @prop private usernameIndex - Ids of employees by case folded username.
+ * @prop private permissionIndex - One row bitmap per permission bit.
+ * @prop private phoneticIndex - Ids of employees by the Soundex key of their first and last name.
+ * @prop private reportsIndex - Ids of the direct reports of each manager, by manager id.
+ * @prop private departments - Members and headcounts of each department, by name.
+ * @prop private columns - Hire date, salary band, and FTE of every row as flat arrays.
+ * @prop private modSeqIndex - Id of the record last changed at each change sequence, including removes.
+ * @prop private modSeqOf - Sequence of the last change to each record, by id.
+ * @prop private tombstones - Ids of removed records, exported as deletes.
+ * 
+ * @method public void loadScreens - This function will be used to load all the screens for the application.
+ * @method public void run - This function will be used to run the application.
+ * @method public void navigateToScreen - This function will be used to navigate to a specific screen.
+ * @method public Employee *getLoggedInEmployee - This function will be used to get the employee object.
+ * @method public void login - This function will be used to login the employee.
+ * @method public Employee *findEmployeeById - This function will be used to find an employee by id.
+ * @method public bool addEmployee - Saves a new employee and adds it to the store.
+ * @method public bool updateEmployee - Saves the changes to an existing employee.
+ * @method public Transaction beginTransaction - Starts staging changes to many employees.
+ * @method public bool commitTransaction - Saves staged employees through the journal all at once.
+ * @method public bool removeEmployeeById - This function will be used to remove an employee by id.
+ * @method public bool restoreEmployee - Brings a removed employee back from the archive.
+ * @method public vector<ArchivedEmployee> archivedEmployees - Removed employees still in the archive.
+ * @method public bool purgeArchive - Drops archived employees past the retention.
+ * @method public future<bool> startBackup - Backs up a snapshot of the store on a background thread.
+ * @method public bool restoreBackup - Makes the store match a backup.
+ * @method public FsckReport checkStore - Checks every employee file and optionally repairs them.
+ * @method public size_t packStore - Packs the employees into the compressed store.
+ * @method public bool benchmarkPack - Measures the packed store's size and speed.
+ * @method public bool shareStore - Keeps the employees in shared memory for other processes.
+ * @method public void startReplica - Makes this a read only replica that follows the change log.
+ * @method public bool useSharedStore - Lets a replica read logins and lookups from the shared store.
+ * @method public Employee *lookupEmployee - Finds an employee by id, brought up to date from the shared store on a replica.
+ * @method public void catchUp - Applies the changes a replica has seen since it last caught up.
+ * @method public bool undo - Reverses the last change made this session.
+ * @method public bool redo - Repeats the last change undone.
+ * @method public bool searchMatch - Takes in input string and query and does a case insensitive search.
+ * @method public Snapshot snapshot - Pins a consistent view of the store.
+ * @method public vector<size_t> phoneticSearchRows - Rows of employees with a name that sounds like the query.
+ * @method public bool uniqueUsername - This function will be used to check if the username is unique. 
+ * Two signatures, one with a string that will compare all users, and one that takes in an int to skip 
+ * comparison of by employee id.
+ * @method public vector<int> usernameOwners - Ids of the employees with a username.
+ * @method public size_t countEmployees - Counts employees like a query without copying them.
+ * @method public bool anyEmployeeMatches - Checks if any employee is like a query, stopping at the first.
+ * @method public size_t countWithPermission - Counts employees with any of the permission bits given.
+ * @method public vector<Employee> reportsOf - Direct and indirect reports of an employee.
+ * @method public vector<Employee> managementChain - Managers above an employee, closest first.
+ * @method public bool canReportTo - Checks a manager assignment would not create a loop.
+ * @method public map<string, Department> getDepartments - Headcounts of every department.
+ * @method public vector<Employee> departmentMembers - Employees in a department.
+ * @method public vector<uint8_t> selectRows - Mask of the rows in a set of numeric ranges.
+ * @method public ColumnSummary summarize - Sum, min, max, and average of a numeric column over selected rows.
+ * @method public unsigned long exportSince - Writes the records changed after a watermark.
+ * 
+*/
+class Application
+{
+    Employee employee;
+    // Declared before the screens so it outlives any snapshot a screen still holds.
+    SnapshotStore snapshots;
+    std::unordered_map<std::string, std::unique_ptr<Screen>> screens;
+    unsigned long generation;
+    QueryCache queryCache;
+    std::unordered_map<int, size_t> idIndex;
+    std::vector<SearchKeys> searchKeys;
+    std::unordered_multimap<std::string, int> usernameIndex;
+    RowBitmap permissionIndex[PERMISSION_BITS];
+    std::unordered_multimap<std::string, int> phoneticIndex;
+    std::unordered_map<int, std::vector<int>> reportsIndex;
+    std::map<std::string, Department> departments;
+    std::vector<int32_t> columns[NUMERIC_COLUMNS];
+    std::map<unsigned long, int> modSeqIndex;
+    std::unordered_map<int, unsigned long> modSeqOf;
+    std::unordered_set<int> tombstones;
+    EmployeeArchive archive;
+    PackStore pack;
+    std::unordered_set<int> packedIds;
+    bool replica;
+    ChangeTail tail;
+    std::streamoff logSizeAtLoad;
+    unsigned long loadedSequence;
+    unsigned long appliedSequence;
+#if defined SHARED_STORE_POSIX
+    SharedStore shared;
+    bool sharedAttached;
+#endif
+    UndoJournal undoJournal;
+    bool replayingUndo;
+
+    /**
+     * @function phoneticKeys - static
+     *
+     * @description - The distinct Soundex keys of an employee's first and last name.
+     *
+     * @param Employee e - The employee to encode.
+     *
+     * @return vector<string> - One or two keys.
+     */
+    static std::vector<std::string> phoneticKeys(const Employee &e)
+    {
+        std::vector<std::string> keys;
+        for (const std::string *name : {&e.firstName, &e.lastName})
+        {
+            std::string key = soundex(*name);
+            if (!key.empty() && std::find(keys.begin(), keys.end(), key) == keys.end())
+            {
+                keys.push_back(key);
+            }
+        }
+        return keys;
+    }
+
+    /**
+     * @function indexRow
+     *
+     * @description - Adds the employee at a row to the id, username, and permission indexes.
+     *
+     * @param size_t row - The row in employees to index.
+     * @param bool buildKeys - Set to false when searchKeys for the row is already up to date.
+     *
+     * @return void
+     */
+    void indexRow(size_t row, bool buildKeys = true)
+    {
+        const Employee &e = this->employees[row];
+        if (buildKeys)
+        {
+            this->buildSearchKeys(row);
+        }
+
+        this->idIndex[e.id] = row;
+        this->usernameIndex.emplace(this->searchKeys[row].username, e.id);
+        for (int column = 0; column < NUMERIC_COLUMNS; ++column)
+        {
+            if (row >= this->columns[column].size())
+            {
+                this->columns[column].resize(row + 1, 0);
+            }
+            this->columns[column][row] = e.getColumn(column);
+        }
+        for (short bit = 0; bit < PERMISSION_BITS; ++bit)
+        {
+            this->permissionIndex[bit].set(row, (e.getPermissions() >> bit) & 1);
+        }
+
+        for (const std::string &key : phoneticKeys(e))
+        {
+            this->phoneticIndex.emplace(key, e.id);
+        }
+
+        if (e.managerId != 0)
+        {
+            this->reportsIndex[e.managerId].push_back(e.id);
+        }
+
+        Department &department = this->departments[e.department];
+        department.members.insert(e.id);
+        department.hr += e.hasPermission(HR_PERMS);
+        department.management += e.hasPermission(MANAGEMENT_PERMS);
+        department.general += e.hasPermission(GENERAL_PERMS);
+    }
+
+    /**
+     * @function unindexRow
+     *
+     * @description - Removes the employee at a row from the indexes, used before it changes.
+     *
+     * @param size_t row - The row in employees to remove from the indexes.
+     *
+     * @return void
+     */
+    void unindexRow(size_t row)
+    {
+        const Employee &e = this->employees[row];
+        this->idIndex.erase(e.id);
+
+        auto range = this->usernameIndex.equal_range(this->searchKeys[row].username);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second == e.id)
+            {
+                this->usernameIndex.erase(it);
+                break;
+            }
+        }
+
+        for (short bit = 0; bit < PERMISSION_BITS; ++bit)
+        {
+            this->permissionIndex[bit].set(row, false);
+        }
+
+        for (const std::string &key : phoneticKeys(e))
+        {
+            auto keyRange = this->phoneticIndex.equal_range(key);
+            for (auto it = keyRange.first; it != keyRange.second; ++it)
+            {
+                if (it->second == e.id)
+                {
+                    this->phoneticIndex.erase(it);
+                    break;
+                }
+            }
+        }
+
+        if (e.managerId != 0)
+        {
+            std::vector<int> &reports = this->reportsIndex[e.managerId];
+            reports.erase(std::remove(reports.begin(), reports.end(), e.id), reports.end());
+            if (reports.empty())
+            {
+                this->reportsIndex.erase(e.managerId);
+            }
+        }
+
+        auto department = this->departments.find(e.department);
+        if (department != this->departments.end() && department->second.members.erase(e.id) != 0)
+        {
+            department->second.hr -= e.hasPermission(HR_PERMS);
+            department->second.management -= e.hasPermission(MANAGEMENT_PERMS);
+            department->second.general -= e.hasPermission(GENERAL_PERMS);
+            if (department->second.members.empty())
+            {
+                this->departments.erase(department);
+            }
+        }
+    }
+
+    /**
+     * @function rebuildIndexes
+     *
+     * @description - Rebuilds every index from scratch, used after loading and when rows move.
+     *
+     * @param bool buildKeys - Set to false when searchKeys already lines up with employees.
+     *
+     * @return void
+     */
+    void rebuildIndexes(bool buildKeys = true)
+    {
+        this->idIndex.clear();
+        this->usernameIndex.clear();
+        this->phoneticIndex.clear();
+        this->reportsIndex.clear();
+        this->departments.clear();
+        for (int column = 0; column < NUMERIC_COLUMNS; ++column)
+        {
+            this->columns[column].assign(this->employees.size(), 0);
+        }
+        for (short bit = 0; bit < PERMISSION_BITS; ++bit)
+        {
+            this->permissionIndex[bit].clear();
+        }
+
+        // Folding is the expensive part and every row is independent, so do it on the pool.
+        if (buildKeys)
+        {
+            this->searchKeys.resize(this->employees.size());
+            this->pool.parallelFor(0, this->employees.size(), SEARCH_CHUNK_ROWS, [this](size_t lo, size_t hi)
+                                   {
+                for (size_t row = lo; row < hi; ++row)
+                {
+                    this->buildSearchKeys(row);
+                } });
+        }
+
+        for (size_t row = 0; row < this->employees.size(); ++row)
+        {
+            this->indexRow(row, false);
+        }
+    }
+
+    /**
+     * @function buildSearchKeys
+     *
+     * @description - Folds the searchable fields of the employee at a row into searchKeys.
+     *
+     * @param size_t row - The row in employees.
+     *
+     * @return void
+     */
+    void buildSearchKeys(size_t row)
+    {
+        if (row >= this->searchKeys.size())
+        {
+            this->searchKeys.resize(row + 1);
+        }
+
+        const Employee &e = this->employees[row];
+        SearchKeys &keys = this->searchKeys[row];
+        keys.firstName = foldKey(e.firstName);
+        keys.lastName = foldKey(e.lastName);
+        keys.username = foldKey(e.username);
+    }
+
+    /**
+     * @function touchStore
+     *
+     * @description - Called after any change to employees. Bumps the store generation, which
+     * invalidates every cached search result computed before the change.
+     *
+     * @return void
+     */
+    void touchStore()
+    {
+        this->generation++;
+    }
+
+    /**
+     * @function recordLockPath - static
+     *
+     * @description - Path of the lock file for an employee record.
+     *
+     * @param int id - The id of the employee.
+     *
+     * @return fs::path - The lock file path.
+     */
+    static fs::path recordLockPath(int id)
+    {
+        return EMPLOYEE_DIR / (std::to_string(id) + ".lock");
+    }
+
+    /**
+     * @function lockRecord - static
+     *
+     * @description - Takes the lock on one employee record. Only held while a save compares and
+     * writes, never while someone edits.
+     *
+     * @param int id - The id of the employee.
+     *
+     * @return bool - Returns true if the lock is held.
+     */
+    static bool lockRecord(int id)
+    {
+        return lockFile(recordLockPath(id));
+    }
+
+    static void unlockRecord(int id)
+    {
+        unlockFile(recordLockPath(id));
+    }
+
+    static fs::path removedMarkerPath(int id)
+    {
+        return EMPLOYEE_DIR / (std::to_string(id) + ".removed");
+    }
+
+    /**
+     * @function readStored
+     *
+     * @description - Reads an employee as it is on disk now: its file if it has one, otherwise
+     * the packed copy, unless it was removed since packing.
+     *
+     * @param int id - The id of the employee.
+     * @param Employee *stored - Set to the employee.
+     *
+     * @return int - 0 if read, -1 if there is no such employee, -2 if its file is damaged.
+     */
+    int readStored(int id, Employee *stored)
+    {
+        std::error_code ec;
+        fs::path file = EMPLOYEE_DIR / (std::to_string(id) + ".txt");
+        if (Employee::from(file, stored))
+        {
+            return 0;
+        }
+        if (fs::exists(file, ec))
+        {
+            return -2;
+        }
+        return !fs::exists(removedMarkerPath(id), ec) && this->pack.find(id, stored) ? 0 : -1;
+    }
+
+    /**
+     * @function storedRevision
+     *
+     * @description - Reads the revision of an employee from its file, which may have been saved
+     * by another session since it was loaded.
+     *
+     * @param int id - The id of the employee.
+     *
+     * @return int - The revision on disk, -1 if there is no file, -2 if the file is damaged.
+     */
+    int storedRevision(int id)
+    {
+        Employee stored;
+        int state = this->readStored(id, &stored);
+        return state == 0 ? stored.revision : state;
+    }
+
+    /**
+     * @function reloadEmployee
+     *
+     * @description - Replaces the stored copy of an employee with what is on disk now.
+     *
+     * @param int id - The id of the employee.
+     *
+     * @return void
+     */
+    void reloadEmployee(int id)
+    {
+        auto it = this->idIndex.find(id);
+        Employee stored;
+        if (it == this->idIndex.end() || this->readStored(id, &stored) != 0)
+        {
+            return;
+        }
+
+        this->replaceRow(it->second, stored);
+    }
+
+    /**
+     * @function recordUndo
+     *
+     * @description - Adds a change to the undo journal, unless it is an undo or redo being applied.
+     *
+     * @param int kind - UNDO_ADD, UNDO_EDIT, or UNDO_REMOVE.
+     * @param Employee before - The employee before the change.
+     * @param Employee after - The employee after the change.
+     *
+     * @return void
+     */
+    void recordUndo(int kind, const Employee &before, const Employee &after)
+    {
+        if (this->replayingUndo)
+        {
+            return;
+        }
+
+        UndoStep step;
+        step.kind = kind;
+        step.before = before;
+        step.after = after;
+        this->undoJournal.record(std::move(step));
+    }
+
+    /**
+     * @function applyUndoStep
+     *
+     * @description - Applies one side of a step through the same methods the screens use, so the
+     * change is saved, logged, and checked for conflicts like any other. Each is one lookup by id.
+     *
+     * @param UndoStep &step - The step, its revisions are updated to what was saved.
+     * @param bool reverse - True to undo the step, false to redo it.
+     * @param string &error - Set to the reason when it can't be applied.
+     *
+     * @return bool - Returns true if the step was applied.
+     */
+    bool applyUndoStep(UndoStep &step, bool reverse, std::string &error)
+    {
+        this->replayingUndo = true;
+        bool applied = false;
+
+        if (step.kind == UNDO_EDIT)
+        {
+            // The side being replaced must still be the stored revision, else someone changed it since.
+            Employee &expected = reverse ? step.after : step.before;
+            Employee &target = reverse ? step.before : step.after;
+            Employee *current = this->findEmployeeById(target.id);
+            if (current == nullptr || current->revision != expected.revision)
+            {
+                error = "The employee was changed again since.";
+            }
+            else
+            {
+                Employee updated = target;
+                updated.revision = current->revision;
+                applied = this->updateEmployee(updated, error);
+                if (applied)
+                {
+                    target.revision = this->findEmployeeById(target.id)->revision;
+                }
+            }
+        }
+        else if ((step.kind == UNDO_ADD) == reverse)
+        {
+            // Undoing an add or redoing a remove.
+            int id = step.kind == UNDO_ADD ? step.after.id : step.before.id;
+            applied = this->removeEmployeeById(id, &error);
+        }
+        else
+        {
+            // Undoing a remove or redoing an add, both bring the employee back from the archive.
+            // A restore that fails leaves the employee archived and the step where it was.
+            Employee &target = step.kind == UNDO_ADD ? step.after : step.before;
+            applied = this->restoreEmployee(target.id, error);
+            if (applied)
+            {
+                target.revision = this->findEmployeeById(target.id)->revision;
+            }
+        }
+
+        this->replayingUndo = false;
+        return applied;
+    }
+
+    /**
+     * @function insertEmployee
+     *
+     * @description - Adds an employee whose file is already written to the store and the change
+     * feed. Called with the record lock held.
+     *
+     * @param Employee e - The saved employee.
+     *
+     * @return void
+     */
+    void insertEmployee(const Employee &e)
+    {
+        this->insertRow(e);
+        this->changes.publish({changeEvent(e, nullptr)});
+    }
+
+    /**
+     * @function insertRow
+     *
+     * @description - Appends an employee to the table, indexes, and snapshot.
+     *
+     * @param Employee e - The employee.
+     *
+     * @return void
+     */
+    void insertRow(const Employee &e)
+    {
+        this->employees.push_back(e);
+        this->indexRow(this->employees.size() - 1);
+        this->touchStore();
+        this->snapshots.publishRows(this->employees, this->searchKeys, {this->employees.size() - 1}, this->generation);
+    }
+
+    /**
+     * @function replaceRow
+     *
+     * @description - Replaces the employee at a row in the table, indexes, and snapshot.
+     *
+     * @param size_t row - The row.
+     * @param Employee e - The new version of the employee.
+     *
+     * @return void
+     */
+    void replaceRow(size_t row, const Employee &e)
+    {
+        this->unindexRow(row);
+        this->employees[row] = e;
+        this->indexRow(row);
+        this->touchStore();
+        this->snapshots.publishRows(this->employees, this->searchKeys, {row}, this->generation);
+    }
+
+    /**
+     * @function dropRow
+     *
+     * @description - Takes the employee at a row out of the table, indexes, and snapshot. The
+     * last row moves into the hole, so only those two rows are reindexed.
+     *
+     * @param size_t row - The row.
+     *
+     * @return void
+     */
+    void dropRow(size_t row)
+    {
+        size_t last = this->employees.size() - 1;
+        this->unindexRow(row);
+        if (row != last)
+        {
+            this->unindexRow(last);
+            this->employees[row] = std::move(this->employees[last]);
+            this->searchKeys[row] = std::move(this->searchKeys[last]);
+        }
+        this->employees.pop_back();
+        this->searchKeys.pop_back();
+        for (int column = 0; column < NUMERIC_COLUMNS; ++column)
+        {
+            this->columns[column].resize(this->employees.size());
+        }
+        if (row != last)
+        {
+            this->indexRow(row, false);
+        }
+
+        this->touchStore();
+        std::vector<size_t> moved;
+        if (row != last)
+        {
+            moved.push_back(row);
+        }
+        this->snapshots.publishRows(this->employees, this->searchKeys, moved, this->generation);
+    }
+
+    /**
+     * @function refreshFromShared
+     *
+     * @description - Reads one employee from the shared store, by id or by username, and brings
+     * this replica's row up to date with it when the shared copy is a newer revision, or adds
+     * it if this replica hasn't seen it yet. An id this replica has seen removed is left for the
+     * log to bring back, the shared copy may be from before the remove. A shared store that was
+     * rebuilt is attached again once.
+     *
+     * @param int id - The id of the employee, used when username is null.
+     * @param string *username - The username of the employee, if looking up by username.
+     *
+     * @return void
+     */
+    void refreshFromShared(int id, const std::string *username)
+    {
+#if defined SHARED_STORE_POSIX
+        if (!this->sharedAttached)
+        {
+            return;
+        }
+
+        Employee e;
+        bool found = false;
+        for (int attempt = 0; attempt < 2 && !found; ++attempt)
+        {
+            found = username != nullptr ? this->shared.findUsername(*username, &e) : this->shared.find(id, &e);
+            std::string error;
+            if (!found && attempt == 0 && !this->shared.attach(error))
+            {
+                this->sharedAttached = false;
+                return;
+            }
+        }
+        if (!found)
+        {
+            return;
+        }
+
+        auto row = this->idIndex.find(e.id);
+        if (row == this->idIndex.end())
+        {
+            if (this->tombstones.count(e.id) == 0)
+            {
+                this->insertRow(e);
+                this->currentId = std::max(this->currentId, e.id);
+            }
+        }
+        else if (e.revision > this->employees[row->second].revision)
+        {
+            this->replaceRow(row->second, e);
+        }
+#else
+        (void)id;
+        (void)username;
+#endif
+    }
+
+    /**
+     * @function applyReplicated
+     *
+     * @description - Applies a change another session made to a replica's copy of the store.
+     * Safe to apply twice: an add for an id already held is an edit, an edit older than the
+     * held revision is skipped, and a remove of an id not held does nothing.
+     *
+     * @param ChangeEvent event - The change from the log.
+     *
+     * @return void
+     */
+    void applyReplicated(const ChangeEvent &event)
+    {
+        if (event.sequence <= this->appliedSequence)
+        {
+            return;
+        }
+        this->appliedSequence = event.sequence;
+
+        auto found = this->idIndex.find(event.id);
+        if (event.kind == "remove")
+        {
+            if (found != this->idIndex.end())
+            {
+                this->dropRow(found->second);
+            }
+        }
+        else if (found == this->idIndex.end())
+        {
+            this->insertRow(event.employee);
+            this->currentId = std::max(this->currentId, event.id);
+        }
+        else if (event.employee.revision >= this->employees[found->second].revision)
+        {
+            this->replaceRow(found->second, event.employee);
+        }
+
+        this->recordModification(event);
+    }
+
+    /**
+     * @function loadModificationCheckpoint
+     *
+     * @description - Fills the modification index from EMPLOYEE_CHANGES_CHECKPOINT, if it is
+     * whole and still matches the log: the line before its offset must be its sequence, which
+     * fails if the log was replaced. One saved past logSizeAtLoad holds changes the loaded
+     * records may not have, so it isn't used either. The file is:
+     *  - #checkpoint <sequence> <log offset> <entries> <CRC32C of the entry lines>
+     *  - <id> <sequence> <1 if removed, else 0>, one line per record
+     *
+     * @param unsigned long &sequence - Set to the last sequence in the checkpoint, left alone if there is none.
+     * @param streamoff &offset - Set to the log offset just after that sequence, left alone if there is none.
+     *
+     * @return bool - Returns true if the checkpoint was used.
+     */
+    bool loadModificationCheckpoint(unsigned long &sequence, std::streamoff &offset)
+    {
+        std::ifstream file(EMPLOYEE_CHANGES_CHECKPOINT, std::ios::binary);
+        std::string header;
+        if (!getline(file, header))
+        {
+            return false;
+        }
+
+        std::istringstream iss(header);
+        std::string mark;
+        unsigned long lastSequence = 0;
+        long long logOffset = 0;
+        size_t count = 0;
+        std::string checksum;
+        iss >> mark >> lastSequence >> logOffset >> count >> checksum;
+        std::string body((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (iss.fail() || mark != "#checkpoint" || std::strtoul(checksum.c_str(), nullptr, 16) != crc32c(body) ||
+            logOffset > this->logSizeAtLoad || ChangeFeed::lastLoggedSequence(logOffset) != lastSequence)
+        {
+            return false;
+        }
+
+        std::map<unsigned long, int> index;
+        std::unordered_map<int, unsigned long> of;
+        std::unordered_set<int> removed;
+        std::istringstream lines(body);
+        int id, isRemoved;
+        unsigned long changed;
+        while (lines >> id >> changed >> isRemoved)
+        {
+            index[changed] = id;
+            of[id] = changed;
+            if (isRemoved != 0)
+            {
+                removed.insert(id);
+            }
+        }
+        if (of.size() != count)
+        {
+            return false;
+        }
+
+        this->modSeqIndex.swap(index);
+        this->modSeqOf.swap(of);
+        this->tombstones.swap(removed);
+        sequence = lastSequence;
+        offset = logOffset;
+        return true;
+    }
+
+    /**
+     * @function saveModificationCheckpoint
+     *
+     * @description - Writes the modification index to EMPLOYEE_CHANGES_CHECKPOINT, see
+     * loadModificationCheckpoint. Written beside it and renamed over it under the log's lock,
+     * so sessions starting together don't mix their checkpoints.
+     *
+     * @param unsigned long sequence - The last sequence the index holds.
+     * @param streamoff offset - The log offset just after that sequence.
+     *
+     * @return bool - Returns true if the checkpoint was saved.
+     */
+    bool saveModificationCheckpoint(unsigned long sequence, std::streamoff offset)
+    {
+        std::ostringstream body;
+        for (const auto &entry : this->modSeqOf)
+        {
+            body << entry.first << " " << entry.second << " " << this->tombstones.count(entry.first) << "\n";
+        }
+        std::string lines = body.str();
+
+        char header[96];
+        std::snprintf(header, sizeof(header), "#checkpoint %lu %lld %zu %08x\n", sequence, (long long)offset,
+                      this->modSeqOf.size(), crc32c(lines));
+
+        if (!lockFile(EMPLOYEE_CHANGES_LOCK))
+        {
+            return false;
+        }
+        fs::path pending = EMPLOYEE_CHANGES_CHECKPOINT;
+        pending += ".tmp";
+        FILE *file = fopen(pending.string().c_str(), "wb");
+        bool written = file != nullptr && fputs(header, file) >= 0 &&
+                       fwrite(lines.data(), 1, lines.size(), file) == lines.size();
+        if (file != nullptr)
+        {
+            written = fclose(file) == 0 && written;
+        }
+        std::error_code ec;
+        if (written)
+        {
+            fs::rename(pending, EMPLOYEE_CHANGES_CHECKPOINT, ec);
+        }
+        if (!written || ec)
+        {
+            fs::remove(pending, ec);
+            written = false;
+        }
+        unlockFile(EMPLOYEE_CHANGES_LOCK);
+        return written;
+    }
+
+    /**
+     * @function recordModification
+     *
+     * @description - Moves a record to a new place in the modification index. Fed by the change
+     * feed, so every save and remove, from any path, lands here with its sequence.
+     *
+     * @param ChangeEvent event - The change.
+     *
+     * @return void
+     */
+    void recordModification(const ChangeEvent &event)
+    {
+        auto it = this->modSeqOf.find(event.id);
+        if (it != this->modSeqOf.end())
+        {
+            this->modSeqIndex.erase(it->second);
+        }
+
+        this->modSeqOf[event.id] = event.sequence;
+        this->modSeqIndex[event.sequence] = event.id;
+        if (event.kind == "remove")
+        {
+            this->tombstones.insert(event.id);
+        }
+        else
+        {
+            this->tombstones.erase(event.id);
+        }
+    }
+
+    /**
+     * @function changeEvent - static
+     *
+     * @description - Builds the change feed event for saving an employee.
+     *
+     * @param Employee saved - The employee as saved.
+     * @param Employee *previous - The stored employee before the save, nullptr for a new one.
+     *
+     * @return ChangeEvent - An add, an edit, or a permissions event if only the permissions changed.
+     */
+    static ChangeEvent changeEvent(const Employee &saved, const Employee *previous)
+    {
+        ChangeEvent event;
+        event.id = saved.id;
+        event.employee = saved;
+        event.kind = "add";
+
+        if (previous != nullptr)
+        {
+            Employee unchanged = *previous;
+            unchanged.updatePermissions(saved.getPermissions());
+            unchanged.revision = saved.revision;
+            bool onlyPermissions = previous->getPermissions() != saved.getPermissions() &&
+                                   unchanged.serialize() == saved.serialize();
+            event.kind = onlyPermissions ? "permissions" : "edit";
+        }
+
+        return event;
+    }
+
+    /**
+     * @function writeJournal - static
+     *
+     * @description - Writes a journal record holding every employee in a transaction and waits
+     * for it to reach the disk. The record is written to a temporary file and renamed into
+     * place, so EMPLOYEE_JOURNAL is either absent or a whole record:
+     *  - #journal <count>
+     *  - the file contents of each employee
+     *  - #commit <count>
+     *
+     * @param vector<Employee> changes - The employees to save.
+     *
+     * @return bool - Returns true once the record is durable, which is the commit point.
+     */
+    static bool writeJournal(const std::vector<Employee> &changes)
+    {
+        fs::path pending = EMPLOYEE_JOURNAL;
+        pending += ".tmp";
+
+        FILE *journal = fopen(pending.string().c_str(), "wb");
+        if (journal == nullptr)
+        {
+            return false;
+        }
+
+        std::ostringstream oss;
+        oss << "#journal " << changes.size() << std::endl;
+        for (const Employee &e : changes)
+        {
+            oss << e.serialize();
+        }
+        oss << "#commit " << changes.size() << std::endl;
+
+        std::string record = oss.str();
+        bool written = fwrite(record.data(), 1, record.size(), journal) == record.size() && syncFile(journal);
+        fclose(journal);
+
+        std::error_code ec;
+        if (written)
+        {
+            fs::rename(pending, EMPLOYEE_JOURNAL, ec);
+        }
+        if (!written || ec)
+        {
+            fs::remove(pending, ec);
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * @function replayJournal - static
+     *
+     * @description - Finishes a transaction that was committed but not applied when the
+     * application last stopped, by writing every employee in the journal again. A journal without
+     * its commit line, or a leftover temporary file, was never committed and is thrown away. The
+     * journal is only removed once every employee is written and on disk, otherwise it is kept
+     * for the next start. A committed journal with a record failing its checksum can't be applied
+     * or dropped, it is moved to EMPLOYEE_QUARANTINE and reported like a damaged employee file.
+     * A journal whose lock can't be taken belongs to a session still committing it, and is left
+     * to that session.
+     *
+     * @return void
+     */
+    static void replayJournal()
+    {
+        if (!lockFile(EMPLOYEE_JOURNAL_LOCK))
+        {
+            return;
+        }
+        replayLockedJournal();
+        unlockFile(EMPLOYEE_JOURNAL_LOCK);
+    }
+
+    /**
+     * @function replayLockedJournal - static
+     *
+     * @description - The body of replayJournal, run with EMPLOYEE_JOURNAL_LOCK held.
+     *
+     * @return void
+     */
+    static void replayLockedJournal()
+    {
+        fs::path pending = EMPLOYEE_JOURNAL;
+        pending += ".tmp";
+        std::error_code ec;
+        fs::remove(pending, ec);
+
+        std::ifstream journal(EMPLOYEE_JOURNAL);
+        if (!journal)
+        {
+            return;
+        }
+
+        std::vector<Employee> changes;
+        size_t expected = 0;
+        bool committed = false;
+        bool intact = true;
+        int version = 1;
+        std::string line, versionLine;
+        while (getline(journal, line))
+        {
+            if (line.compare(0, 9, "#journal ") == 0)
+            {
+                expected = std::strtoul(line.c_str() + 9, nullptr, 10);
+            }
+            else if (line.compare(0, 8, "#commit ") == 0)
+            {
+                committed = std::strtoul(line.c_str() + 8, nullptr, 10) == expected && changes.size() == expected;
+            }
+            else if (line.compare(0, 2, "#v") == 0)
+            {
+                versionLine = line;
+                version = std::atoi(line.c_str() + 2);
+            }
+            else
+            {
+                Employee e;
+                intact = intact && Employee::checksumMatches(versionLine, line);
+                if (Employee::parseRecord(line, version, &e))
+                {
+                    changes.push_back(e);
+                }
+            }
+        }
+        journal.close();
+
+        // A damaged record means the journal can't be trusted, so none of it is applied.
+        if (committed && !intact)
+        {
+            fs::create_directories(EMPLOYEE_QUARANTINE, ec);
+            fs::path target = EMPLOYEE_QUARANTINE / EMPLOYEE_JOURNAL.filename();
+            for (int n = 1; fs::exists(target); ++n)
+            {
+                target = EMPLOYEE_QUARANTINE / (EMPLOYEE_JOURNAL.filename().string() + "." + std::to_string(n));
+            }
+            fs::rename(EMPLOYEE_JOURNAL, target, ec);
+            std::cout << "The transaction in " << EMPLOYEE_JOURNAL.string() << " fails its checksum and was not applied, "
+                      << (ec ? "it was left in place." : "it was moved to " + target.string() + ".") << std::endl;
+            return;
+        }
+        if (committed)
+        {
+            bool written = true;
+            for (Employee &e : changes)
+            {
+                written = e.write() && written;
+            }
+            if (!written || !syncDirectory(EMPLOYEE_DIR))
+            {
+                std::cout << "Could not finish the transaction in " << EMPLOYEE_JOURNAL.string()
+                          << ", it will be tried again on the next start." << std::endl;
+                return;
+            }
+        }
+
+        fs::remove(EMPLOYEE_JOURNAL, ec);
+    }
+
+    void loadScreens()
+    {
+        std::unique_ptr<Screen> loginScreen = std::make_unique<LoginScreen>(this);
+        this->screens[loginScreen->name] = std::move(loginScreen);
+
+        std::unique_ptr<Screen> menuScreen = std::make_unique<MenuScreen>(this);
+        this->screens[menuScreen->name] = std::move(menuScreen);
+
+        std::unique_ptr<Screen> listScreen = std::make_unique<ListScreen>(this);
+        this->screens[listScreen->name] = std::move(listScreen);
+
+        std::unique_ptr<Screen> searchScreen = std::make_unique<SearchScreen>(this);
+        this->screens[searchScreen->name] = std::move(searchScreen);
+
+        std::unique_ptr<Screen> addEmployeeScreen =
+            std::make_unique<AddEmployeeScreen>(this);
+        this->screens[addEmployeeScreen->name] = std::move(addEmployeeScreen);
+
+        std::unique_ptr<Screen> fileScreen = std::make_unique<FileScreen>(this);
+        this->screens[fileScreen->name] = std::move(fileScreen);
+
+        std::unique_ptr<Screen> departmentScreen = std::make_unique<DepartmentScreen>(this);
+        this->screens[departmentScreen->name] = std::move(departmentScreen);
+
+        std::unique_ptr<Screen> payrollScreen = std::make_unique<PayrollScreen>(this);
+        this->screens[payrollScreen->name] = std::move(payrollScreen);
+
+        std::unique_ptr<Screen> reorgScreen = std::make_unique<ReorgScreen>(this);
+        this->screens[reorgScreen->name] = std::move(reorgScreen);
+
+        std::unique_ptr<Screen> archiveScreen = std::make_unique<ArchiveScreen>(this);
+        this->screens[archiveScreen->name] = std::move(archiveScreen);
+
+        std::unique_ptr<Screen> undoScreen = std::make_unique<UndoScreen>(this);
+        this->screens[undoScreen->name] = std::move(undoScreen);
+    }
+
+public:
+    TaskPool pool;
+    ChangeFeed changes;
+    AuditLog audit;
+    std::vector<Employee> employees;
+    int currentId;
+
+    Application()
+    {
+        this->currentId = 1;
+        this->generation = 0;
+        this->replayingUndo = false;
+        this->replica = false;
+        this->appliedSequence = 0;
+#if defined SHARED_STORE_POSIX
+        this->sharedAttached = false;
+#endif
+        // Anything logged after this may not be in the files about to be loaded.
+        this->logSizeAtLoad = ChangeTail::logSize();
+        this->loadedSequence = ChangeFeed::lastLoggedSequence(this->logSizeAtLoad);
+
+        // We check if path exists and if not, we create. If we get into the if we
+        // can return becuase we know that there are no employee files.
+        if (!fs::exists(EMPLOYEE_DIR))
+        {
+            fs::create_directory(EMPLOYEE_DIR);
+            /* THIS IS ONLY FOR TESTING/GRADING: Create file for inital login.
+             * - Username: testing
+             * - Password: password
+             */
+            Employee newEmployee(1, "Titus", "Moore", "testing", "password",
+                                 HR_PERMS | MANAGEMENT_PERMS | GENERAL_PERMS);
+            newEmployee.write();
+        }
+
+        replayJournal();
+
+        // Iterates through employee directory to collect the files, then calls
+        // Employee::from on the pool to get an instance of Employee for each one.
+        std::vector<fs::path> employeeFiles;
+        std::unordered_set<int> removedSincePacking;
+        for (const auto &employeeFile : fs::directory_iterator(EMPLOYEE_DIR))
+        {
+            if (employeeFile.path().extension() == ".txt")
+            {
+                employeeFiles.push_back(employeeFile.path());
+            }
+            else if (employeeFile.path().extension() == ".removed")
+            {
+                removedSincePacking.insert(std::atoi(employeeFile.path().stem().string().c_str()));
+            }
+        }
+
+        this->employees.resize(employeeFiles.size());
+        std::vector<char> loaded(employeeFiles.size());
+        std::vector<std::string> errors(employeeFiles.size());
+        this->pool.parallelFor(0, employeeFiles.size(), 64, [&](size_t lo, size_t hi)
+                               {
+            for (size_t i = lo; i < hi; ++i)
+            {
+                loaded[i] = Employee::from(employeeFiles[i], &this->employees[i], &errors[i]);
+            } });
+
+        // Damaged files are left out rather than loaded half filled, --fsck repairs or quarantines them.
+        size_t kept = 0;
+        for (size_t i = 0; i < employeeFiles.size(); ++i)
+        {
+            if (!loaded[i])
+            {
+                std::cout << "Employee file " << employeeFiles[i].filename().string() << " " << errors[i]
+                          << ", run --fsck repair." << std::endl;
+                continue;
+            }
+
+            if (this->employees[i].id > this->currentId)
+            {
+                this->currentId = this->employees[i].id;
+            }
+            if (kept != i)
+            {
+                this->employees[kept] = std::move(this->employees[i]);
+            }
+            kept++;
+        }
+        this->employees.resize(kept);
+
+        // Packed employees fill in behind the files, which are newer.
+        std::vector<Employee> packed;
+        if (this->pack.open() && !this->pack.loadAll(this->pool, packed))
+        {
+            std::cout << "The employee pack is damaged, run --fsck check." << std::endl;
+        }
+        if (!packed.empty())
+        {
+            std::unordered_set<int> saved;
+            for (const Employee &e : this->employees)
+            {
+                saved.insert(e.id);
+            }
+            for (Employee &e : packed)
+            {
+                this->packedIds.insert(e.id);
+                if (saved.count(e.id) == 0 && removedSincePacking.count(e.id) == 0)
+                {
+                    this->currentId = std::max(this->currentId, e.id);
+                    this->employees.push_back(std::move(e));
+                }
+            }
+        }
+
+        this->rebuildIndexes();
+        this->snapshots.publishAll(this->employees, this->searchKeys, this->generation);
+
+        // Replays the change log after the checkpoint into the modification index, up to what the
+        // loaded records hold, then keeps it current with this session's changes. Changes other
+        // sessions logged since the load aren't in the loaded records, so their sequences aren't
+        // indexed and an export never gives a loaded record a newer sequence than its own.
+        unsigned long seen = 0;
+        std::streamoff from = 0, end = 0;
+        this->loadModificationCheckpoint(seen, from);
+        std::vector<ChangeEvent> replayed = ChangeFeed::readLog(seen, from, &end, this->logSizeAtLoad);
+        for (const ChangeEvent &event : replayed)
+        {
+            this->recordModification(event);
+            seen = event.sequence;
+        }
+        if (replayed.size() >= CHECKPOINT_AFTER_EVENTS)
+        {
+            this->saveModificationCheckpoint(seen, end);
+        }
+        std::streamoff now = ChangeTail::logSize();
+        unsigned long nowSequence = ChangeFeed::lastLoggedSequence(now);
+        this->changes.subscribe([this](const ChangeEvent &event)
+                                { this->recordModification(event); },
+                                nowSequence, now);
+        // History only needs changes from now on, earlier ones were recorded when they were made.
+        this->changes.subscribe([](const ChangeEvent &event)
+                                { RecordHistory::append(event); },
+                                nowSequence, now);
+
+        loadScreens();
+    }
+
+    /**
+     * @function start
+     *
+     * @description - This function is run after everything has been setup, and
+     * handles loading the first screen.
+     *
+     * @return void
+     *
+     */
+    void start() { this->screens.at("login")->display(); }
+
+    /**
+     * @function navigateToScreen
+     *
+     * @description - This function handles looking up a screen by key (name) and
+     * printing it.
+     *
+     * @param screeenName string - The key of the screen to display.
+     *
+     * @return void
+     *
+     */
+    void navigateToScreen(std::string screenName)
+    {
+        this->catchUp();
+        if (this->screens.count(screenName) != 0)
+        {
+            this->screens.at(screenName)->display();
+        }
+    }
+
+    /**
+     * @function getLoggedInEmployee
+     * 
+     * @description - This function will return the employee object that is currently logged in.
+     * 
+     * @return Employee * - The employee object that is currently logged in.
+     * 
+    */
+    Employee *getLoggedInEmployee() { return &this->employee; }
+
+    /**
+     * @function login
+     *
+     * @description - This function will handle the login process for the
+     * application.
+     *
+     * @param string username - The username that the user has entered.
+     * @param string password - The password that the user has entered.
+     *
+     * @return bool - Returns true if the login was successful, false otherwise.
+     *
+     */
+    bool login(std::string username, std::string password)
+    {
+        this->catchUp();
+        if (this->replica)
+        {
+            this->refreshFromShared(0, &username);
+        }
+        auto range = this->usernameIndex.equal_range(foldKey(username));
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            Employee *e = this->findEmployeeById(it->second);
+            if (e != nullptr && e->isValidLogin(username, password))
+            {
+                this->employee = *e;
+                this->audit.record(AUDIT_LOGIN, e->id, e->id);
+                return true;
+            }
+        }
+
+        // Nobody is signed in, the target is who they tried to sign in as, if anyone.
+        this->audit.record(AUDIT_LOGIN_FAILED, 0, range.first == range.second ? 0 : range.first->second);
+        return false;
+    }
+
+    /**
+     * @function findEmployeeById
+     * 
+     * @description - This function will find an employee by their id.
+     * 
+     * @param int id - The id of the employee to find.
+     * 
+     * @return Employee * - The employee object that was found, or nullptr if not found.
+     * 
+    */
+    Employee *findEmployeeById(int id)
+    {
+        auto it = this->idIndex.find(id);
+        if (it == this->idIndex.end())
+        {
+            return nullptr;
+        }
+
+        return &this->employees[it->second];
+    }
+
+    /**
+     * @function addEmployee
+     *
+     * @description - Writes a new employee to its file and adds it to the store. Another session
+     * may have added an employee with the same id since it was picked, so the id must have no file
+     * under the record lock. A taken id is loaded into the store and the next free one is tried.
+     *
+     * @param Employee e - The employee to add, with its id already assigned.
+     *
+     * @return bool - Returns true if the employee was saved.
+     */
+    bool addEmployee(Employee e)
+    {
+        e.revision = 1;
+        if (this->replica)
+        {
+            return false;
+        }
+        while (true)
+        {
+            if (!lockRecord(e.id))
+            {
+                return false;
+            }
+            Employee taken;
+            int state = this->readStored(e.id, &taken);
+            if (state == -1)
+            {
+                break;
+            }
+            unlockRecord(e.id);
+
+            if (state == 0 && this->idIndex.count(e.id) == 0)
+            {
+                this->insertRow(taken);
+            }
+            this->currentId = std::max(this->currentId, e.id);
+            e.id = ++this->currentId;
+        }
+        if (!e.write())
+        {
+            unlockRecord(e.id);
+            return false;
+        }
+
+        this->insertEmployee(e);
+        unlockRecord(e.id);
+        this->recordUndo(UNDO_ADD, Employee(), e);
+
+        return true;
+    }
+
+    /**
+     * @function restoreEmployee
+     *
+     * @description - Brings a removed employee back from the archive into the store. The file is
+     * written before the employee leaves the archive, so a failure never loses them.
+     *
+     * @param int id - The id of the archived employee.
+     * @param string &error - Set to the reason when the employee isn't restored.
+     *
+     * @return bool - Returns true if the employee is back in the store.
+     */
+    bool restoreEmployee(int id, std::string &error)
+    {
+        ArchivedEmployee entry;
+        if (this->replica)
+        {
+            error = REPLICA_READ_ONLY;
+            return false;
+        }
+        if (this->idIndex.count(id) != 0)
+        {
+            error = "An employee with that id already exists.";
+            return false;
+        }
+        if (!this->archive.find(id, &entry))
+        {
+            error = "No archived employee has that id.";
+            return false;
+        }
+        if (!this->usernameOwners(entry.employee.username).empty())
+        {
+            error = "Username \"" + entry.employee.username + "\" has been taken since the employee was removed.";
+            return false;
+        }
+
+        if (!lockRecord(id))
+        {
+            error = "The employee is being saved by someone else, try again.";
+            return false;
+        }
+        entry.employee.revision++;
+        if (!entry.employee.write())
+        {
+            unlockRecord(id);
+            error = "Could not write the employee file.";
+            return false;
+        }
+        // Taking them out failing would leave them both in the store and the archive.
+        ArchivedEmployee taken;
+        if (!this->archive.take(id, &taken))
+        {
+            std::error_code ec;
+            fs::remove(entry.employee.file, ec);
+            unlockRecord(id);
+            error = "Could not take the employee out of the archive.";
+            return false;
+        }
+
+        this->insertEmployee(entry.employee);
+        unlockRecord(id);
+        this->audit.record(AUDIT_RESTORE, this->employee.id, id);
+        this->recordUndo(UNDO_ADD, Employee(), entry.employee);
+
+        return true;
+    }
+
+    /**
+     * @function undo
+     *
+     * @description - Reverses the last change made in this session that hasn't been undone.
+     *
+     * @param string &error - Set to the reason when nothing was undone.
+     *
+     * @return bool - Returns true if a change was undone.
+     */
+    bool undo(std::string &error)
+    {
+        UndoStep step;
+        if (!this->undoJournal.takeUndo(step))
+        {
+            error = "Nothing to undo.";
+            return false;
+        }
+
+        bool applied = this->applyUndoStep(step, true, error);
+        if (applied)
+        {
+            this->undoJournal.pushRedo(std::move(step));
+        }
+        else
+        {
+            this->undoJournal.pushUndo(std::move(step));
+        }
+        return applied;
+    }
+
+    /**
+     * @function redo
+     *
+     * @description - Repeats the last change undone, if nothing was changed since.
+     *
+     * @param string &error - Set to the reason when nothing was redone.
+     *
+     * @return bool - Returns true if a change was redone.
+     */
+    bool redo(std::string &error)
+    {
+        UndoStep step;
+        if (!this->undoJournal.takeRedo(step))
+        {
+            error = "Nothing to redo.";
+            return false;
+        }
+
+        bool applied = this->applyUndoStep(step, false, error);
+        if (applied)
+        {
+            this->undoJournal.pushUndo(std::move(step));
+        }
+        else
+        {
+            this->undoJournal.pushRedo(std::move(step));
+        }
+        return applied;
+    }
+
+    const UndoStep *nextUndo() const { return this->undoJournal.nextUndo(); }
+
+    const UndoStep *nextRedo() const { return this->undoJournal.nextRedo(); }
+
+    /**
+     * @function startBackup
+     *
+     * @description - Backs up the store on a background thread. The backup is taken from a
+     * pinned snapshot, so it is consistent as of the call and never blocks saves, in this session
+     * or any other, which keep running while it is written. The sequence stored with it is the
+     * last change the snapshot is known to hold: the one logged before the store was loaded, or
+     * the last a replica applied. Changes this session made are in the snapshot too, but other
+     * sessions' changes it never loaded may be logged between them, so they don't move it.
+     *
+     * @param path target - Where to write the backup.
+     *
+     * @return future<bool> - Becomes true once the backup is complete on disk.
+     */
+    std::future<bool> startBackup(const fs::path &target)
+    {
+        SnapshotStore::Snapshot snapshot = this->snapshots.pin();
+        unsigned long sequence = std::max(this->loadedSequence, this->appliedSequence);
+        return std::async(std::launch::async, [snapshot = std::move(snapshot), sequence, target]
+                          { return writeBackup(snapshot, sequence, target); });
+    }
+
+    /**
+     * @function restoreBackup
+     *
+     * @description - Makes the store match a backup. Only records that differ are written, all
+     * together through commitTransaction so they land or not as one, and employees missing from
+     * the backup are removed to the archive. Restored records get a new revision, so a session
+     * still editing the old one gets a conflict instead of overwriting the restore.
+     *
+     * @param path source - The backup file.
+     * @param string &error - Set to the reason when nothing was restored.
+     * @param size_t &written - Set to how many employees were restored.
+     * @param size_t &removed - Set to how many employees were removed.
+     *
+     * @return bool - Returns true if the store matches the backup.
+     */
+    bool restoreBackup(const fs::path &source, std::string &error, size_t &written, size_t &removed)
+    {
+        std::vector<Employee> backup;
+        unsigned long sequence;
+        written = 0;
+        removed = 0;
+        if (!readBackup(source, backup, sequence))
+        {
+            error = "The backup is damaged or incomplete.";
+            return false;
+        }
+
+        std::vector<Employee> changes;
+        std::unordered_set<int> kept;
+        for (Employee &e : backup)
+        {
+            kept.insert(e.id);
+            Employee *current = this->findEmployeeById(e.id);
+            if (current != nullptr)
+            {
+                e.revision = current->revision;
+                if (current->serialize() == e.serialize())
+                {
+                    continue;
+                }
+            }
+            changes.push_back(e);
+        }
+
+        std::vector<int> missing;
+        for (const Employee &e : this->employees)
+        {
+            if (kept.count(e.id) == 0)
+            {
+                missing.push_back(e.id);
+            }
+        }
+
+        if (!this->commitTransaction(changes, error))
+        {
+            return false;
+        }
+        written = changes.size();
+
+        // Managers can only go once their reports have, so passes repeat while any are removed.
+        size_t before;
+        do
+        {
+            before = missing.size();
+            std::vector<int> refused;
+            for (int id : missing)
+            {
+                if (this->removeEmployeeById(id))
+                {
+                    removed++;
+                }
+                else
+                {
+                    refused.push_back(id);
+                }
+            }
+            missing.swap(refused);
+        } while (!missing.empty() && missing.size() < before);
+        return true;
+    }
+
+    /**
+     * @function startReplica
+     *
+     * @description - Makes this session a read only replica. It keeps serving logins, lists, and
+     * searches from memory while other sessions make changes, and follows their changes through
+     * the change log instead of loading the directory again. The log is read from where it was
+     * when the files were loaded, so nothing saved while loading is missed.
+     *
+     * @return void
+     */
+    void startReplica()
+    {
+        this->replica = true;
+        this->tail.start(this->logSizeAtLoad);
+    }
+
+    bool isReplica() const { return this->replica; }
+
+    /**
+     * @function useSharedStore
+     *
+     * @description - Lets a replica read logins and lookups from the SharedStore a --share
+     * process keeps for this directory, which follows the log on its own, so a change this
+     * replica's tail hasn't brought yet may already be there. Without one, or off POSIX, the
+     * replica uses only its own copy.
+     *
+     * @return bool - Returns true if a shared store was found.
+     */
+    bool useSharedStore()
+    {
+#if defined SHARED_STORE_POSIX
+        std::string error;
+        this->sharedAttached = this->replica && this->shared.attach(error);
+        return this->sharedAttached;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @function lookupEmployee
+     *
+     * @description - Finds an employee by id for a screen. On a replica with a shared store the
+     * row is first brought up to date from it, see refreshFromShared. Only called between
+     * screens, never while rows are being walked, since the row may be replaced.
+     *
+     * @param int id - The id of the employee to find.
+     *
+     * @return Employee * - The employee, or nullptr if not found.
+     */
+    Employee *lookupEmployee(int id)
+    {
+        this->refreshFromShared(id, nullptr);
+        return this->findEmployeeById(id);
+    }
+
+    /**
+     * @function catchUp
+     *
+     * @description - Applies the changes the replica's tail has read since the last call. Run on
+     * the main thread before each screen and login, so the lag is at most REPLICA_POLL_MS when a
+     * screen is shown. Does nothing unless this is a replica.
+     *
+     * @return void
+     */
+    void catchUp()
+    {
+        if (!this->replica)
+        {
+            return;
+        }
+
+        for (const ChangeEvent &event : this->tail.take())
+        {
+            this->applyReplicated(event);
+        }
+    }
+
+    /**
+     * @function packStore
+     *
+     * @description - Packs every employee into EMPLOYEE_PACK, then deletes the files the pack
+     * now holds. What is packed is read from disk under each record lock, not taken from memory:
+     * the employee's file if it has one, else the packed copy it was loaded from unless it has
+     * been marked removed. An employee another session removed since this one loaded is left out.
+     * Each file is only deleted, under its record lock, if it is still the revision that was
+     * packed, so a save made meanwhile keeps its file and wins over the pack. A file removed
+     * after it was packed gets a marker, so the packed copy doesn't come back. Markers for
+     * employees not in the new pack are no longer needed and are deleted too.
+     *
+     * @param string &error - Set to the reason when nothing was packed.
+     *
+     * @return size_t - How many employee files were folded into the pack.
+     */
+    size_t packStore(std::string &error)
+    {
+        if (!lockFile(EMPLOYEE_PACK_LOCK))
+        {
+            error = "The store is being packed by someone else.";
+            return 0;
+        }
+
+        std::vector<Employee> packing;
+        std::vector<char> fromFile;
+        std::error_code ec;
+        packing.reserve(this->employees.size());
+        for (const Employee &e : this->employees)
+        {
+            fs::path file = EMPLOYEE_DIR / (std::to_string(e.id) + ".txt");
+            if (!lockRecord(e.id))
+            {
+                unlockFile(EMPLOYEE_PACK_LOCK);
+                error = "Employee " + std::to_string(e.id) + " is being saved by someone else, try again.";
+                return 0;
+            }
+            Employee stored;
+            if (Employee::from(file, &stored))
+            {
+                packing.push_back(stored);
+                fromFile.push_back(1);
+            }
+            else if (fs::exists(file, ec))
+            {
+                // Damaged, the file still wins over the pack until --fsck deals with it.
+                packing.push_back(e);
+                fromFile.push_back(1);
+            }
+            else if (this->packedIds.count(e.id) != 0 && !fs::exists(removedMarkerPath(e.id), ec))
+            {
+                packing.push_back(e);
+                fromFile.push_back(0);
+            }
+            unlockRecord(e.id);
+        }
+
+        if (!PackStore::write(packing, EMPLOYEE_PACK) || !this->pack.open())
+        {
+            unlockFile(EMPLOYEE_PACK_LOCK);
+            error = "Could not write the pack.";
+            return 0;
+        }
+
+        size_t folded = 0;
+        for (size_t i = 0; i < packing.size(); ++i)
+        {
+            const Employee &e = packing[i];
+            fs::path file = EMPLOYEE_DIR / (std::to_string(e.id) + ".txt");
+            if (!lockRecord(e.id))
+            {
+                continue;
+            }
+            Employee stored;
+            if (Employee::from(file, &stored) && stored.revision == e.revision)
+            {
+                fs::remove(file, ec);
+                fs::remove(removedMarkerPath(e.id), ec);
+                folded++;
+            }
+            else if (fromFile[i] && !fs::exists(file, ec))
+            {
+                FILE *marker = fopen(removedMarkerPath(e.id).string().c_str(), "w");
+                if (marker != nullptr)
+                {
+                    fclose(marker);
+                }
+            }
+            unlockRecord(e.id);
+        }
+
+        this->packedIds.clear();
+        for (const Employee &e : packing)
+        {
+            this->packedIds.insert(e.id);
+        }
+
+        for (const auto &entry : fs::directory_iterator(EMPLOYEE_DIR, ec))
+        {
+            Employee packed;
+            if (entry.path().extension() == ".removed" &&
+                !this->pack.find(std::atoi(entry.path().stem().string().c_str()), &packed))
+            {
+                fs::remove(entry.path(), ec);
+            }
+        }
+        unlockFile(EMPLOYEE_PACK_LOCK);
+
+        return folded;
+    }
+
+    /**
+     * @function benchmarkPack
+     *
+     * @description - Measures the packed store on the loaded employees without touching the real
+     * one: size against the employee files, with and without the dictionary, time to decompress
+     * everything, and time to look up single employees by id.
+     *
+     * @param size_t lookups - How many random lookups to time.
+     * @param ostream &out - Where the results are printed.
+     *
+     * @return bool - Returns false if the trial packs couldn't be written.
+     */
+    bool benchmarkPack(size_t lookups, std::ostream &out)
+    {
+        fs::path trial = EMPLOYEE_PACK;
+        trial += ".bench";
+        fs::path plain = EMPLOYEE_PACK;
+        plain += ".bench-plain";
+
+        size_t textBytes = 0;
+        for (const Employee &e : this->employees)
+        {
+            textBytes += e.serialize().size();
+        }
+
+        auto started = std::chrono::steady_clock::now();
+        bool written = PackStore::write(this->employees, trial) && PackStore::write(this->employees, plain, false);
+        double packSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        std::error_code ec;
+        PackStore bench(trial);
+        if (!written || !bench.open())
+        {
+            fs::remove(trial, ec);
+            fs::remove(plain, ec);
+            return false;
+        }
+        uintmax_t packedBytes = fs::file_size(trial, ec);
+        uintmax_t plainBytes = fs::file_size(plain, ec);
+
+        // Decompressing on one thread shows the codec's speed rather than the pool's.
+        TaskPool single(1);
+        std::vector<Employee> decoded;
+        started = std::chrono::steady_clock::now();
+        bench.loadAll(single, decoded);
+        double decodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        started = std::chrono::steady_clock::now();
+        size_t rawBytes = bench.decompressAll();
+        double codecSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        std::mt19937 random(7);
+        size_t found = 0;
+        started = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < lookups && !this->employees.empty(); ++i)
+        {
+            Employee e;
+            found += bench.find(this->employees[random() % this->employees.size()].id, &e);
+        }
+        double lookupSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        fs::remove(trial, ec);
+        fs::remove(plain, ec);
+
+        out << "Employees: " << this->employees.size() << " in " << bench.blockCount() << " blocks" << std::endl
+            << "Text bytes: " << textBytes << std::endl
+            << "Packed bytes: " << packedBytes << " (" << (textBytes ? 100.0 * packedBytes / textBytes : 0) << "%)" << std::endl
+            << "Without dictionary: " << plainBytes << " (" << (textBytes ? 100.0 * plainBytes / textBytes : 0) << "%)" << std::endl
+            << "Pack time: " << packSeconds << " s for both" << std::endl
+            << "Decompress: " << (codecSeconds > 0 ? rawBytes / codecSeconds / 1e6 : 0) << " MB/s" << std::endl
+            << "Decode: " << decoded.size() << " employees, " << (decodeSeconds > 0 ? decoded.size() / decodeSeconds : 0) << " per second" << std::endl
+            << "Lookups: " << found << "/" << lookups << ", "
+            << (lookups ? lookupSeconds * 1e6 / lookups : 0) << " us each" << std::endl;
+        return true;
+    }
+
+#if defined SHARED_STORE_POSIX
+    /**
+     * @function shareStore
+     *
+     * @description - Puts the employees in a SharedStore and keeps it up to date until the
+     * process is interrupted, so other processes can read them without loading the files. Like
+     * a replica, this follows the change log rather than making changes, and each change is
+     * written into the segment in place. If the segment fills up it is built again, larger.
+     *
+     * @param ostream &out - Where progress is printed.
+     *
+     * @return bool - Returns false if the segment couldn't be built.
+     */
+    bool shareStore(std::ostream &out)
+    {
+        SharedStore store;
+        std::string error;
+        if (!store.create(this->employees, error))
+        {
+            out << error << std::endl;
+            return false;
+        }
+
+        this->startReplica();
+        sharingStopped = 0;
+        signal(SIGINT, stopSharing);
+        signal(SIGTERM, stopSharing);
+        out << "Sharing " << this->employees.size() << " employees as " << SharedStore::segmentName()
+            << ", stop with Ctrl+C." << std::endl;
+
+        while (!sharingStopped)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(REPLICA_POLL_MS));
+            for (const ChangeEvent &event : this->tail.take())
+            {
+                this->applyReplicated(event);
+                Employee *current = this->findEmployeeById(event.id);
+                bool stored = current != nullptr ? store.put(*current) : store.remove(event.id);
+                if (!stored && !store.create(this->employees, error))
+                {
+                    out << error << std::endl;
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+#endif
+
+    /**
+     * @function checkStore
+     *
+     * @description - Checks every file in the employee directory, like fsck does a disk. Files
+     * are read and checked in parallel on the pool, see checkRecordFile, then ids and usernames
+     * are compared across them. Each problem is printed with what was done about it:
+     *  - FSCK_CHECK only reports.
+     *  - FSCK_QUARANTINE moves files that can't be trusted to EMPLOYEE_QUARANTINE, and removes
+     *    leftover partial writes.
+     *  - FSCK_REPAIR also rewrites readable records with a problem in the current format, under
+     *    their own id. Duplicate usernames need a person to pick one and are only reported.
+     *    Before rewriting, the file is read again under the record lock and left alone if another
+     *    session saved it since the check. Records in an older format are rewritten the same way.
+     *
+     * Notices, like a record from before checksums, are printed but aren't problems.
+     *
+     * @param int mode - FSCK_CHECK, FSCK_REPAIR, or FSCK_QUARANTINE.
+     * @param ostream &out - Where problems are printed.
+     *
+     * @return FsckReport - Totals.
+     */
+    FsckReport checkStore(int mode, std::ostream &out)
+    {
+        std::vector<fs::path> files, leftovers;
+        for (const auto &entry : fs::directory_iterator(EMPLOYEE_DIR))
+        {
+            if (entry.path().extension() == ".txt")
+            {
+                files.push_back(entry.path());
+            }
+            else if (entry.path().extension() == ".tmp")
+            {
+                leftovers.push_back(entry.path());
+            }
+        }
+        std::sort(files.begin(), files.end());
+
+        std::vector<RecordCheck> checks(files.size());
+        this->pool.parallelFor(0, files.size(), 64, [&](size_t lo, size_t hi)
+                               {
+            for (size_t i = lo; i < hi; ++i)
+            {
+                checks[i] = checkRecordFile(files[i]);
+            } });
+
+        // Across files: a second file for an id, or a username used twice.
+        std::unordered_map<int, size_t> ownerOfId;
+        std::unordered_map<std::string, size_t> ownerOfUsername;
+        for (size_t i = 0; i < checks.size(); ++i)
+        {
+            if (checks[i].readable && checks[i].file.stem() == std::to_string(checks[i].employee.id))
+            {
+                ownerOfId[checks[i].employee.id] = i;
+            }
+        }
+        for (size_t i = 0; i < checks.size(); ++i)
+        {
+            RecordCheck &check = checks[i];
+            if (!check.readable)
+            {
+                continue;
+            }
+
+            auto owner = ownerOfId.emplace(check.employee.id, i);
+            if (owner.first->second != i)
+            {
+                check.readable = false;
+                check.problems.push_back("duplicates " + checks[owner.first->second].file.filename().string());
+                continue;
+            }
+
+            auto user = ownerOfUsername.emplace(foldKey(check.employee.username), i);
+            if (!user.second)
+            {
+                check.problems.push_back("has username " + check.employee.username + " also used by employee " +
+                                         std::to_string(checks[user.first->second].employee.id));
+            }
+        }
+
+        FsckReport report;
+        report.checked = files.size();
+        std::error_code ec;
+        if (this->pack.isPresent())
+        {
+            // A damaged pack can't be repaired here, only packed again from a backup.
+            std::vector<size_t> damaged = this->pack.damagedBlocks();
+            for (size_t block : damaged)
+            {
+                report.problems++;
+                out << EMPLOYEE_PACK.string() << ": block " << block << " fails its checksum" << std::endl;
+            }
+
+            // Packed employees are only live without a file or a removed marker, those get the
+            // same checks across records as the files. They are only reported, a pack is rewritten whole.
+            std::vector<Employee> packed;
+            std::unordered_map<int, int> packedOwnerOfId;
+            std::unordered_map<std::string, int> packedOwnerOfUsername;
+            if (damaged.empty() && this->pack.loadAll(this->pool, packed))
+            {
+                for (const Employee &e : packed)
+                {
+                    if (ownerOfId.count(e.id) != 0 || fs::exists(removedMarkerPath(e.id), ec))
+                    {
+                        continue;
+                    }
+                    report.packed++;
+
+                    std::string problem;
+                    auto owner = packedOwnerOfId.emplace(e.id, e.id);
+                    auto fileUser = ownerOfUsername.find(foldKey(e.username));
+                    auto packedUser = packedOwnerOfUsername.emplace(foldKey(e.username), e.id);
+                    if (!owner.second)
+                    {
+                        problem = "holds employee " + std::to_string(e.id) + " twice";
+                    }
+                    else if (fileUser != ownerOfUsername.end() || !packedUser.second)
+                    {
+                        int other = fileUser != ownerOfUsername.end() ? checks[fileUser->second].employee.id
+                                                                      : packedUser.first->second;
+                        problem = "employee " + std::to_string(e.id) + " has username " + e.username +
+                                  " also used by employee " + std::to_string(other);
+                    }
+                    if (!problem.empty())
+                    {
+                        report.problems++;
+                        out << EMPLOYEE_PACK.string() << ": " << problem << std::endl;
+                    }
+                }
+            }
+        }
+        else if (fs::exists(EMPLOYEE_PACK, ec))
+        {
+            report.problems++;
+            out << EMPLOYEE_PACK.string() << ": has a damaged index" << std::endl;
+        }
+        for (const fs::path &leftover : leftovers)
+        {
+            report.problems++;
+            out << leftover.filename().string() << ": is a leftover partial write";
+            if (mode != FSCK_CHECK && fs::remove(leftover, ec))
+            {
+                report.repaired++;
+                out << ", removed";
+            }
+            out << std::endl;
+        }
+
+        for (RecordCheck &check : checks)
+        {
+            bool problem = !check.problems.empty();
+            if (!problem && check.notices.empty())
+            {
+                continue;
+            }
+            if (problem)
+            {
+                report.problems++;
+            }
+            else
+            {
+                report.notices++;
+            }
+            std::vector<std::string> found = check.problems;
+            found.insert(found.end(), check.notices.begin(), check.notices.end());
+
+            std::string action;
+            bool rewrite = mode == FSCK_REPAIR && check.readable;
+            bool quarantine = mode != FSCK_CHECK && !check.readable;
+            if (rewrite && lockRecord(check.employee.id))
+            {
+                // Another session may have saved it since it was checked, or written the file
+                // the misnamed copy would move to. Its save wins.
+                fs::path target = EMPLOYEE_DIR / (std::to_string(check.employee.id) + ".txt");
+                RecordCheck again = checkRecordFile(check.file);
+                bool written = again.readable && again.employee.revision == check.employee.revision &&
+                               (check.file == target || !fs::exists(target, ec));
+                if (written)
+                {
+                    written = check.employee.write();
+                }
+                else
+                {
+                    action = ", changed since the check, left alone";
+                }
+                if (written && check.file != check.employee.file)
+                {
+                    fs::remove(check.file, ec);
+                }
+                unlockRecord(check.employee.id);
+                if (written)
+                {
+                    report.repaired += problem ? 1 : 0;
+                    action = ", rewritten";
+                }
+            }
+            else if (quarantine)
+            {
+                fs::create_directories(EMPLOYEE_QUARANTINE, ec);
+                fs::path target = EMPLOYEE_QUARANTINE / check.file.filename();
+                for (int n = 1; fs::exists(target); ++n)
+                {
+                    target = EMPLOYEE_QUARANTINE / (check.file.filename().string() + "." + std::to_string(n));
+                }
+                fs::rename(check.file, target, ec);
+                if (!ec)
+                {
+                    report.quarantined++;
+                    action = ", quarantined";
+                }
+            }
+
+            for (size_t i = 0; i < found.size(); ++i)
+            {
+                out << check.file.filename().string() << ": " << found[i] << (i + 1 == found.size() ? action : "")
+                    << std::endl;
+            }
+        }
+
+        return report;
+    }
+
+    /**
+     * @function archivedEmployees
+     *
+     * @description - Every removed employee still in the archive. Reads the archive the first time.
+     *
+     * @return vector<ArchivedEmployee> - The archived employees, by id.
+     */
+    std::vector<ArchivedEmployee> archivedEmployees()
+    {
+        return this->archive.list();
+    }
+
+    /**
+     * @function purgeArchive
+     *
+     * @description - Permanently drops archived employees removed longer ago than the retention.
+     *
+     * @param int retentionDays - How many days removed employees are kept.
+     *
+     * @param size_t &dropped - Set to how many were dropped.
+     *
+     * @return bool - Returns false if the archive couldn't be rewritten.
+     */
+    bool purgeArchive(int retentionDays, size_t &dropped)
+    {
+        return this->archive.purge(std::time(nullptr) - (time_t)retentionDays * 86400, dropped);
+    }
+
+    /**
+     * @function updateEmployee
+     *
+     * @description - Replaces the stored employee with the same id and writes it to its file, if
+     * nobody saved the employee since it was read. The revision on updated must be the one it was
+     * read at; it is compared with the file on disk under the record lock and bumped on save. When
+     * another session got there first the stored employee is reloaded so the edit can be redone.
+     *
+     * @param Employee updated - The new state of the employee, with the revision it was read at.
+     * @param string &error - Set to the reason when the employee isn't saved.
+     *
+     * @return bool - Returns true if the employee exists and was saved.
+     */
+    bool updateEmployee(Employee updated, std::string &error)
+    {
+        Employee *current = this->findEmployeeById(updated.id);
+        if (this->replica)
+        {
+            error = REPLICA_READ_ONLY;
+            return false;
+        }
+        if (current == nullptr)
+        {
+            error = "The employee no longer exists.";
+            return false;
+        }
+
+        if (!lockRecord(updated.id))
+        {
+            error = "The employee is being saved by someone else, try again.";
+            return false;
+        }
+
+        int stored = storedRevision(updated.id);
+        if (stored != updated.revision)
+        {
+            unlockRecord(updated.id);
+            this->reloadEmployee(updated.id);
+            error = stored == -2 ? "The employee's file is damaged, run --fsck repair."
+                                 : "The employee was changed by someone else while you were editing.";
+            return false;
+        }
+
+        updated.revision++;
+        if (!updated.write())
+        {
+            unlockRecord(updated.id);
+            error = "Could not write the employee file.";
+            return false;
+        }
+
+        // Published before the lock is let go, so the history is appended in revision order.
+        size_t row = current - this->employees.data();
+        ChangeEvent event = changeEvent(updated, current);
+        this->recordUndo(UNDO_EDIT, *current, updated);
+        this->replaceRow(row, updated);
+        this->changes.publish({event});
+        unlockRecord(updated.id);
+
+        return true;
+    }
+
+    /**
+     * @function beginTransaction
+     *
+     * @description - Starts a transaction against this application.
+     *
+     * @return Transaction - The open transaction.
+     */
+    Transaction beginTransaction()
+    {
+        return Transaction(this);
+    }
+
+    /**
+     * @function commitTransaction
+     *
+     * @description - Saves a set of new and changed employees all at once. Usernames are checked
+     * against the store with the changes applied, every record is locked and its revision
+     * compared like updateEmployee does, then one journal record is made durable, and
+     * only then are the employee files written, in parallel on the pool. The journal is removed
+     * once they are all written and synced, if the application stops before that it is replayed
+     * on the next start. If any write fails the journal is kept for that replay, nothing in
+     * memory changes, and the commit is reported as failed. The indexes, generation, and
+     * snapshot are updated once for the whole set. Each change is recorded for undo as its own step.
+     *
+     * @param vector<Employee> changes - The staged employees, at most one per id.
+     * @param string &error - Set to the reason when the commit is refused.
+     *
+     * @return bool - Returns true if every change was saved.
+     */
+    bool commitTransaction(std::vector<Employee> changes, std::string &error)
+    {
+        if (this->replica)
+        {
+            error = REPLICA_READ_ONLY;
+            return false;
+        }
+
+        std::unordered_map<std::string, int> usernames;
+        std::unordered_set<int> changedIds;
+        for (const Employee &e : changes)
+        {
+            changedIds.insert(e.id);
+        }
+
+        for (const Employee &e : changes)
+        {
+            std::string key = foldKey(e.username);
+            auto staged = usernames.emplace(key, e.id);
+            if (!staged.second)
+            {
+                error = "Username \"" + e.username + "\" is used twice.";
+                return false;
+            }
+
+            auto range = this->usernameIndex.equal_range(key);
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                // An employee in the transaction gives up its stored username.
+                if (changedIds.count(it->second) == 0)
+                {
+                    error = "Username \"" + e.username + "\" is taken.";
+                    return false;
+                }
+            }
+        }
+
+        if (changes.empty())
+        {
+            return true;
+        }
+
+        // Every record is locked and compared before anything is written, like updateEmployee
+        // does for one. New employees must not have a file yet.
+        std::vector<int> locked;
+        auto unlockAll = [&locked]
+        {
+            for (int id : locked)
+            {
+                unlockRecord(id);
+            }
+        };
+        for (Employee &e : changes)
+        {
+            if (!lockRecord(e.id))
+            {
+                unlockAll();
+                error = "An employee is being saved by someone else, try again.";
+                return false;
+            }
+            locked.push_back(e.id);
+
+            bool isNew = this->idIndex.count(e.id) == 0;
+            int stored = storedRevision(e.id);
+            if (stored != (isNew ? -1 : e.revision))
+            {
+                unlockAll();
+                this->reloadEmployee(e.id);
+                error = "Employee " + std::to_string(e.id) +
+                        (stored == -2 ? "'s file is damaged, run --fsck repair." : " was changed by someone else.");
+                return false;
+            }
+            e.revision++;
+        }
+
+        // A journal still there is a transaction that hasn't been finished, replacing it would lose it.
+        // The journal lock keeps another session from writing its own between the check and the remove.
+        if (!lockFile(EMPLOYEE_JOURNAL_LOCK))
+        {
+            unlockAll();
+            error = "Another transaction is being saved, try again.";
+            return false;
+        }
+        std::error_code ec;
+        if (fs::exists(EMPLOYEE_JOURNAL, ec))
+        {
+            unlockFile(EMPLOYEE_JOURNAL_LOCK);
+            unlockAll();
+            error = "An earlier transaction is waiting to be finished on the next start.";
+            return false;
+        }
+
+        if (!writeJournal(changes))
+        {
+            unlockFile(EMPLOYEE_JOURNAL_LOCK);
+            unlockAll();
+            error = "Could not write the journal.";
+            return false;
+        }
+
+        std::atomic<bool> written(true);
+        this->pool.parallelFor(0, changes.size(), 16, [&](size_t lo, size_t hi)
+                               {
+            for (size_t i = lo; i < hi; ++i)
+            {
+                if (!changes[i].write())
+                {
+                    written = false;
+                }
+            } });
+
+        if (!written.load() || !syncDirectory(EMPLOYEE_DIR))
+        {
+            unlockFile(EMPLOYEE_JOURNAL_LOCK);
+            unlockAll();
+            error = "Could not save every employee, the change will be finished on the next start.";
+            return false;
+        }
+
+        fs::remove(EMPLOYEE_JOURNAL, ec);
+        unlockFile(EMPLOYEE_JOURNAL_LOCK);
+
+        std::vector<size_t> rows;
+        std::vector<ChangeEvent> events;
+        rows.reserve(changes.size());
+        for (Employee &e : changes)
+        {
+            auto it = this->idIndex.find(e.id);
+            if (it == this->idIndex.end())
+            {
+                events.push_back(changeEvent(e, nullptr));
+                this->recordUndo(UNDO_ADD, Employee(), e);
+                this->employees.push_back(e);
+                rows.push_back(this->employees.size() - 1);
+                this->currentId = std::max(this->currentId, e.id);
+            }
+            else
+            {
+                // unindexRow erases the idIndex entry it points at, so the row is copied first.
+                size_t row = it->second;
+                events.push_back(changeEvent(e, &this->employees[row]));
+                this->recordUndo(UNDO_EDIT, this->employees[row], e);
+                this->unindexRow(row);
+                this->employees[row] = e;
+                rows.push_back(row);
+            }
+            this->indexRow(rows.back());
+        }
+        this->touchStore();
+        this->snapshots.publishRows(this->employees, this->searchKeys, rows, this->generation);
+        this->changes.publish(std::move(events));
+        unlockAll();
+
+        return true;
+    }
+
+    /**
+     * 
+     * @function removeEmployeeById
+     * 
+     * @description - This function will remove an employee by their id. The employee is moved to the
+     * archive, where it can be restored until it is purged. A manager with direct reports is
+     * refused, so no one is left reporting to an id that doesn't exist.
+     * 
+     * @param int id - The id of the employee to remove. Won't let you delete the currently logged in employee.
+     * @param string *error - Set to the reason when the remove is refused, if given.
+     * 
+     * @return bool - Returns true if the employee was removed.
+    */
+    bool removeEmployeeById(int id, std::string *error = nullptr)
+    {
+        std::string reason;
+        auto found = this->idIndex.find(id);
+        auto reports = this->reportsIndex.find(id);
+        if (this->replica)
+        {
+            reason = REPLICA_READ_ONLY;
+        }
+        else if (found == this->idIndex.end())
+        {
+            reason = "There is no employee " + std::to_string(id) + ".";
+        }
+        // Prevent deleting currently logged in employee
+        else if (id == this->employee.id)
+        {
+            reason = "You can't remove yourself.";
+        }
+        else if (reports != this->reportsIndex.end() && !reports->second.empty())
+        {
+            reason = "Employee " + std::to_string(id) + " still has " + std::to_string(reports->second.size()) +
+                     " direct reports, reassign them first.";
+        }
+        if (!reason.empty())
+        {
+            if (error != nullptr)
+            {
+                *error = reason;
+            }
+            return false;
+        }
+
+        size_t row = found->second;
+        Employee removed = this->employees[row];
+
+        // Held until the remove is published, so it lands in the history after any save before it.
+        if (!lockRecord(id))
+        {
+            if (error != nullptr)
+            {
+                *error = "The employee is being saved by someone else, try again.";
+            }
+            return false;
+        }
+
+        // Archiving the copy held here would lose a save another session made since it was loaded.
+        int stored = storedRevision(id);
+        if (stored != removed.revision)
+        {
+            unlockRecord(id);
+            this->reloadEmployee(id);
+            if (error != nullptr)
+            {
+                *error = stored == -2 ? "The employee's file is damaged, run --fsck repair."
+                                      : "The employee was changed by someone else, look again before removing them.";
+            }
+            return false;
+        }
+
+        // The file is only deleted once the employee is safe in the archive.
+        if (!this->archive.add(removed))
+        {
+            unlockRecord(id);
+            if (error != nullptr)
+            {
+                *error = "Could not archive the employee.";
+            }
+            return false;
+        }
+        std::error_code ec;
+        fs::remove(removed.file, ec);
+
+        // A packed copy would come back on the next load without a marker saying it was removed.
+        // Any pack may hold one, another session may have packed the file since this one loaded.
+        if (fs::exists(EMPLOYEE_PACK, ec))
+        {
+            FILE *marker = fopen(removedMarkerPath(id).string().c_str(), "w");
+            if (marker != nullptr)
+            {
+                fclose(marker);
+            }
+        }
+
+        this->dropRow(row);
+
+        ChangeEvent event;
+        event.kind = "remove";
+        event.id = id;
+        event.employee.id = id;
+        this->changes.publish({event});
+        unlockRecord(id);
+        this->audit.record(AUDIT_REMOVE, this->employee.id, id);
+        this->recordUndo(UNDO_REMOVE, removed, Employee());
+
+        return true;
+    }
+
+    /**
+     * @function searchMatch
+     * 
+     * @description - This function will search for a query in a test string. Not case sensitive,
+     * both strings are compared by their Unicode case folded keys.
+     * 
+     * @param string test - The string to search in.
+     * @param string query - The string to search for.
+     * 
+     * @return bool - Returns true if the query is found in the test string, false otherwise.
+    */
+    bool searchMatch(std::string test, std::string query)
+    {
+        return foldKey(test).find(foldKey(query)) != std::string::npos;
+    }
+
+    /**
+     * @function snapshot
+     *
+     * @description - Pins the latest published version of the store. The snapshot never changes,
+     * and can be read from any thread while employees are added, edited, or removed.
+     *
+     * @return Snapshot - The pinned view, unpinned when it goes out of scope.
+     */
+    SnapshotStore::Snapshot snapshot()
+    {
+        return this->snapshots.pin();
+    }
+
+    /**
+     * @function isPhoneticQuery - static
+     *
+     * @description - Checks if a query asks for a sounds-like match, see PHONETIC_QUERY_PREFIX.
+     *
+     * @param string query - The raw query.
+     *
+     * @return bool - Returns true for a phonetic query.
+    */
+    static bool isPhoneticQuery(const std::string &query)
+    {
+        return !query.empty() && query[0] == PHONETIC_QUERY_PREFIX;
+    }
+
+    /**
+     * @function phoneticSearchRows
+     *
+     * @description - Finds employees with a first or last name that sounds like the query. This
+     * is a probe of the phonetic index, no names are encoded apart from the query.
+     *
+     * @param string query - The name to match, with or without PHONETIC_QUERY_PREFIX.
+     *
+     * @return vector<size_t> - Rows of the matching employees, in store order.
+    */
+    std::vector<size_t> phoneticSearchRows(std::string query)
+    {
+        if (isPhoneticQuery(query))
+        {
+            query.erase(0, 1);
+        }
+
+        std::vector<size_t> rows;
+        std::string key = soundex(query);
+        if (key.empty())
+        {
+            return rows;
+        }
+
+        auto range = this->phoneticIndex.equal_range(key);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            rows.push_back(this->idIndex.at(it->second));
+        }
+
+        std::sort(rows.begin(), rows.end());
+        rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+        return rows;
+    }
+
+    /**
+     * @function selectRows
+     *
+     * @description - Builds a mask of the rows that satisfy every range predicate. Each predicate
+     * is a straight compare over one typed column, run on the pool a chunk at a time.
+     *
+     * @param vector<RangePredicate> predicates - The ranges every selected row must be in.
+     *
+     * @return vector<uint8_t> - 1 for every selected row, 0 otherwise.
+    */
+    std::vector<uint8_t> selectRows(const std::vector<RangePredicate> &predicates)
+    {
+        size_t rowCount = this->employees.size();
+        std::vector<uint8_t> selected(rowCount, 1);
+
+        this->pool.parallelFor(0, rowCount, SEARCH_CHUNK_ROWS, [&](size_t lo, size_t hi)
+                               {
+            for (const RangePredicate &predicate : predicates)
+            {
+                maskRange(this->columns[predicate.column].data() + lo, selected.data() + lo, hi - lo,
+                          predicate.low, predicate.high);
+            } });
+
+        return selected;
+    }
+
+    /**
+     * @function rangeSearchRows
+     *
+     * @description - Finds the rows that satisfy every range predicate.
+     *
+     * @param vector<RangePredicate> predicates - The ranges to match.
+     *
+     * @return vector<size_t> - Matching rows, in store order.
+    */
+    std::vector<size_t> rangeSearchRows(const std::vector<RangePredicate> &predicates)
+    {
+        std::vector<uint8_t> selected = this->selectRows(predicates);
+
+        std::vector<size_t> rows;
+        for (size_t i = 0; i < selected.size(); ++i)
+        {
+            if (selected[i])
+            {
+                rows.push_back(i);
+            }
+        }
+
+        return rows;
+    }
+
+    /**
+     * @function indexedSearchRows
+     *
+     * @description - Answers queries that don't need a text scan: phonetic queries from the
+     * phonetic index and range queries from the numeric columns.
+     *
+     * @param string query - The raw query.
+     * @param vector<size_t> rows - Filled with the matching rows when the query is handled.
+     *
+     * @return bool - Returns true if the query was one of these kinds.
+    */
+    bool indexedSearchRows(const std::string &query, std::vector<size_t> &rows)
+    {
+        if (isPhoneticQuery(query))
+        {
+            rows = this->phoneticSearchRows(query);
+            return true;
+        }
+
+        std::vector<RangePredicate> predicates;
+        if (parseRangeQuery(query, predicates))
+        {
+            rows = this->rangeSearchRows(predicates);
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * @function summarize
+     *
+     * @description - Count, sum, min, max, and average of a numeric column over the selected rows.
+     * Chunks are summarized on the pool with a SIMD friendly loop and the results merged.
+     *
+     * @param int column - The COLUMN_ constant to summarize.
+     * @param vector<uint8_t> selected - Mask of the rows to include, from selectRows.
+     *
+     * @return ColumnSummary - The aggregates.
+    */
+    ColumnSummary summarize(int column, const std::vector<uint8_t> &selected)
+    {
+        std::mutex mergeLock;
+        ColumnSummary total;
+
+        this->pool.parallelFor(0, selected.size(), SEARCH_CHUNK_ROWS * 16, [&](size_t lo, size_t hi)
+                               {
+            ColumnSummary part = summarizeColumn(this->columns[column].data() + lo, selected.data() + lo, hi - lo);
+            std::lock_guard<std::mutex> guard(mergeLock);
+            total.merge(part); });
+
+        return total;
+    }
+
+    /**
+     * @function scanChunk
+     *
+     * @description - Checks one SEARCH_CHUNK_ROWS sized chunk of the store against a query.
+     *
+     * @param size_t chunk - Index of the chunk to scan.
+     * @param string foldedQuery - The case folded string to search for.
+     *
+     * @return vector<size_t> - Matching rows in the chunk, in store order.
+    */
+    std::vector<size_t> scanChunk(size_t chunk, const std::string &foldedQuery)
+    {
+        std::vector<size_t> local;
+        size_t end = std::min(this->employees.size(), (chunk + 1) * SEARCH_CHUNK_ROWS);
+        for (size_t i = chunk * SEARCH_CHUNK_ROWS; i < end; ++i)
+        {
+            if (this->searchKeys[i].contains(foldedQuery))
+            {
+                local.push_back(i);
+            }
+        }
+
+        return local;
+    }
+
+    /**
+     * @function searchEmployeeRows
+     *
+     * @description - Finds the rows of all employees with a first name, last name, or username
+     * like the query. The store is split into SEARCH_CHUNK_ROWS sized chunks that are scanned
+     * on the pool, each chunk collects its matching rows into its own buffer and the buffers
+     * are then merged in chunk order, so the result is in store order.
+     *
+     * @param string query - The string to search for.
+     *
+     * @return vector<size_t> - Indexes into employees of the matches.
+    */
+    std::vector<size_t> searchEmployeeRows(std::string query)
+    {
+        std::vector<size_t> indexed;
+        if (this->indexedSearchRows(query, indexed))
+        {
+            return indexed;
+        }
+
+        std::string key = QueryCache::normalize(query);
+        std::vector<uint32_t> cached;
+        if (this->queryCache.lookup(key, this->generation, cached))
+        {
+            return std::vector<size_t>(cached.begin(), cached.end());
+        }
+
+        // The scan uses the key itself, so a cached result and a fresh scan always agree.
+        query = key;
+
+        size_t rowCount = this->employees.size();
+        size_t chunkCount = (rowCount + SEARCH_CHUNK_ROWS - 1) / SEARCH_CHUNK_ROWS;
+        std::vector<std::vector<size_t>> chunkRows(chunkCount);
+
+        this->pool.parallelFor(0, chunkCount, 1, [&](size_t lo, size_t hi)
+                               {
+            for (size_t chunk = lo; chunk < hi; ++chunk)
+            {
+                chunkRows[chunk] = this->scanChunk(chunk, query);
+            } });
+
+        // Ordered merge, chunk offsets come from a prefix sum of the buffer sizes.
+        std::vector<size_t> offsets(chunkCount + 1, 0);
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            offsets[chunk + 1] = offsets[chunk] + chunkRows[chunk].size();
+        }
+
+        std::vector<size_t> rows(offsets[chunkCount]);
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            std::copy(chunkRows[chunk].begin(), chunkRows[chunk].end(), rows.begin() + offsets[chunk]);
+        }
+
+        this->queryCache.store(key, this->generation, std::vector<uint32_t>(rows.begin(), rows.end()));
+
+        return rows;
+    }
+
+    /**
+     * @function streamSearch
+     *
+     * @description - Starts a search on the pool and returns right away. Matching records are
+     * pushed to the returned channel as each wave of chunks (one chunk per worker) finishes,
+     * in store order, so the first page can be shown before the scan is done. The search reads
+     * a snapshot pinned when it starts, so the store can change while it runs.
+     *
+     * @param string query - The string to search for.
+     *
+     * @return shared_ptr<BoundedChannel<RecordRef>> - Channel the matching records arrive on.
+    */
+    std::shared_ptr<BoundedChannel<RecordRef>> streamSearch(std::string query)
+    {
+        std::string key = QueryCache::normalize(query);
+        // Held by the task, std::function can't hold the move only handle itself.
+        auto snapshot = std::make_shared<SnapshotStore::Snapshot>(this->snapshots.pin());
+
+        auto channel = std::make_shared<BoundedChannel<RecordRef>>(STREAM_CHANNEL_CAPACITY);
+
+        // Phonetic and range matches come straight from indexes, they go down the same path as a cache hit.
+        // Rows from the indexes and cache are for the current generation, which is the one just pinned.
+        std::vector<uint32_t> cached;
+        std::vector<size_t> indexed;
+        bool isIndexed = this->indexedSearchRows(query, indexed);
+        if (isIndexed)
+        {
+            cached.assign(indexed.begin(), indexed.end());
+        }
+
+        query = key;
+
+        if (isIndexed || this->queryCache.lookup(key, snapshot->generation(), cached))
+        {
+            this->pool.submit([channel, snapshot, cached = std::move(cached)]
+                              {
+                for (uint32_t row : cached)
+                {
+                    if (!channel->push(snapshot->at(row)))
+                    {
+                        break;
+                    }
+                }
+                snapshot->release();
+                channel->close(); });
+
+            return channel;
+        }
+
+        this->pool.submit([this, channel, snapshot, query, key]
+                          {
+            try
+            {
+                size_t rowCount = snapshot->size();
+                size_t chunkCount = (rowCount + SEARCH_CHUNK_ROWS - 1) / SEARCH_CHUNK_ROWS;
+                size_t wave = this->pool.size();
+                bool open = true;
+                std::vector<uint32_t> found;
+
+                for (size_t first = 0; open && first < chunkCount; first += wave)
+                {
+                    size_t last = std::min(chunkCount, first + wave);
+                    std::vector<std::vector<size_t>> chunkRows(last - first);
+
+                    this->pool.parallelFor(first, last, 1, [&](size_t lo, size_t hi)
+                                           {
+                        for (size_t chunk = lo; chunk < hi; ++chunk)
+                        {
+                            size_t end = std::min(rowCount, (chunk + 1) * SEARCH_CHUNK_ROWS);
+                            for (size_t row = chunk * SEARCH_CHUNK_ROWS; row < end; ++row)
+                            {
+                                if (snapshot->at(row)->keys.contains(query))
+                                {
+                                    chunkRows[chunk - first].push_back(row);
+                                }
+                            }
+                        } });
+
+                    for (size_t i = 0; open && i < chunkRows.size(); ++i)
+                    {
+                        for (size_t row : chunkRows[i])
+                        {
+                            if (!channel->push(snapshot->at(row)))
+                            {
+                                open = false;
+                                break;
+                            }
+                            found.push_back(row);
+                        }
+                    }
+                }
+
+                // Only a scan that ran to the end has the full answer worth caching.
+                if (open)
+                {
+                    this->queryCache.store(key, snapshot->generation(), std::move(found));
+                }
+            }
+            catch (...)
+            {
+            }
+
+            snapshot->release();
+            channel->close(); });
+
+        return channel;
+    }
+
+    /**
+     * @function searchEmployees
+     *
+     * @description - Finds all employees with a first name, last name, or username like the query.
+     *
+     * @param string query - The string to search for.
+     *
+     * @return vector<Employee> - Copies of the matching employees, in store order.
+    */
+    std::vector<Employee> searchEmployees(std::string query)
+    {
+        std::vector<size_t> rows = this->searchEmployeeRows(query);
+
+        std::vector<Employee> out;
+        out.reserve(rows.size());
+        for (size_t row : rows)
+        {
+            out.push_back(this->employees[row]);
+        }
+
+        return out;
+    }
+
+    /**
+     * @function uniqueUsername
+     * 
+     * @description - This function will check if a username is unique.
+     * 
+     * @param string username - The username to check.
+     * 
+     * @return bool - Returns true if the username is unique, false otherwise.
+    */
+    bool uniqueUsername(std::string username)
+    {
+        return this->usernameIndex.count(foldKey(username)) == 0;
+    }
+
+    /**
+     * @function uniqueUsername
+     * 
+     * @description - This function will check if a username is unique, but will skip a specific id.
+     * 
+     * @param string username - The username to check.
+     * @param int skipId - The id to skip.
+     * 
+     * @return bool - Returns true if the username is unique, false otherwise.
+    */
+    bool uniqueUsername(std::string username, int skipId)
+    {
+        auto range = this->usernameIndex.equal_range(foldKey(username));
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second != skipId)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @function usernameOwners
+     *
+     * @description - Ids of the stored employees with a username, compared case folded.
+     *
+     * @param string username - The username to look up.
+     *
+     * @return vector<int> - The ids, empty if the username is free.
+    */
+    std::vector<int> usernameOwners(std::string username)
+    {
+        std::vector<int> ids;
+        auto range = this->usernameIndex.equal_range(foldKey(username));
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            ids.push_back(it->second);
+        }
+
+        return ids;
+    }
+
+    /**
+     * @function countEmployees
+     *
+     * @description - Counts the employees like a query without copying any of them. Uses a
+     * cached result when there is one, otherwise each chunk is counted on the pool.
+     *
+     * @param string query - The string to search for.
+     *
+     * @return size_t - The number of matching employees.
+    */
+    size_t countEmployees(std::string query)
+    {
+        std::vector<size_t> indexed;
+        if (this->indexedSearchRows(query, indexed))
+        {
+            return indexed.size();
+        }
+
+        std::string key = QueryCache::normalize(query);
+        if (key.empty())
+        {
+            return this->employees.size();
+        }
+
+        std::vector<uint32_t> cached;
+        if (this->queryCache.lookup(key, this->generation, cached))
+        {
+            return cached.size();
+        }
+
+        query = key;
+
+        std::atomic<size_t> total(0);
+        size_t rowCount = this->employees.size();
+        this->pool.parallelFor(0, rowCount, SEARCH_CHUNK_ROWS, [&](size_t lo, size_t hi)
+                               {
+            size_t local = 0;
+            for (size_t i = lo; i < hi; ++i)
+            {
+                if (this->searchKeys[i].contains(query))
+                {
+                    local++;
+                }
+            }
+            total += local; });
+
+        return total.load();
+    }
+
+    /**
+     * @function anyEmployeeMatches
+     *
+     * @description - Checks if at least one employee is like a query. Chunks stop as soon as any
+     * chunk has found a match.
+     *
+     * @param string query - The string to search for.
+     *
+     * @return bool - Returns true if any employee matches.
+    */
+    bool anyEmployeeMatches(std::string query)
+    {
+        std::vector<size_t> indexed;
+        if (this->indexedSearchRows(query, indexed))
+        {
+            return !indexed.empty();
+        }
+
+        query = QueryCache::normalize(query);
+
+        std::atomic<bool> found(false);
+        size_t rowCount = this->employees.size();
+        this->pool.parallelFor(0, rowCount, SEARCH_CHUNK_ROWS, [&](size_t lo, size_t hi)
+                               {
+            for (size_t i = lo; i < hi && !found.load(std::memory_order_relaxed); ++i)
+            {
+                if (this->searchKeys[i].contains(query))
+                {
+                    found = true;
+                }
+            } });
+
+        return found.load();
+    }
+
+    /**
+     * @function reportsOf
+     *
+     * @description - Everyone who reports to an employee, directly or through other managers.
+     * Walks down the reports index breadth first, so the cost is the size of the org, not the
+     * size of the store. Direct reports come first.
+     *
+     * @param int managerId - The id of the manager.
+     *
+     * @return vector<Employee> - Copies of every employee in the manager's org.
+    */
+    std::vector<Employee> reportsOf(int managerId)
+    {
+        std::vector<Employee> out;
+        std::vector<int> queue(1, managerId);
+        std::unordered_map<int, bool> seen;
+        seen[managerId] = true;
+
+        for (size_t next = 0; next < queue.size(); ++next)
+        {
+            auto it = this->reportsIndex.find(queue[next]);
+            if (it == this->reportsIndex.end())
+            {
+                continue;
+            }
+
+            for (int id : it->second)
+            {
+                Employee *e = this->findEmployeeById(id);
+                if (e == nullptr || seen[id])
+                {
+                    continue;
+                }
+
+                seen[id] = true;
+                queue.push_back(id);
+                out.push_back(*e);
+            }
+        }
+
+        return out;
+    }
+
+    /**
+     * @function managementChain
+     *
+     * @description - The managers above an employee, from their direct manager up to the top.
+     *
+     * @param int id - The id of the employee.
+     *
+     * @return vector<Employee> - Copies of the managers, closest first.
+    */
+    std::vector<Employee> managementChain(int id)
+    {
+        std::vector<Employee> out;
+        Employee *e = this->findEmployeeById(id);
+
+        // The chain can never be longer than the store, this stops a bad file from looping us.
+        while (e != nullptr && e->managerId != 0 && out.size() < this->employees.size())
+        {
+            e = this->findEmployeeById(e->managerId);
+            if (e != nullptr)
+            {
+                out.push_back(*e);
+            }
+        }
+
+        return out;
+    }
+
+    /**
+     * @function canReportTo
+     *
+     * @description - Checks that an employee can be given a manager. The manager must exist and
+     * must not be the employee or anyone in the employee's org, which would make a loop.
+     *
+     * @param int id - The id of the employee.
+     * @param int managerId - The id of the proposed manager, 0 for none.
+     *
+     * @return bool - Returns true if the assignment is allowed.
+    */
+    bool canReportTo(int id, int managerId)
+    {
+        if (managerId == 0)
+        {
+            return true;
+        }
+
+        if (managerId == id || this->findEmployeeById(managerId) == nullptr)
+        {
+            return false;
+        }
+
+        for (const Employee &manager : this->managementChain(managerId))
+        {
+            if (manager.id == id)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @function getDepartments
+     *
+     * @description - Headcount and role counts of every department, kept up to date on every
+     * change so this is just a read. Employees without a department are under "".
+     *
+     * @return const map<string, Department> & - Departments by name, in name order.
+    */
+    const std::map<std::string, Department> &getDepartments()
+    {
+        return this->departments;
+    }
+
+    /**
+     * @function departmentMembers
+     *
+     * @description - Employees in a department, looked up from the department index.
+     *
+     * @param string name - The department name, "" for employees without one.
+     *
+     * @return vector<Employee> - Copies of the members, in id order.
+    */
+    std::vector<Employee> departmentMembers(std::string name)
+    {
+        std::vector<Employee> out;
+        auto department = this->departments.find(name);
+        if (department == this->departments.end())
+        {
+            return out;
+        }
+
+        std::vector<int> ids(department->second.members.begin(), department->second.members.end());
+        std::sort(ids.begin(), ids.end());
+        for (int id : ids)
+        {
+            Employee *e = this->findEmployeeById(id);
+            if (e != nullptr)
+            {
+                out.push_back(*e);
+            }
+        }
+
+        return out;
+    }
+
+    static std::string redactedRecord(Employee e)
+    {
+        e.updatePassword(REDACTED_PASSWORD);
+        return e.serialize();
+    }
+
+    /**
+     * @function exportSince
+     *
+     * @description - Writes every record changed after a watermark, in change order. Walks the
+     * modification index from the watermark, so the cost is the number of changes since then no
+     * matter how many employees there are. Passwords are replaced by REDACTED_PASSWORD. Lines are:
+     *  - <sequence> put v<RECORD_FORMAT_VERSION> <record fields>
+     *  - <sequence> delete <id>
+     *  - #watermark <sequence> - last, the watermark to pass on the next export.
+     * A changed record the store doesn't hold, such as a damaged file moved to quarantine, is
+     * written as it was logged. If it can't be found there either the export stops before it, so
+     * the watermark never passes a change that wasn't written.
+     *
+     * @param unsigned long watermark - Sequence the last export ended at, 0 for everything.
+     * Records never changed since the change log started have sequence 0 and are only in a full export.
+     * @param ostream &out - Where to write.
+     *
+     * @return unsigned long - The new watermark.
+    */
+    unsigned long exportSince(unsigned long watermark, std::ostream &out)
+    {
+        if (watermark == 0)
+        {
+            for (const Employee &e : this->employees)
+            {
+                if (this->modSeqOf.count(e.id) == 0)
+                {
+                    std::string record = redactedRecord(e);
+                    out << "0 put v" << RECORD_FORMAT_VERSION << " " << record.substr(record.find('\n') + 1);
+                }
+            }
+        }
+
+        for (auto it = this->modSeqIndex.upper_bound(watermark); it != this->modSeqIndex.end(); ++it)
+        {
+            if (this->tombstones.count(it->second) != 0)
+            {
+                out << it->first << " delete " << it->second << std::endl;
+                watermark = it->first;
+                continue;
+            }
+
+            Employee *e = this->findEmployeeById(it->second);
+            std::vector<ChangeEvent> logged;
+            if (e == nullptr)
+            {
+                logged = ChangeFeed::readLog(it->first - 1);
+                if (logged.empty() || logged.front().sequence != it->first || logged.front().kind == "remove")
+                {
+                    break;
+                }
+                e = &logged.front().employee;
+            }
+            std::string record = redactedRecord(*e);
+            out << it->first << " put v" << RECORD_FORMAT_VERSION << " " << record.substr(record.find('\n') + 1);
+            watermark = it->first;
+        }
+
+        out << "#watermark " << watermark << std::endl;
+        return watermark;
+    }
+
+    /**
+     * @function countWithPermission
+     *
+     * @description - Counts employees that have any of the given permission bits, the same test
+     * hasPermission does. Answered from the permission bitmaps, no employee is read.
+     *
+     * @param short permission - The permission bits to count, for example HR_PERMS.
+     *
+     * @return size_t - The number of employees with the permission.
+    */
+    size_t countWithPermission(short permission)
+    {
+        std::vector<const RowBitmap *> bitmaps;
+        for (short bit = 0; bit < PERMISSION_BITS; ++bit)
+        {
+            if ((permission >> bit) & 1)
+            {
+                bitmaps.push_back(&this->permissionIndex[bit]);
+            }
+        }
+
+        return RowBitmap::countUnion(bitmaps);
+    }
+};
+
+/**
+ * ******************************************************
+ * DEFINE METHODS FOR SCREENS THAT DEPEND ON APPLICATION
+ * ******************************************************
+*/
+
+/**
+ * @function Transaction::stage
+ *
+ * @description - Gets the staged copy of an employee, copying it from the store the first time
+ * it is staged. Changes made through the pointer are saved on commit.
+ *
+ * @param int id - The id of the employee.
+ *
+ * @return Employee* - The staged copy, nullptr if there is no such employee or the transaction is closed.
+ */
+Employee *Transaction::stage(int id)
+{
+    if (!this->open)
+    {
+        return nullptr;
+    }
+
+    auto it = this->staged.find(id);
+    if (it == this->staged.end())
+    {
+        Employee *stored = this->app->findEmployeeById(id);
+        if (stored == nullptr)
+        {
+            return nullptr;
+        }
+        it = this->staged.emplace(id, *stored).first;
+    }
+
+    return &it->second;
+}
+
+/**
+ * @function Transaction::put
+ *
+ * @description - Stages a whole employee, replacing anything staged for the same id.
+ *
+ * @param Employee e - The new state of the employee.
+ *
+ * @return void
+ */
+void Transaction::put(const Employee &e)
+{
+    if (this->open)
+    {
+        this->staged[e.id] = e;
+    }
+}
+
+/**
+ * @function Transaction::usernameTaken
+ *
+ * @description - Checks if a username is used in the store as it would be after commit.
+ *
+ * @param string username - The username to check.
+ * @param int skipId - The id of the employee that would take the username.
+ *
+ * @return bool - Returns true if any other employee would have the username.
+ */
+bool Transaction::usernameTaken(const std::string &username, int skipId)
+{
+    std::string key = foldKey(username);
+    for (const auto &entry : this->staged)
+    {
+        if (entry.first != skipId && foldKey(entry.second.username) == key)
+        {
+            return true;
+        }
+    }
+
+    // Stored employees only count if the transaction isn't changing them.
+    for (int id : this->app->usernameOwners(username))
+    {
+        if (id != skipId && this->staged.count(id) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @function Transaction::commit
+ *
+ * @description - Saves every staged change together and closes the transaction. If the commit
+ * is refused nothing is saved and the transaction stays open.
+ *
+ * @param string &error - Set to the reason when the commit is refused.
+ *
+ * @return bool - Returns true if every change was saved.
+ */
+bool Transaction::commit(std::string &error)
+{
+    if (!this->open)
+    {
+        error = "The transaction is closed.";
+        return false;
+    }
+
+    std::vector<Employee> changes;
+    changes.reserve(this->staged.size());
+    for (const auto &entry : this->staged)
+    {
+        changes.push_back(entry.second);
+    }
+
+    if (!this->app->commitTransaction(std::move(changes), error))
+    {
+        return false;
+    }
+
+    this->staged.clear();
+    this->open = false;
+    return true;
+}
+
+/**
+ * @function LoginScreen::renderInteractiveContent
+ *
+ * @description - This function prints two input prompts for the user to enter their
+ * username and password. It will then attempt to login the user. If the login is successful,
+ * it will navigate to the menu screen. 
+ *
+ * @return void
+ *
+ */
+void LoginScreen::renderInteractiveContent()
+{
+    /* START LOGIN */
+    std::string username, password;
+
+    while (true)
+    {
+        std::cout << "Username> ";
+        getline(std::cin, username);
+
+        std::cout << "Password> ";
+        getline(std::cin, password);
+
+        if (this->app->login(username, password))
+        {
+            break;
+        }
+
+        std::cout << std::endl
+             << "Invalid login, please try again." << std::endl;
+    }
+
+    // We are successful, request next screen.
+    this->app->navigateToScreen("menu");
+}
+
+/**
+ * @function MenuScreen::prePrintHeader
+ *
+ * @description - This function will set the header text to welcome the logged in employee.
+ *
+ * @return void
+ *
+ */
+void MenuScreen::prePrintHeader()
+{
+    const Employee *employee = app->getLoggedInEmployee();
+    std::ostringstream oss;
+
+    oss << "Welcome " << employee->firstName << " " << employee->lastName << "!";
+    if (this->app->isReplica())
+    {
+        oss << " (replica)";
+    }
+    this->headerText = oss.str();
+}
+
+void MenuScreen::buildMenuOptions()
+{
+    Employee *employee = app->getLoggedInEmployee();
+    std::string screens[11][2] = {
+        {"list", "View Employees"},
+        {"search", "Search Employees"},
+        {"departments", "Department Report"},
+        {"add", "Add Employee"},
+        {"remove", "Remove Employee"},
+        {"archive", "Restore Employee"},
+        {"payroll", "Payroll Summary"},
+        {"reorg", "Reassign Reports"},
+        {"undo", "Undo / Redo"},
+        {"org", "View Your Org"},
+        {"file", "View Your File"}
+    };
+
+    // Loop through each screen and add it to the menu if the employee has permission.
+    for (int i = 0; i < 11; ++i)
+    {
+        switch (i)
+        {
+        case 0:
+        case 1:
+        case 2:
+            if (employee->hasPermission(HR_PERMS) ||
+                employee->hasPermission(MANAGEMENT_PERMS))
+            {
+                MenuOption newOption;
+                newOption.name = screens[i][1];
+                newOption.menuPosition = this->options.size() + 1;
+                newOption.screenName = screens[i][0];
+
+                this->options.push_back(newOption);
+            }
+            break;
+        case 3:
+        case 4:
+        case 5:
+        case 6:
+        case 7:
+        case 8:
+            // A replica can't change the store, so it only offers the payroll report.
+            if (employee->hasPermission(HR_PERMS) && (i == 6 || !this->app->isReplica()))
+            {
+                MenuOption newOption;
+                newOption.name = screens[i][1];
+                newOption.menuPosition = this->options.size() + 1;
+                newOption.screenName = screens[i][0];
+
+                this->options.push_back(newOption);
+            }
+            break;
+        case 9:
+            if (employee->hasPermission(MANAGEMENT_PERMS))
+            {
+                MenuOption newOption;
+                newOption.name = screens[i][1];
+                newOption.menuPosition = this->options.size() + 1;
+                newOption.screenName = screens[i][0];
+
+                this->options.push_back(newOption);
+            }
+            break;
+        default:
+            if (employee->hasPermission(GENERAL_PERMS))
+            {
+                MenuOption newOption;
+                newOption.name = screens[i][1];
+                newOption.menuPosition = this->options.size() + 1;
+                newOption.screenName = screens[i][0];
+
+                this->options.push_back(newOption);
+            }
+        }
+    }
+
+    // Set flag to true so we don't rebuild the menu options.
+    this->optionsInitialized = true;
+}
+
+/**
+ * @function MenuScreen::renderInteractiveContent
+ *
+ * @description - This function will print the menu options to the screen and prompt the user
+ * to make a selection. If the user selects an option, it will navigate to the appropriate screen.
+ *
+ * @return void
+ *
+ */
+void MenuScreen::renderInteractiveContent()
+{
+    if (!this->optionsInitialized)
+    {
+        this->buildMenuOptions();
+    }
+
+    for (auto o : this->options)
+    {
+        std::cout << o.menuPosition << ". " << o.name << std::endl;
+    }
+
+    std::cout << std::endl
+         << "0. Exit Application" << std::endl
+         << std::endl;
+
+    int choice;
+    while (true)
+    {
+        std::cout << "Choice> ";
+        std::string input;
+        std::cin >> input;
+        std::istringstream iss(input);
+        iss >> choice;
+
+        if (choice == 0 || (choice > 0 && choice - 1 < this->options.size()))
+        {
+            break;
+        }
+
+        std::cout << std::endl
+             << "Please input a valid option." << std::endl;
+    }
+
+    if (choice == 0)
+    {
+        return;
+    }
+
+    // Remove
+    if (this->options.at(choice - 1).screenName == "remove")
+    {
+        ListScreen removeScreen(this->app, "remove");
+        removeScreen.display();
+    }
+
+    // Org, built when chosen because it depends on who is logged in.
+    if (this->options.at(choice - 1).screenName == "org")
+    {
+        ListScreen orgScreen(this->app, "", this->app->reportsOf(this->app->getLoggedInEmployee()->id));
+        orgScreen.name = "org";
+        orgScreen.headerText = "Your Organization";
+        orgScreen.display();
+    }
+
+    this->app->navigateToScreen(this->options.at(choice - 1).screenName);
+}
+
+/**
+ * @function ListScreen::getEmployees
+ * 
+ * @description - This function will return a list of employees. If the employees have been overriden, it will return
+ * the overriden list. Otherwise, it will return the employees in a snapshot of the application's store, so the
+ * list is consistent even if the store changes while it is being read.
+ * 
+ * @return std::vector<Employee> - A list of employees.
+*/
+std::vector<Employee> ListScreen::getEmployees()
+{
+    if (this->employeesOverriden)
+    {
+        return this->employees;
+    }
+
+    SnapshotStore::Snapshot snapshot = this->app->snapshot();
+    std::vector<Employee> employees;
+    employees.reserve(snapshot.size());
+    for (size_t row = 0; row < snapshot.size(); ++row)
+    {
+        employees.push_back(snapshot.at(row)->employee);
+    }
+
+    return employees;
+}
+
+/**
+ * @function ListScreen::renderInteractiveContent
+ *
+ * @description - This function will print a list of employees to the screen. If the screen is in remove mode,
+ * it will allow the user to select an employee to remove. If the screen is in list mode, it will simply display
+ * the list of employees.
+ *
+ * @return void
+ *
+ */
+void ListScreen::renderInteractiveContent()
+{
+    if (this->results)
+    {
+        this->printResultsPage();
+    }
+    else
+    {
+        for (auto e : this->getEmployees())
+        {
+            // This will prevent users from seeing their own account to delete
+            if (!(this->isRemove && e.id == this->app->getLoggedInEmployee()->id))
+            {
+                std::cout << e.toString(0);
+            }
+        }
+    }
+
+    std::cout << std::endl;
+    if (this->resultsOpen)
+    {
+        std::cout << "n. Show More" << std::endl;
+    }
+    std::cout << "0. Return to Menu" << std::endl
+         << std::endl;
+
+    int id;
+    Employee *employee;
+    while (true)
+    {
+        std::cout << "Choice> ";
+        std::string input;
+        std::cin >> input;
+
+        if (this->resultsOpen && input == "n")
+        {
+            std::cout << std::endl;
+            this->printResultsPage();
+            std::cout << std::endl;
+            continue;
+        }
+
+        std::istringstream iss(input);
+        iss >> id;
+
+        if (!iss.fail())
+        {
+            employee = this->app->lookupEmployee(id);
+            if (id == 0 || employee != nullptr)
+            {
+                break;
+            }
+        }
+
+        std::cout << std::endl
+             << "ID must be of type int." << std::endl;
+    }
+
+    // The user has what they need, don't keep scanning behind their back.
+    this->stopResults();
+
+    if (id == 0)
+    {
+        this->app->navigateToScreen("menu");
+        return;
+    }
+
+    if (this->isRemove)
+    {
+        // Build the remove screen
+        std::string error;
+        if (!this->app->removeEmployeeById(id, &error))
+        {
+            this->notice = error;
+        }
+        this->display();
+    }
+    else
+    {
+        // This is the default behavior for the list screen.
+        FileScreen fileScreen(this->app, employee);
+        fileScreen.display();
+    }
+}
+
+/**
+ * @function ListScreen::printResultsPage
+ *
+ * @description - Prints up to LIST_PAGE_SIZE records from the streamed search, waiting for them
+ * to arrive if the search is still running.
+ *
+ * @return bool - Returns true if the search may still have more rows to show.
+ */
+bool ListScreen::printResultsPage()
+{
+    size_t printed = 0;
+    RecordRef record;
+    while (this->resultsOpen && printed < LIST_PAGE_SIZE)
+    {
+        if (!this->results->pop(record))
+        {
+            this->resultsOpen = false;
+            break;
+        }
+
+        std::cout << record->employee.toString(0);
+        printed++;
+    }
+
+    if (printed == 0 && !this->resultsOpen)
+    {
+        std::cout << "No more employees found." << std::endl;
+    }
+
+    return this->resultsOpen;
+}
+
+/**
+ * @function ListScreen::stopResults
+ *
+ * @description - Cancels the streamed search and waits for it to unpin its snapshot. Safe to
+ * call more than once, or on a list that was not streamed.
+ *
+ * @return void
+ */
+void ListScreen::stopResults()
+{
+    if (this->results)
+    {
+        this->results->cancel();
+        this->results->waitClosed();
+        this->results.reset();
+    }
+
+    this->resultsOpen = false;
+}
+
+/**
+ * @function SearchScreen::renderInteractiveContent
+ * 
+ * @description - This function will prompt the user to input a search query. It will then start a search of
+ * the employees in the application and display the results to the screen as they are found.
+ * 
+ * @return void
+*/
+void SearchScreen::renderInteractiveContent()
+{
+    /* START SEARCH */
+    std::string query;
+
+    std::cout << "Query> ";
+    std::cin >> query;
+
+    ListScreen searchList(this->app, query, this->app->streamSearch(query));
+    searchList.display();
+}
+
+/**
+ * 
+ * @function AddEmployeeScreen::renderInteractiveContent
+ * 
+ * @description - This function will prompt the user to input information about a new employee. It will then
+ * add the employee to the application and navigate back to the menu screen.
+ * 
+ * @return void
+*/
+void AddEmployeeScreen::renderInteractiveContent()
+{
+    std::string firstName, lastName, username, password;
+    int isHR, isMan;
+
+    firstName = promptField("First Name> ", false);
+    lastName = promptField("Last Name> ", false);
+
+    do
+    {
+        username = promptField("Username> ", false);
+    } while (username.empty() || !this->app->uniqueUsername(username));
+
+    password = promptField("Password> ", false);
+
+    while (true)
+    {
+        std::cout << "Is employee hr? (0: no, 1: yes)> ";
+        std::string input;
+        std::cin >> input;
+        std::istringstream iss(input);
+        iss >> isHR;
+
+        if (!iss.fail() && (isHR == 0 || isHR == 1))
+        {
+            break;
+        }
+
+        std::cout << std::endl
+             << "Please input a valid option." << std::endl;
+    }
+
+    while (true)
+    {
+        std::cout << "Is employee management? (0: no, 1: yes)> ";
+        std::string input;
+        std::cin >> input;
+        std::istringstream iss(input);
+        iss >> isMan;
+
+        if (!iss.fail() && (isMan == 0 || isMan == 1))
         {
-            if (e.id == id)
-            {
-                return &e;
-            }
+            break;
         }
 
-        return nullptr;
+        std::cout << std::endl
+             << "Please input a valid option." << std::endl;
     }
 
-    /**
-     * 
-     * @function removeEmployeeById
-     * 
-     * @description - This function will remove an employee by their id.
-     * 
-     * @param int id - The id of the employee to remove. Won't let you delete the currently logged in employee.
-     * 
-     * @return void 
-    */
-    void removeEmployeeById(int id)
+    std::string department = promptField("Department (" + NO_DEPARTMENT + ": none)> ", false);
+    if (department == NO_DEPARTMENT)
     {
-        // Prevent deleting currently logged in employee
-        if (id == this->employee.id)
+        department.clear();
+    }
+
+    int managerId;
+    while (true)
+    {
+        std::cout << "Manager Id (0: none)> ";
+        std::string input;
+        std::cin >> input;
+        std::istringstream iss(input);
+        iss >> managerId;
+
+        if (!iss.fail() && this->app->canReportTo(this->app->currentId + 1, managerId))
         {
-            return;
+            break;
         }
 
-        for (auto it = this->employees.begin(); it != this->employees.end(); ++it)
+        std::cout << std::endl
+             << "Please input the id of an existing employee." << std::endl;
+    }
+
+    static const char *columnPrompts[NUMERIC_COLUMNS] = {"Hire Date (YYYY-MM-DD", "Salary Band (whole number",
+                                                          "FTE (1 is full time"};
+    int32_t columnValues[NUMERIC_COLUMNS];
+    for (int column = 0; column < NUMERIC_COLUMNS; ++column)
+    {
+        while (true)
         {
-            if (it->id == id)
+            std::cout << columnPrompts[column] << "; " << NO_DEPARTMENT << ": unknown)> ";
+            std::string input;
+            std::cin >> input;
+
+            columnValues[column] = 0;
+            if (input == NO_DEPARTMENT || parseColumnValue(column, input, columnValues[column]))
             {
-                fs::remove(it->file);
-                this->employees.erase(it);
                 break;
             }
+
+            std::cout << std::endl
+                 << "Please input a valid value." << std::endl;
         }
     }
 
-    /**
-     * @function searchMatch
-     * 
-     * @description - This function will search for a query in a test string. Not case sensitive.
-     * 
-     * @param string test - The string to search in.
-     * @param string query - The string to search for.
-     * 
-     * @return bool - Returns true if the query is found in the test string, false otherwise.
-    */
-    bool searchMatch(std::string test, std::string query)
-    {
-        std::transform(test.begin(), test.end(), test.begin(), [](unsigned char c)
-                       { return std::tolower(c); });
-        std::transform(query.begin(), query.end(), query.begin(), [](unsigned char c)
-                       { return std::tolower(c); });
+    this->app->currentId++;
+    Employee e(this->app->currentId, firstName, lastName, username, password,
+               (HR_PERMS * isHR) | (MANAGEMENT_PERMS * isMan) | GENERAL_PERMS, managerId);
+    e.department = department;
+    e.hireDate = columnValues[COLUMN_HIRE_DATE];
+    e.salaryBand = columnValues[COLUMN_SALARY_BAND];
+    e.ftePercent = columnValues[COLUMN_FTE];
+    this->app->addEmployee(e);
 
-        return test.find(query) != std::string::npos;
-    }
+    this->app->navigateToScreen("menu");
+}
 
-    std::vector<Employee> searchEmployees(std::string query)
+/**
+ * @function EditScreen::renderInteractiveContent
+ * 
+ * @description - This function will prompt the user to input information about an employee. It will then
+ * update the employee in the application and navigate back to the menu screen.
+ * 
+ * @return void
+*/
+void EditScreen::renderInteractiveContent()
+{
+    std::string firstName, lastName, username, password;
+    int isHR, isMan;
+
+    // The employee as it was read, its revision is what the save is checked against.
+    Employee base = *this->employee;
+
+    // Clear cin because we want empty input
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+
+    firstName = promptField("First Name (Current: " + this->employee->firstName + ")> ", true);
+    lastName = promptField("Last Name (Current: " + this->employee->lastName + ")> ", true);
+
+    do
     {
-        std::vector<Employee> out;
+        username = promptField("Username (Current: " + this->employee->username + ")> ", true);
 
-        for (auto e : this->employees)
+        if (username.empty())
         {
-            if (this->searchMatch(e.firstName, query) || this->searchMatch(e.lastName, query) || this->searchMatch(e.username, query))
-            {
-                out.push_back(e);
-            }
+            break;
         }
+    } while (!this->app->uniqueUsername(username, this->employee->id));
 
-        return out;
-    }
+    password = promptField("Password> ", true);
 
-    /**
-     * @function uniqueUsername
-     * 
-     * @description - This function will check if a username is unique.
-     * 
-     * @param string username - The username to check.
-     * 
-     * @return bool - Returns true if the username is unique, false otherwise.
-    */
-    bool uniqueUsername(std::string username)
+    std::string department = promptField("Department (" + NO_DEPARTMENT + ": none; Current: " +
+                                             (this->employee->department.empty() ? NO_DEPARTMENT : this->employee->department) + ")> ",
+                                         true);
+
+    std::string managerInput;
+    int managerId = this->employee->managerId;
+    while (true)
     {
-        for (auto e : this->employees)
+        std::cout << "Manager Id (0: none; Current: " << this->employee->managerId << ")> ";
+        getline(std::cin, managerInput);
+
+        if (managerInput.empty())
         {
-            if (e.username == username)
-            {
-                return false;
-            }
+            break;
         }
 
-        return true;
+        std::istringstream iss(managerInput);
+        iss >> managerId;
+        if (!iss.fail() && this->app->canReportTo(this->employee->id, managerId))
+        {
+            break;
+        }
+
+        managerId = this->employee->managerId;
+        std::cout << std::endl
+             << "Please input the id of an existing employee outside their org." << std::endl;
     }
 
-    /**
-     * @function uniqueUsername
-     * 
-     * @description - This function will check if a username is unique, but will skip a specific id.
-     * 
-     * @param string username - The username to check.
-     * @param int skipId - The id to skip.
-     * 
-     * @return bool - Returns true if the username is unique, false otherwise.
-    */
-    bool uniqueUsername(std::string username, int skipId)
+    static const char *columnPrompts[NUMERIC_COLUMNS] = {"Hire Date (YYYY-MM-DD", "Salary Band (whole number",
+                                                          "FTE (1 is full time"};
+    std::string columnInputs[NUMERIC_COLUMNS];
+    int32_t columnValues[NUMERIC_COLUMNS];
+    for (int column = 0; column < NUMERIC_COLUMNS; ++column)
     {
-        for (auto e : this->employees)
+        int32_t current = this->employee->getColumn(column);
+        std::string shown = current == 0                   ? NO_DEPARTMENT
+                            : column == COLUMN_HIRE_DATE ? formatDate(current)
+                            : column == COLUMN_FTE       ? std::to_string(current / 100.0)
+                                                         : std::to_string(current);
+        while (true)
         {
-            if (e.username == username && e.id != skipId)
+            std::cout << columnPrompts[column] << "; " << NO_DEPARTMENT << ": unknown; Current: " << shown << ")> ";
+            getline(std::cin, columnInputs[column]);
+
+            columnValues[column] = 0;
+            if (columnInputs[column].empty() || columnInputs[column] == NO_DEPARTMENT ||
+                parseColumnValue(column, columnInputs[column], columnValues[column]))
             {
-                return false;
+                break;
             }
-        }
 
-        return true;
+            std::cout << std::endl
+                 << "Please input a valid value." << std::endl;
+        }
     }
-};
-
-/**
- * ******************************************************
- * DEFINE METHODS FOR SCREENS THAT DEPEND ON APPLICATION
- * ******************************************************
-*/
-
-/**
- * @function LoginScreen::renderInteractiveContent
- *
- * @description - This function prints two input prompts for the user to enter their
- * username and password. It will then attempt to login the user. If the login is successful,
- * it will navigate to the menu screen. 
- *
- * @return void
- *
- */
-void LoginScreen::renderInteractiveContent()
-{
-    /* START LOGIN */
-    std::string username, password;
 
+    int currentHR = employee->hasPermission(HR_PERMS) ? 1 : 0;
     while (true)
     {
-        std::cout << "Username> ";
-        getline(std::cin, username);
-
-        std::cout << "Password> ";
-        getline(std::cin, password);
+        std::cout << "Is employee hr? (0: no, 1: yes; Current: " << currentHR << ")> ";
+        std::string input;
+        std::cin >> input;
+        std::istringstream iss(input);
+        iss >> isHR;
 
-        if (this->app->login(username, password))
+        if (!iss.fail() && (isHR == 0 || isHR == 1))
         {
             break;
         }
 
         std::cout << std::endl
-             << "Invalid login, please try again." << std::endl;
+             << "Please input a valid option." << std::endl;
     }
 
-    // We are successful, request next screen.
-    this->app->navigateToScreen("menu");
-}
-
-/**
- * @function MenuScreen::prePrintHeader
- *
- * @description - This function will set the header text to welcome the logged in employee.
- *
- * @return void
- *
- */
-void MenuScreen::prePrintHeader()
-{
-    const Employee *employee = app->getLoggedInEmployee();
-    std::ostringstream oss;
-
-    oss << "Welcome " << employee->firstName << " " << employee->lastName << "!";
-    this->headerText = oss.str();
-}
-
-void MenuScreen::buildMenuOptions()
-{
-    Employee *employee = app->getLoggedInEmployee();
-    std::string screens[5][2] = {
-        {"list", "View Employees"},
-        {"search", "Search Employees"},
-        {"add", "Add Employee"},
-        {"remove", "Remove Employee"},
-        {"file", "View Your File"}
-    };
-
-    // Loop through each screen and add it to the menu if the employee has permission.
-    for (int i = 0; i < 5; ++i)
+    int currentMan = employee->hasPermission(MANAGEMENT_PERMS) ? 1 : 0;
+    while (true)
     {
-        switch (i)
-        {
-        case 0:
-        case 1:
-            if (employee->hasPermission(HR_PERMS) ||
-                employee->hasPermission(MANAGEMENT_PERMS))
-            {
-                MenuOption newOption;
-                newOption.name = screens[i][1];
-                newOption.menuPosition = this->options.size() + 1;
-                newOption.screenName = screens[i][0];
+        std::cout << "Is employee management? (0: no, 1: yes; Current: " << currentMan << ")> ";
+        std::string input;
+        std::cin >> input;
+        std::istringstream iss(input);
+        iss >> isMan;
 
-                this->options.push_back(newOption);
-            }
+        if (!iss.fail() && (isMan == 0 || isMan == 1))
+        {
             break;
-        case 2:
-        case 3:
-            if (employee->hasPermission(HR_PERMS))
-            {
-                MenuOption newOption;
-                newOption.name = screens[i][1];
-                newOption.menuPosition = this->options.size() + 1;
-                newOption.screenName = screens[i][0];
+        }
 
-                this->options.push_back(newOption);
-            }
-            break;
-        default:
-            if (employee->hasPermission(GENERAL_PERMS))
-            {
-                MenuOption newOption;
-                newOption.name = screens[i][1];
-                newOption.menuPosition = this->options.size() + 1;
-                newOption.screenName = screens[i][0];
+        std::cout << std::endl
+             << "Please input a valid option." << std::endl;
+    }
 
-                this->options.push_back(newOption);
-            }
-        }
+    // Changes are made to a copy so the application can see what changed when it saves.
+    Employee updated = base;
+    bool dirty = false;
+    if (!firstName.empty())
+    {
+        updated.firstName = firstName;
+        dirty = true;
     }
 
-    // Set flag to true so we don't rebuild the menu options.
-    this->optionsInitialized = true;
-}
+    if (!lastName.empty())
+    {
+        updated.lastName = lastName;
+        dirty = true;
+    }
 
-/**
- * @function MenuScreen::renderInteractiveContent
- *
- * @description - This function will print the menu options to the screen and prompt the user
- * to make a selection. If the user selects an option, it will navigate to the appropriate screen.
- *
- * @return void
- *
- */
-void MenuScreen::renderInteractiveContent()
-{
-    if (!this->optionsInitialized)
+    if (!username.empty())
     {
-        this->buildMenuOptions();
+        updated.username = username;
+        dirty = true;
     }
 
-    for (auto o : this->options)
+    if (!password.empty())
     {
-        std::cout << o.menuPosition << ". " << o.name << std::endl;
+        updated.updatePassword(password);
+        dirty = true;
     }
 
-    std::cout << std::endl
-         << "0. Exit Application" << std::endl
-         << std::endl;
-
-    int choice;
-    while (true)
+    if (managerId != updated.managerId)
     {
-        std::cout << "Choice> ";
-        std::string input;
-        std::cin >> input;
-        std::istringstream iss(input);
-        iss >> choice;
+        updated.managerId = managerId;
+        dirty = true;
+    }
 
-        if (choice == 0 || (choice > 0 && choice - 1 < this->options.size()))
-        {
-            break;
-        }
+    if (!department.empty())
+    {
+        updated.department = department == NO_DEPARTMENT ? "" : department;
+        dirty = true;
+    }
 
-        std::cout << std::endl
-             << "Please input a valid option." << std::endl;
+    if (!columnInputs[COLUMN_HIRE_DATE].empty())
+    {
+        updated.hireDate = columnValues[COLUMN_HIRE_DATE];
+        dirty = true;
     }
 
-    if (choice == 0)
+    if (!columnInputs[COLUMN_SALARY_BAND].empty())
     {
-        return;
+        updated.salaryBand = columnValues[COLUMN_SALARY_BAND];
+        dirty = true;
     }
 
-    // Remove
-    if (this->options.at(choice - 1).screenName == "remove")
+    if (!columnInputs[COLUMN_FTE].empty())
     {
-        ListScreen removeScreen(this->app, "remove");
-        removeScreen.display();
+        updated.ftePercent = columnValues[COLUMN_FTE];
+        dirty = true;
     }
 
-    this->app->navigateToScreen(this->options.at(choice - 1).screenName);
-}
+    short permissions = (HR_PERMS * isHR) | (MANAGEMENT_PERMS * isMan) | GENERAL_PERMS;
+    if (permissions != updated.getPermissions())
+    {
+        updated.updatePermissions(permissions);
+        dirty = true;
+    }
 
-/**
- * @function ListScreen::getEmployees
- * 
- * @description - This function will return a list of employees. If the employees have been overriden, it will return
- * the overriden list. Otherwise, it will return the list of employees from the application.
- * 
- * @return std::vector<Employee> - A list of employees.
-*/
-std::vector<Employee> ListScreen::getEmployees()
-{
-    if (this->employeesOverriden)
+    std::string error;
+    bool saved = dirty && this->app->updateEmployee(updated, error);
+    if (saved)
     {
-        return this->employees;
+        this->app->audit.record(AUDIT_EDIT, this->app->getLoggedInEmployee()->id, base.id);
+    }
+    else if (dirty)
+    {
+        std::cout << std::endl
+                  << error << " Your changes were not saved." << std::endl
+                  << std::endl
+                  << "0. Return to Menu" << std::endl
+                  << "1. Edit Again" << std::endl
+                  << std::endl
+                  << "Choice> ";
+        std::string input;
+        std::cin >> input;
+
+        // The store now has what the other session saved, edit that instead.
+        Employee *fresh = this->app->findEmployeeById(base.id);
+        if (input == "1" && fresh != nullptr)
+        {
+            EditScreen editScreen(this->app, fresh);
+            editScreen.display();
+            return;
+        }
     }
 
-    return this->app->employees;
+    this->app->navigateToScreen("menu");
 }
 
 /**
- * @function ListScreen::renderInteractiveContent
+ * @function DepartmentScreen::renderInteractiveContent
  *
- * @description - This function will print a list of employees to the screen. If the screen is in remove mode,
- * it will allow the user to select an employee to remove. If the screen is in list mode, it will simply display
- * the list of employees.
+ * @description - Prints the headcount of every department with how many members hold each role,
+ * read straight from the department counters. The user can then name a department to list its
+ * employees.
  *
  * @return void
- *
  */
-void ListScreen::renderInteractiveContent()
+void DepartmentScreen::renderInteractiveContent()
 {
-    for (auto e : this->getEmployees())
+    size_t total = 0;
+    for (const auto &entry : this->app->getDepartments())
     {
-        // This will prevent users from seeing their own account to delete
-        if (!(this->isRemove && e.id == this->app->getLoggedInEmployee()->id))
-        {
-            std::cout << e.toString(0);
-        }
+        const Department &department = entry.second;
+        total += department.members.size();
+
+        std::cout << (entry.first.empty() ? "(none)" : entry.first) << ": " << department.members.size()
+                  << " (HR " << department.hr << ", Management " << department.management
+                  << ", General " << department.general << ")" << std::endl;
     }
 
-    std::cout << std::endl
-         << "0. Return to Menu" << std::endl
-         << std::endl;
+    std::cout << "Total: " << total << std::endl
+              << std::endl
+              << "0. Return to Menu" << std::endl
+              << std::endl;
 
-    int id;
-    Employee *employee;
-    while (true)
+    std::string name = promptField("Department> ", false);
+
+    if (name == "0")
     {
-        std::cout << "Choice> ";
-        std::string input;
-        std::cin >> input;
-        std::istringstream iss(input);
-        iss >> id;
+        this->app->navigateToScreen("menu");
+        return;
+    }
 
-        if (!iss.fail())
-        {
-            employee = this->app->findEmployeeById(id);
-            if (id == 0 || employee != nullptr)
-            {
-                break;
-            }
-        }
+    ListScreen departmentList(this->app, "", this->app->departmentMembers(name == NO_DEPARTMENT ? "" : name));
+    departmentList.name = "department-list";
+    departmentList.headerText = "Department: " + name;
+    departmentList.display();
+}
 
-        std::cout << std::endl
-             << "ID must be of type int." << std::endl;
+/**
+ * @function printPayrollSummary
+ *
+ * @description - Prints the payroll aggregates for the employees matching a filter. Shared by
+ * the payroll screen and the --payroll command.
+ *
+ * @param Application *app - The application object.
+ * @param string filter - A range query, or "all" for every employee.
+ *
+ * @return bool - Returns false if the filter could not be parsed.
+ */
+bool printPayrollSummary(Application *app, std::string filter)
+{
+    std::vector<RangePredicate> predicates;
+    if (filter != "all" && !parseRangeQuery(filter, predicates))
+    {
+        std::cout << "Invalid filter \"" << filter << "\"." << std::endl;
+        return false;
     }
 
-    if (id == 0)
+    std::vector<uint8_t> selected = app->selectRows(predicates);
+    size_t matched = std::count(selected.begin(), selected.end(), 1);
+
+    ColumnSummary salary = app->summarize(COLUMN_SALARY_BAND, selected);
+    ColumnSummary fte = app->summarize(COLUMN_FTE, selected);
+    ColumnSummary hired = app->summarize(COLUMN_HIRE_DATE, selected);
+
+    std::cout << "Employees: " << matched << std::endl;
+    std::cout << "Salary Band (" << salary.count << " set): ";
+    if (salary.count > 0)
     {
-        this->app->navigateToScreen("menu");
+        std::cout << "total " << salary.sum << ", min " << salary.min << ", max " << salary.max
+                  << ", avg " << salary.average();
     }
+    std::cout << std::endl;
 
-    if (this->isRemove)
+    std::cout << "FTE (" << fte.count << " set): ";
+    if (fte.count > 0)
     {
-        // Build the remove screen
-        this->app->removeEmployeeById(id);
-        this->display();
+        std::cout << "total " << fte.sum / 100.0 << ", min " << fte.min / 100.0 << ", max "
+                  << fte.max / 100.0 << ", avg " << fte.average() / 100.0;
     }
-    else
+    std::cout << std::endl;
+
+    std::cout << "Hired (" << hired.count << " set): ";
+    if (hired.count > 0)
     {
-        // This is the default behavior for the list screen.
-        FileScreen fileScreen(this->app, employee);
-        fileScreen.display();
+        std::cout << "first " << formatDate(hired.min) << ", last " << formatDate(hired.max);
     }
+    std::cout << std::endl;
+
+    return true;
 }
 
 /**
- * @function SearchScreen::renderInteractiveContent
- * 
- * @description - This function will prompt the user to input a search query. It will then search the employees
- * in the application for the query and display the results to the screen.
- * 
+ * @function PayrollScreen::renderInteractiveContent
+ *
+ * @description - Asks for a filter, then prints the payroll aggregates for the matching employees
+ * and waits for the user before going back to the menu.
+ *
  * @return void
-*/
-void SearchScreen::renderInteractiveContent()
+ */
+void PayrollScreen::renderInteractiveContent()
 {
-    /* START SEARCH */
-    std::string query;
+    std::string filter;
+    do
+    {
+        std::cout << "Filter> ";
+        std::cin >> filter;
+        std::cout << std::endl;
+    } while (!printPayrollSummary(this->app, filter));
 
-    std::cout << "Query> ";
-    std::cin >> query;
+    std::cout << std::endl
+              << "0. Return to Menu" << std::endl
+              << std::endl
+              << "Choice> ";
+    std::string input;
+    std::cin >> input;
 
-    std::vector<Employee> results = this->app->searchEmployees(query);
-    ListScreen searchList(this->app, query, results);
-    searchList.display();
+    this->app->navigateToScreen("menu");
 }
 
 /**
- * 
- * @function AddEmployeeScreen::renderInteractiveContent
- * 
- * @description - This function will prompt the user to input information about a new employee. It will then
- * add the employee to the application and navigate back to the menu screen.
- * 
+ * @function ReorgScreen::renderInteractiveContent
+ *
+ * @description - Asks for the manager to move reports from, the manager to move them to, and an
+ * optional new department, then moves every direct report in one transaction. If any report
+ * can't be moved, none are.
+ *
  * @return void
-*/
-void AddEmployeeScreen::renderInteractiveContent()
+ */
+void ReorgScreen::renderInteractiveContent()
 {
-    std::string firstName, lastName, username, password;
-    int isHR, isMan;
+    int fromId, toId;
+    while (true)
+    {
+        std::cout << "From Manager Id (0: cancel)> ";
+        std::string input;
+        std::cin >> input;
+        std::istringstream iss(input);
+        iss >> fromId;
 
-    std::cout << "First Name> ";
-    std::cin >> firstName;
+        if (!iss.fail() && (fromId == 0 || this->app->findEmployeeById(fromId) != nullptr))
+        {
+            break;
+        }
 
-    std::cout << "Last Name> ";
-    std::cin >> lastName;
+        std::cout << "Manager Id must be the id of an employee." << std::endl;
+    }
 
-    do
+    if (fromId == 0)
     {
-        std::cout << "Username> ";
-        std::cin >> username;
-    } while (username.empty() || !this->app->uniqueUsername(username));
-
-    std::cout << "Password> ";
-    std::cin >> password;
+        this->app->navigateToScreen("menu");
+        return;
+    }
 
     while (true)
     {
-        std::cout << "Is employee hr? (0: no, 1: yes)> ";
+        std::cout << "To Manager Id> ";
         std::string input;
         std::cin >> input;
         std::istringstream iss(input);
-        iss >> isHR;
+        iss >> toId;
 
-        if (!iss.fail() && (isHR == 0 || isHR == 1))
+        if (!iss.fail() && toId != fromId && this->app->findEmployeeById(toId) != nullptr)
         {
             break;
         }
 
-        std::cout << std::endl
-             << "Please input a valid option." << std::endl;
+        std::cout << "Manager Id must be the id of another employee." << std::endl;
     }
 
-    while (true)
+    std::string department = promptField("Department (-: keep)> ", false);
+
+    Transaction transaction = this->app->beginTransaction();
+    std::string error;
+    for (const Employee &report : this->app->reportsOf(fromId))
     {
-        std::cout << "Is employee management? (0: no, 1: yes)> ";
-        std::string input;
-        std::cin >> input;
-        std::istringstream iss(input);
-        iss >> isMan;
+        // reportsOf walks the whole org, only the direct reports move.
+        if (report.managerId != fromId || report.id == toId)
+        {
+            continue;
+        }
 
-        if (!iss.fail() && (isMan == 0 || isMan == 1))
+        if (!this->app->canReportTo(report.id, toId))
         {
+            error = report.firstName + " " + report.lastName + " can't report to someone in their own org.";
+            transaction.abort();
             break;
         }
 
-        std::cout << std::endl
-             << "Please input a valid option." << std::endl;
+        Employee *staged = transaction.stage(report.id);
+        staged->managerId = toId;
+        if (department != NO_DEPARTMENT)
+        {
+            staged->department = department;
+        }
     }
 
-    this->app->currentId++;
-    Employee e(this->app->currentId, firstName, lastName, username, password,
-               (HR_PERMS * isHR) | (MANAGEMENT_PERMS * isMan) | GENERAL_PERMS);
-    e.write();
-    this->app->employees.push_back(e);
+    std::cout << std::endl;
+    size_t moved = transaction.size();
+    if (transaction.isOpen() && transaction.commit(error))
+    {
+        std::cout << "Moved " << moved << " employees." << std::endl;
+    }
+    else
+    {
+        std::cout << "Nothing was changed. " << error << std::endl;
+    }
+
+    std::cout << std::endl
+              << "0. Return to Menu" << std::endl
+              << std::endl
+              << "Choice> ";
+    std::string input;
+    std::cin >> input;
 
     this->app->navigateToScreen("menu");
 }
 
 /**
- * @function EditScreen::renderInteractiveContent
- * 
- * @description - This function will prompt the user to input information about an employee. It will then
- * update the employee in the application and navigate back to the menu screen.
- * 
+ * @function ArchiveScreen::renderInteractiveContent
+ *
+ * @description - Lists every archived employee with the day they were removed, then restores the
+ * one the user picks.
+ *
  * @return void
-*/
-void EditScreen::renderInteractiveContent()
+ */
+void ArchiveScreen::renderInteractiveContent()
 {
-    std::string firstName, lastName, username, password;
-    int isHR, isMan;
-
-    // Clear cin because we want empty input
-    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-
-    std::cout << "First Name (Current: " << this->employee->firstName << ")> ";
-    getline(std::cin, firstName);
-
-    std::cout << "Last Name (Current: " << this->employee->lastName << ")> ";
-    getline(std::cin, lastName);
-
-    do
+    std::vector<ArchivedEmployee> archived = this->app->archivedEmployees();
+    for (const ArchivedEmployee &entry : archived)
     {
-        std::cout << "Username (Current: " << this->employee->username << ")> ";
-        getline(std::cin, username);
-
-        if (username.empty())
-        {
-            break;
-        }
-    } while (!this->app->uniqueUsername(username, this->employee->id));
+        std::cout << entry.employee.id << ": " << entry.employee.firstName << " " << entry.employee.lastName
+                  << ", " << entry.employee.username << " (removed " << formatDate(entry.removedAt / 86400) << ")"
+                  << std::endl;
+    }
+    if (archived.empty())
+    {
+        std::cout << "No removed employees." << std::endl;
+    }
 
-    std::cout << "Password> ";
-    getline(std::cin, password);
+    std::cout << std::endl
+              << "0. Return to Menu" << std::endl
+              << std::endl;
 
-    int currentHR = employee->hasPermission(HR_PERMS) ? 1 : 0;
+    int id;
     while (true)
     {
-        std::cout << "Is employee hr? (0: no, 1: yes; Current: " << currentHR << ")> ";
+        std::cout << "Choice> ";
         std::string input;
         std::cin >> input;
         std::istringstream iss(input);
-        iss >> isHR;
+        iss >> id;
 
-        if (!iss.fail() && (isHR == 0 || isHR == 1))
+        if (!iss.fail())
         {
             break;
         }
 
         std::cout << std::endl
-             << "Please input a valid option." << std::endl;
+             << "ID must be of type int." << std::endl;
     }
 
-    int currentMan = employee->hasPermission(MANAGEMENT_PERMS) ? 1 : 0;
-    while (true)
+    if (id == 0)
     {
-        std::cout << "Is employee management? (0: no, 1: yes; Current: " << currentMan << ")> ";
-        std::string input;
-        std::cin >> input;
-        std::istringstream iss(input);
-        iss >> isMan;
-
-        if (!iss.fail() && (isMan == 0 || isMan == 1))
-        {
-            break;
-        }
-
-        std::cout << std::endl
-             << "Please input a valid option." << std::endl;
+        this->app->navigateToScreen("menu");
+        return;
     }
 
-    bool dirty = false;
-    if (!firstName.empty())
+    std::string error;
+    if (!this->app->restoreEmployee(id, error))
     {
-        this->employee->firstName = firstName;
-        dirty = true;
+        this->notice = error;
     }
+    this->display();
+}
 
-    if (!lastName.empty())
+/**
+ * @function UndoScreen::renderInteractiveContent
+ *
+ * @description - Shows what would be undone and redone, then applies the one the user picks.
+ *
+ * @return void
+ */
+void UndoScreen::renderInteractiveContent()
+{
+    const UndoStep *nextUndo = this->app->nextUndo();
+    const UndoStep *nextRedo = this->app->nextRedo();
+
+    std::cout << "Undo: " << (nextUndo == nullptr ? "nothing" : nextUndo->describe()) << std::endl
+              << "Redo: " << (nextRedo == nullptr ? "nothing" : nextRedo->describe()) << std::endl
+              << std::endl
+              << "1. Undo" << std::endl
+              << "2. Redo" << std::endl
+              << "0. Return to Menu" << std::endl
+              << std::endl
+              << "Choice> ";
+
+    std::string input;
+    std::cin >> input;
+
+    std::string error;
+    bool applied = true;
+    if (input == "1")
     {
-        this->employee->lastName = lastName;
-        dirty = true;
+        applied = this->app->undo(error);
     }
-
-    if (!username.empty())
+    else if (input == "2")
     {
-        this->employee->username = username;
-        dirty = true;
+        applied = this->app->redo(error);
     }
-
-    if (!password.empty())
+    else
     {
-        this->employee->updatePassword(password);
-        dirty = true;
+        this->app->navigateToScreen("menu");
+        return;
     }
 
-    this->employee->updatePermissions((HR_PERMS * isHR) | (MANAGEMENT_PERMS * isMan) | GENERAL_PERMS);
-
-    if (dirty)
+    if (!applied)
     {
-        this->employee->write();
+        this->notice = error;
     }
-
-    this->app->navigateToScreen("menu");
+    this->display();
 }
 
 /**
@@ -1550,15 +11496,33 @@ Employee *FileScreen::getEmployee()
 void FileScreen::renderInteractiveContent()
 {
     Employee *emp = this->getEmployee();
+    this->app->audit.record(AUDIT_VIEW, this->app->getLoggedInEmployee()->id, emp->id);
     std::cout << emp->toString(1);
 
+    std::vector<Employee> chain = this->app->managementChain(emp->id);
+    if (!chain.empty())
+    {
+        std::cout << "Reports To: ";
+        for (size_t i = 0; i < chain.size(); ++i)
+        {
+            std::cout << (i == 0 ? "" : " > ") << chain[i].firstName << " " << chain[i].lastName;
+        }
+        std::cout << std::endl;
+    }
+
     std::cout << std::endl
          << "0. Return to Menu";
-    if (this->app->getLoggedInEmployee()->id != emp->id && this->app->getLoggedInEmployee()->hasPermission(HR_PERMS))
+    if (this->app->getLoggedInEmployee()->id != emp->id && this->app->getLoggedInEmployee()->hasPermission(HR_PERMS) &&
+        !this->app->isReplica())
     {
         std::cout << std::endl
              << "1. Edit Employee";
     }
+    if (this->app->getLoggedInEmployee()->hasPermission(HR_PERMS))
+    {
+        std::cout << std::endl
+             << "2. View History";
+    }
     std::cout << std::endl
          << std::endl;
 
@@ -1585,16 +11549,530 @@ void FileScreen::renderInteractiveContent()
         EditScreen editScreen(this->app, emp);
         editScreen.display();
     }
+    else if (choice == 2 && this->app->getLoggedInEmployee()->hasPermission(HR_PERMS))
+    {
+        HistoryScreen historyScreen(this->app, emp->id);
+        historyScreen.display();
+    }
     else
     {
         this->app->navigateToScreen("menu");
     }
 }
 
-int main()
+/**
+ * @function describePermissions
+ *
+ * @description - Names the roles an employee's permissions give them.
+ *
+ * @param Employee e - The employee.
+ *
+ * @return string - Roles like "HR, Management, General", or "None".
+ */
+std::string describePermissions(const Employee &e)
+{
+    std::string roles;
+    const std::pair<short, const char *> named[] = {{HR_PERMS, "HR"}, {MANAGEMENT_PERMS, "Management"}, {GENERAL_PERMS, "General"}};
+    for (const auto &role : named)
+    {
+        if (e.hasPermission(role.first))
+        {
+            roles += roles.empty() ? "" : ", ";
+            roles += role.second;
+        }
+    }
+
+    return roles.empty() ? "None" : roles;
+}
+
+/**
+ * @function formatTime
+ *
+ * @description - Formats a point in time as a UTC date and time.
+ *
+ * @param time_t time - Seconds since 1970-01-01.
+ *
+ * @return string - Formatted like 2024-05-01 13:45.
+ */
+std::string formatTime(time_t time)
+{
+    int seconds = time % 86400;
+    char buffer[16];
+    std::snprintf(buffer, sizeof(buffer), " %02d:%02d", seconds / 3600, seconds / 60 % 60);
+    return formatDate(time / 86400) + buffer;
+}
+
+/**
+ * @function HistoryScreen::renderInteractiveContent
+ *
+ * @description - Lists every saved version of the employee with the fields it changed, then asks
+ * for dates and prints the record as it was at the end of each one until the user returns.
+ *
+ * @return void
+ */
+void HistoryScreen::renderInteractiveContent()
+{
+    std::vector<HistoryEntry> entries = RecordHistory::entries(this->id);
+    if (entries.empty())
+    {
+        std::cout << "No history has been recorded for this employee." << std::endl;
+    }
+
+    for (const HistoryEntry &entry : entries)
+    {
+        std::cout << formatTime(entry.time) << "  ";
+        if (entry.removed)
+        {
+            std::cout << "Removed" << std::endl;
+            continue;
+        }
+
+        std::cout << "Revision " << entry.employee.revision << ": ";
+        for (size_t i = 0; i < entry.changed.size(); ++i)
+        {
+            std::cout << (i == 0 ? "" : ", ") << entry.changed[i];
+        }
+        std::cout << std::endl;
+    }
+
+    while (true)
+    {
+        std::cout << std::endl
+                  << "As Of (YYYY-MM-DD; 0: return)> ";
+        std::string input;
+        std::cin >> input;
+
+        int days;
+        if (input == "0" || !parseDate(input, days))
+        {
+            break;
+        }
+
+        Employee then;
+        std::cout << std::endl;
+        // The whole day counts, so a change made on the date is included.
+        if (RecordHistory::asOf(this->id, endOfDay(days), this->app->lookupEmployee(this->id), &then))
+        {
+            std::cout << then.toString(1)
+                      << "Permissions: " << describePermissions(then) << std::endl;
+        }
+        else
+        {
+            std::cout << "No record of this employee on " << input << "." << std::endl;
+        }
+    }
+
+    this->app->navigateToScreen("menu");
+}
+
+/**
+ * @function printAuditLog
+ *
+ * @description - Parses an audit filter and prints the matching records, one per line.
+ *  - Filters are comma separated key=value pairs: actor, target, action, from, and to.
+ *  - from and to are dates, to includes the whole day. all matches everything.
+ *
+ * @param string filter - The filter text.
+ *
+ * @return bool - Returns false if the filter couldn't be parsed.
+ */
+bool printAuditLog(const std::string &filter)
+{
+    AuditFilter parsed;
+    std::istringstream terms(filter == "all" ? "" : filter);
+    std::string term;
+    while (getline(terms, term, ','))
+    {
+        size_t equals = term.find('=');
+        std::string key = term.substr(0, equals);
+        std::string value = equals == std::string::npos ? "" : term.substr(equals + 1);
+        int days;
+
+        if (key == "actor" || key == "target")
+        {
+            (key == "actor" ? parsed.actor : parsed.target) = std::atoi(value.c_str());
+        }
+        else if (key == "action")
+        {
+            for (uint32_t action = AUDIT_LOGIN; action <= AUDIT_RESTORE; ++action)
+            {
+                if (value == AuditLog::actionName(action))
+                {
+                    parsed.action = action;
+                }
+            }
+            if (parsed.action == 0)
+            {
+                std::cout << "Unknown action \"" << value << "\"." << std::endl;
+                return false;
+            }
+        }
+        else if ((key == "from" || key == "to") && parseDate(value, days))
+        {
+            if (key == "from")
+            {
+                parsed.fromMs = (int64_t)days * 86400000;
+            }
+            else
+            {
+                parsed.toMs = (int64_t)(days + 1) * 86400000 - 1;
+            }
+        }
+        else
+        {
+            std::cout << "Unknown filter \"" << term << "\"." << std::endl;
+            return false;
+        }
+    }
+
+    for (const AuditRecord &record : AuditLog::query(parsed))
+    {
+        std::cout << formatTime(record.timeMs / 1000) << "  " << AuditLog::actionName(record.action)
+                  << " actor=" << record.actor << " target=" << record.target << std::endl;
+    }
+
+    return true;
+}
+
+/**
+ * @function runSharedCommand
+ *
+ * @description - Handles the command line queries answered from the shared store a --share
+ * process keeps, which run before anything is loaded so they cost only attaching to it.
+ *  - --shared-get <id|username> - Prints one employee.
+ *  - --bench-shared <lookups> - Times attaching and looking up employees by id and username.
+ *
+ * @param string command - The flag given.
+ * @param string argument - The value given after the flag.
+ *
+ * @return int - Exit code for the process.
+ */
+int runSharedCommand(std::string command, std::string argument)
+{
+#if defined SHARED_STORE_POSIX
+    SharedStore store;
+    std::string error;
+    auto started = std::chrono::steady_clock::now();
+    if (!store.attach(error))
+    {
+        std::cout << error << std::endl;
+        return 2;
+    }
+    double attachSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    if (command == "--shared-get")
+    {
+        Employee e;
+        bool byId = !argument.empty() && std::all_of(argument.begin(), argument.end(), ::isdigit);
+        if (!(byId ? store.find(std::atoi(argument.c_str()), &e) : store.findUsername(argument, &e)))
+        {
+            std::cout << "No record." << std::endl;
+            return 1;
+        }
+        std::cout << e.toString(1) << "Permissions: " << describePermissions(e) << std::endl;
+    }
+    else if (command == "--bench-shared")
+    {
+        size_t lookups = std::strtoul(argument.c_str(), nullptr, 10);
+        std::vector<int> ids = store.ids();
+        std::vector<std::string> usernames;
+        std::mt19937 random(7);
+        for (size_t i = 0; i < lookups && !ids.empty(); ++i)
+        {
+            Employee e;
+            if (store.find(ids[random() % ids.size()], &e))
+            {
+                usernames.push_back(e.username);
+            }
+        }
+
+        size_t found = 0;
+        started = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < lookups && !ids.empty(); ++i)
+        {
+            Employee e;
+            found += store.find(ids[random() % ids.size()], &e);
+        }
+        double idSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        size_t foundNames = 0;
+        started = std::chrono::steady_clock::now();
+        for (const std::string &username : usernames)
+        {
+            Employee e;
+            foundNames += store.findUsername(username, &e);
+        }
+        double nameSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        std::cout << "Employees: " << ids.size() << std::endl
+                  << "Attach: " << attachSeconds * 1e6 << " us" << std::endl
+                  << "Id lookups: " << found << "/" << lookups << ", "
+                  << (lookups ? idSeconds * 1e6 / lookups : 0) << " us each" << std::endl
+                  << "Username lookups: " << foundNames << "/" << usernames.size() << ", "
+                  << (usernames.empty() ? 0 : nameSeconds * 1e6 / usernames.size()) << " us each" << std::endl;
+    }
+    return 0;
+#else
+    std::cout << "Reading shared employees needs POSIX shared memory." << std::endl;
+    return 2;
+#endif
+}
+
+/**
+ * @function runBatchCommand
+ *
+ * @description - Handles the command line queries that print an answer and exit instead of
+ * starting the interactive screens.
+ *  - --count <query> - Number of employees like the query.
+ *  - --exists <query> - Prints yes if any employee is like the query.
+ *  - --exists-username <username> - Prints yes if the username is taken.
+ *  - --count-permission <hr|management|general> - Number of employees with the permission.
+ *  - --payroll <filter|all> - Payroll aggregates for employees matching a range filter.
+ *  - --changes <sequence> - Logged changes after a sequence number, 0 for all of them.
+ *  - --export <watermark> - Records changed and removed since an earlier export, 0 for all.
+ *  - --as-of <id>@<YYYY-MM-DD> - An employee's record and permissions at the end of a day.
+ *  - --audit <filter|all> - Audit records like actor=1,target=3,action=edit,from=2024-01-01,to=2024-12-31.
+ *  - --archived <id|all> - Removed employees still in the archive.
+ *  - --purge-archive <days|default> - Drops archived employees removed longer ago, prints how many.
+ *  - --backup <file> - Writes a compressed backup of every employee.
+ *  - --restore <file> - Makes the employees match a backup, removed ones go to the archive.
+ *  - --fsck <check|repair|quarantine> - Checks every employee file, see Application::checkStore.
+ *  - --pack - Packs the employees into the compressed store, see PackStore.
+ *  - --bench-pack <lookups> - Measures the packed store on the employees, see Application::benchmarkPack.
+ *  - --share - Keeps the employees in shared memory until interrupted, see Application::shareStore.
+ *
+ * @param Application &app - The loaded application.
+ * @param string command - The flag given.
+ * @param string argument - The value given after the flag.
+ *
+ * @return int - Exit code for the process.
+ */
+int runBatchCommand(Application &app, std::string command, std::string argument)
+{
+    if (command == "--count")
+    {
+        std::cout << app.countEmployees(argument) << std::endl;
+    }
+    else if (command == "--exists")
+    {
+        std::cout << (app.anyEmployeeMatches(argument) ? "yes" : "no") << std::endl;
+    }
+    else if (command == "--exists-username")
+    {
+        std::cout << (app.uniqueUsername(argument) ? "no" : "yes") << std::endl;
+    }
+    else if (command == "--count-permission")
+    {
+        short permission = argument == "hr" ? HR_PERMS : argument == "management" ? MANAGEMENT_PERMS
+                                                     : argument == "general"      ? GENERAL_PERMS
+                                                                                  : 0;
+        if (permission == 0)
+        {
+            std::cout << "Unknown permission \"" << argument << "\"." << std::endl;
+            return 1;
+        }
+        std::cout << app.countWithPermission(permission) << std::endl;
+    }
+    else if (command == "--payroll")
+    {
+        return printPayrollSummary(&app, argument) ? 0 : 1;
+    }
+    else if (command == "--purge-archive")
+    {
+        int days = argument == "default" ? ARCHIVE_RETENTION_DAYS : std::atoi(argument.c_str());
+        size_t dropped = 0;
+        if (!app.purgeArchive(days, dropped))
+        {
+            std::cout << "Could not rewrite the archive, nothing was purged." << std::endl;
+            return 1;
+        }
+        std::cout << dropped << std::endl;
+    }
+    else if (command == "--backup")
+    {
+        std::future<bool> backup = app.startBackup(argument);
+        if (!backup.get())
+        {
+            std::cout << "Could not write the backup." << std::endl;
+            return 1;
+        }
+        std::cout << "Backed up " << app.employees.size() << " employees." << std::endl;
+    }
+    else if (command == "--restore")
+    {
+        std::string error;
+        size_t written, removed;
+        if (!app.restoreBackup(argument, error, written, removed))
+        {
+            std::cout << error << std::endl;
+            return 1;
+        }
+        std::cout << "Restored " << written << " employees, removed " << removed << "." << std::endl;
+    }
+    else if (command == "--pack")
+    {
+        std::string error;
+        size_t folded = app.packStore(error);
+        if (!error.empty())
+        {
+            std::cout << error << std::endl;
+            return 1;
+        }
+        std::cout << "Packed " << app.employees.size() << " employees, " << folded << " files folded in." << std::endl;
+    }
+    else if (command == "--share")
+    {
+#if defined SHARED_STORE_POSIX
+        return app.shareStore(std::cout) ? 0 : 1;
+#else
+        std::cout << "Sharing the employees needs POSIX shared memory." << std::endl;
+        return 1;
+#endif
+    }
+    else if (command == "--bench-pack")
+    {
+        if (!app.benchmarkPack(std::strtoul(argument.c_str(), nullptr, 10), std::cout))
+        {
+            std::cout << "Could not write the trial pack." << std::endl;
+            return 1;
+        }
+    }
+    else if (command == "--fsck")
+    {
+        int mode = argument == "check" ? FSCK_CHECK : argument == "repair"   ? FSCK_REPAIR
+                                                  : argument == "quarantine" ? FSCK_QUARANTINE
+                                                                             : -1;
+        if (mode < 0)
+        {
+            std::cout << "Expected check, repair, or quarantine." << std::endl;
+            return 1;
+        }
+
+        FsckReport report = app.checkStore(mode, std::cout);
+        std::cout << "Checked " << report.checked << " files";
+        if (report.packed > 0)
+        {
+            std::cout << " and " << report.packed << " packed employees";
+        }
+        std::cout << ": " << report.problems << " with problems, "
+                  << report.repaired << " repaired, " << report.quarantined << " quarantined";
+        if (report.notices > 0)
+        {
+            std::cout << ", " << report.notices << " with notices";
+        }
+        std::cout << "." << std::endl;
+        return report.problems == report.repaired + report.quarantined ? 0 : 1;
+    }
+    else if (command == "--archived")
+    {
+        for (const ArchivedEmployee &entry : app.archivedEmployees())
+        {
+            if (argument == "all" || std::atoi(argument.c_str()) == entry.employee.id)
+            {
+                std::cout << "Removed: " << formatTime(entry.removedAt) << std::endl
+                          << entry.employee.toString(1) << std::endl;
+            }
+        }
+    }
+    else if (command == "--audit")
+    {
+        return printAuditLog(argument) ? 0 : 1;
+    }
+    else if (command == "--as-of")
+    {
+        // Given as <id>@<YYYY-MM-DD>.
+        size_t at = argument.find('@');
+        int days;
+        if (at == std::string::npos || !parseDate(argument.substr(at + 1), days))
+        {
+            std::cout << "Expected <id>@<YYYY-MM-DD>." << std::endl;
+            return 1;
+        }
+
+        Employee then;
+        int id = std::atoi(argument.c_str());
+        if (!RecordHistory::asOf(id, endOfDay(days), app.lookupEmployee(id), &then))
+        {
+            std::cout << "No record." << std::endl;
+            return 1;
+        }
+        std::cout << then.toString(1) << "Permissions: " << describePermissions(then) << std::endl;
+    }
+    else if (command == "--export")
+    {
+        app.exportSince(std::strtoul(argument.c_str(), nullptr, 10), std::cout);
+    }
+    else if (command == "--changes")
+    {
+        for (const ChangeEvent &event : ChangeFeed::readLog(std::strtoul(argument.c_str(), nullptr, 10)))
+        {
+            std::cout << event.toString(true) << std::endl;
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
 {
+    bool printPoolStats = false;
+    bool replica = false;
+    std::string batchCommand, batchArgument;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--pool-stats")
+        {
+            printPoolStats = true;
+        }
+        else if (arg == "--pack" || arg == "--share")
+        {
+            batchCommand = arg;
+        }
+        else if (arg == "--replica")
+        {
+            replica = true;
+        }
+        else if ((arg == "--count" || arg == "--exists" || arg == "--exists-username" ||
+                  arg == "--count-permission" || arg == "--payroll" || arg == "--changes" ||
+                  arg == "--export" || arg == "--as-of" || arg == "--audit" ||
+                  arg == "--archived" || arg == "--purge-archive" || arg == "--backup" ||
+                  arg == "--restore" || arg == "--fsck" || arg == "--bench-pack" ||
+                  arg == "--shared-get" || arg == "--bench-shared") &&
+                 i + 1 < argc)
+        {
+            batchCommand = arg;
+            batchArgument = argv[++i];
+        }
+    }
+
+    if (batchCommand == "--shared-get" || batchCommand == "--bench-shared")
+    {
+        return runSharedCommand(batchCommand, batchArgument);
+    }
+
     Application app;
+
+    if (!batchCommand.empty())
+    {
+        return runBatchCommand(app, batchCommand, batchArgument);
+    }
+
+    if (replica)
+    {
+        app.startReplica();
+        app.useSharedStore();
+    }
     app.start();
 
+    if (printPoolStats)
+    {
+        PoolStats stats = app.pool.stats();
+        std::cout << "Pool workers: " << stats.workers << std::endl
+                  << "Tasks executed: " << stats.executed << std::endl
+                  << "Tasks stolen: " << stats.steals << std::endl
+                  << "Queue depth (now/max): " << stats.queued << "/" << stats.maxQueued << std::endl;
+    }
+
     return 0;
 }